@@ -18,6 +18,7 @@
 
 
 // Build-in
+#include <cstdint>
 #include <system_error>
 #include <string>
 
@@ -321,6 +322,18 @@ public:
      */
     virtual std::vector<error_info_t> get_errors() = 0;
 
+    /*!
+     * \brief Gets the number of data buffers lost since the block was created,
+     * because the flowgraph did not consume the samples in time.
+     */
+    virtual uint64_t get_lost_buffers_count() = 0;
+
+    /*!
+     * \brief Gets how often the watchdog re-armed the device since the block was
+     * created.
+     */
+    virtual uint64_t get_watchdog_count() = 0;
+
     /*!
      * \brief Returns exception message of exception which occured during start/configure,
      * if any
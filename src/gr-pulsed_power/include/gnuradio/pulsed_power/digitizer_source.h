@@ -23,6 +23,7 @@
 #include <boost/lexical_cast.hpp>
 
 // Build-in
+#include <atomic>
 #include <condition_variable>
 #include <system_error>
 #include <chrono>
@@ -274,6 +275,10 @@ public:
 
     std::vector<error_info_t> get_errors() override;
 
+    uint64_t get_lost_buffers_count() override;
+
+    uint64_t get_watchdog_count() override;
+
     bool start() override;
 
     bool stop() override;
@@ -503,6 +508,10 @@ private:
 
     error_buffer_t d_errors;
 
+    // Counters, read by other threads
+    std::atomic<uint64_t> d_lost_buffers_count;
+    std::atomic<uint64_t> d_watchdog_count;
+
     // Poller
     boost::thread d_poller;
     poller_state_t d_poller_state;
@@ -2,6 +2,7 @@
 #define INCLUDED_PULSED_POWER_OPENCMW_TIME_SINK_H
 
 #include <gnuradio/pulsed_power/api.h>
+#include <gnuradio/pulsed_power/sink_registry.h>
 #include <gnuradio/sync_block.h>
 
 namespace gr {
@@ -11,7 +12,8 @@ namespace pulsed_power {
  * \brief GNU Radio OpenCMW sink for exporting time-domain data into OpenCMW.
  *
  * On each incoming data package a callback is called which allows the host
- * application to copy the data to its internal buffers
+ * application to copy the data to its internal buffers. Every sink is listed in
+ * time_sink_registry() under the qualified names of its signals.
  * \ingroup pulsed_power
  *
  */
@@ -38,8 +40,18 @@ public:
                      float sample_rate);
 
     /*!
-     * \brief Registers a callback which is called whenever a predefined number of samples
-     * is available.
+     * \brief Attaches a callback which is called whenever a predefined number of samples
+     * is available, until the returned subscription is reset or destroyed.
+     *
+     * Callbacks can be attached and detached while the flowgraph runs, work() calls
+     * them without taking a lock.
+     *
+     * \param cb_copy_data callback in which the host application can copy the data
+     */
+    virtual subscription subscribe(cb_copy_data_t cb_copy_data) = 0;
+
+    /*!
+     * \brief Attaches a callback for the lifetime of the sink, see subscribe().
      *
      * \param cb_copy_data callback in which the host application can copy the data
      */
@@ -61,8 +73,10 @@ public:
     virtual std::vector<std::string> get_signal_units() = 0;
 };
 
-extern PULSED_POWER_API std::mutex globalTimeSinksRegistryMutex;
-extern PULSED_POWER_API std::vector<opencmw_time_sink*> globalTimeSinksRegistry;
+/*!
+ * \brief All opencmw_time_sink blocks alive, looked up by qualified signal name.
+ */
+PULSED_POWER_API sink_registry<opencmw_time_sink>& time_sink_registry();
 
 } // namespace pulsed_power
 } // namespace gr
@@ -0,0 +1,258 @@
+#ifndef INCLUDED_PULSED_POWER_SINK_REGISTRY_H
+#define INCLUDED_PULSED_POWER_SINK_REGISTRY_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace gr {
+namespace pulsed_power {
+
+/*!
+ * \brief Name under which a signal is published, e.g. "circuit2/P@100Hz".
+ *
+ * The sample rate is written in the shortest fixed notation that reads back
+ * to the same float, i.e. "100", "0.016666668" or "2000000".
+ */
+inline std::string qualified_signal_name(const std::string& signal_name,
+                                         float sample_rate)
+{
+    std::array<char, 64> rate;
+    const auto result = std::to_chars(
+        rate.data(), rate.data() + rate.size(), sample_rate, std::chars_format::fixed);
+    return signal_name + "@" + std::string(rate.data(), result.ptr) + "Hz";
+}
+
+class subscriber_list_base
+{
+public:
+    virtual ~subscriber_list_base() = default;
+    virtual void remove(uint64_t id) = 0;
+};
+
+/*!
+ * \brief Handle of a callback attached to a sink.
+ *
+ * The callback stays attached until the handle is reset or destroyed. The
+ * handle does not keep the sink alive, resetting it after the sink is gone
+ * does nothing. A callback must not reset its own subscription.
+ */
+class subscription
+{
+private:
+    std::weak_ptr<subscriber_list_base> d_list;
+    uint64_t d_id = 0;
+
+public:
+    subscription() = default;
+    subscription(std::weak_ptr<subscriber_list_base> list, uint64_t id)
+        : d_list(std::move(list)), d_id(id)
+    {
+    }
+    subscription(const subscription&) = delete;
+    subscription& operator=(const subscription&) = delete;
+    subscription(subscription&& other) noexcept
+        : d_list(std::move(other.d_list)), d_id(std::exchange(other.d_id, 0))
+    {
+    }
+    subscription& operator=(subscription&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            d_list = std::move(other.d_list);
+            d_id = std::exchange(other.d_id, 0);
+        }
+        return *this;
+    }
+    ~subscription() { reset(); }
+
+    //! Detaches the callback, returns once the sink no longer calls it.
+    void reset()
+    {
+        if (auto list = d_list.lock(); list && d_id != 0) {
+            list->remove(d_id);
+        }
+        d_list.reset();
+        d_id = 0;
+    }
+
+    //! Leaves the callback attached for the lifetime of the sink.
+    void release()
+    {
+        d_list.reset();
+        d_id = 0;
+    }
+
+    bool active() const { return d_id != 0 && !d_list.expired(); }
+};
+
+/*!
+ * \brief Callbacks of a sink, called from its work() without taking a lock.
+ *
+ * The callbacks are kept in an immutable list. Attaching or detaching copies
+ * the list, swaps the pointer and frees the old list after a grace period in
+ * which every dispatch that could still see it has finished (read-copy-update).
+ * Dispatching only increments and decrements a reader counter, so consumers
+ * attach and detach while the flowgraph runs without stalling the sink.
+ */
+template <typename Callback>
+class subscriber_list : public subscriber_list_base,
+                        public std::enable_shared_from_this<subscriber_list<Callback>>
+{
+private:
+    struct entry {
+        uint64_t id;
+        Callback callback;
+    };
+    using entries_t = std::vector<entry>;
+
+    std::atomic<const entries_t*> d_entries;
+    std::atomic<uint64_t> d_epoch = 0; // parity selects the reader counter
+    std::array<std::atomic<int64_t>, 2> d_readers{};
+    std::mutex d_writer_mutex; // serialises updates, never taken by dispatch
+    uint64_t d_next_id = 1;
+
+    // d_writer_mutex held
+    void replace(const entries_t* entries)
+    {
+        const entries_t* previous = d_entries.exchange(entries);
+        // a reader may have chosen its counter before either flip, wait for both
+        for (int flip = 0; flip < 2; flip++) {
+            const uint64_t epoch = d_epoch.fetch_add(1);
+            while (d_readers[epoch & 1].load() != 0) {
+                std::this_thread::yield();
+            }
+        }
+        delete previous;
+    }
+
+public:
+    subscriber_list() : d_entries(new entries_t()) {}
+    subscriber_list(const subscriber_list&) = delete;
+    subscriber_list& operator=(const subscriber_list&) = delete;
+    ~subscriber_list() override { delete d_entries.load(); }
+
+    subscription add(Callback callback)
+    {
+        std::scoped_lock lock(d_writer_mutex);
+        const uint64_t id = d_next_id++;
+        auto entries = std::make_unique<entries_t>(*d_entries.load());
+        entries->push_back({ id, std::move(callback) });
+        replace(entries.release());
+        return subscription(this->weak_from_this(), id);
+    }
+
+    void remove(uint64_t id) override
+    {
+        std::scoped_lock lock(d_writer_mutex);
+        auto entries = std::make_unique<entries_t>();
+        for (const auto& current : *d_entries.load()) {
+            if (current.id != id) {
+                entries->push_back(current);
+            }
+        }
+        replace(entries.release());
+    }
+
+    //! Calls every attached callback, wait-free apart from the callbacks themselves.
+    template <typename... Args>
+    void dispatch(Args&&... args)
+    {
+        struct reader_guard {
+            std::atomic<int64_t>& readers;
+            explicit reader_guard(std::atomic<int64_t>& counter) : readers(counter)
+            {
+                readers.fetch_add(1);
+            }
+            ~reader_guard() { readers.fetch_sub(1); }
+        } guard(d_readers[d_epoch.load() & 1]);
+
+        for (const auto& current : *d_entries.load()) {
+            current.callback(args...);
+        }
+    }
+
+    size_t size() const { return d_entries.load()->size(); }
+};
+
+/*!
+ * \brief Sinks of one type, looked up by the qualified names of their signals.
+ *
+ * A sink is added by its make() and removed by its destructor. Lookups return
+ * a shared pointer, the handle keeps the sink alive while the caller holds
+ * it. The mutex only guards (de)registration and lookups, the data path of
+ * the sinks never takes it. A name published by two sinks resolves to the
+ * first one.
+ */
+template <typename Sink>
+class sink_registry
+{
+private:
+    struct registered_sink {
+        const Sink* sink;
+        std::weak_ptr<Sink> handle;
+    };
+
+    mutable std::mutex d_mutex;
+    std::vector<registered_sink> d_sinks;             // in order of creation
+    std::map<std::string, registered_sink> d_signals; // qualified signal name -> sink
+
+public:
+    void add(const std::shared_ptr<Sink>& sink)
+    {
+        std::scoped_lock lock(d_mutex);
+        d_sinks.push_back({ sink.get(), sink });
+        for (const auto& name : sink->get_signal_names()) {
+            d_signals.emplace(qualified_signal_name(name, sink->get_sample_rate()),
+                              registered_sink{ sink.get(), sink });
+        }
+    }
+
+    void remove(const Sink* sink)
+    {
+        std::scoped_lock lock(d_mutex);
+        d_sinks.erase(std::remove_if(d_sinks.begin(),
+                                     d_sinks.end(),
+                                     [sink](const auto& entry) { return entry.sink == sink; }),
+                      d_sinks.end());
+        for (auto entry = d_signals.begin(); entry != d_signals.end();) {
+            entry = entry->second.sink == sink ? d_signals.erase(entry) : std::next(entry);
+        }
+    }
+
+    //! The sink publishing the signal, e.g. "P@100Hz", nullptr if there is none.
+    std::shared_ptr<Sink> find(const std::string& qualified_name) const
+    {
+        std::scoped_lock lock(d_mutex);
+        const auto found = d_signals.find(qualified_name);
+        return found == d_signals.end() ? nullptr : found->second.handle.lock();
+    }
+
+    //! All sinks alive, in order of creation.
+    std::vector<std::shared_ptr<Sink>> sinks() const
+    {
+        std::scoped_lock lock(d_mutex);
+        std::vector<std::shared_ptr<Sink>> result;
+        for (const auto& entry : d_sinks) {
+            if (auto sink = entry.handle.lock()) {
+                result.push_back(std::move(sink));
+            }
+        }
+        return result;
+    }
+};
+
+} // namespace pulsed_power
+} // namespace gr
+
+#endif /* INCLUDED_PULSED_POWER_SINK_REGISTRY_H */
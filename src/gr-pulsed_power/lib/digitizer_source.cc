@@ -97,6 +97,8 @@ digitizer_source::digitizer_source(int ai_channels, int di_ports, bool auto_arm)
       d_read_idx(0),
       d_buffer_samples(0),
       d_errors(128),
+      d_lost_buffers_count(0),
+      d_watchdog_count(0),
       d_poller_state(poller_state_t::IDLE)
 {
     d_ai_buffers = std::vector<std::vector<float>>(d_ai_channels);
@@ -615,6 +617,10 @@ void digitizer_source::close()
 
 std::vector<error_info_t> digitizer_source::get_errors() { return d_errors.get(); }
 
+uint64_t digitizer_source::get_lost_buffers_count() { return d_lost_buffers_count; }
+
+uint64_t digitizer_source::get_watchdog_count() { return d_watchdog_count; }
+
 std::string digitizer_source::getConfigureExceptionMessage()
 {
     return d_configure_exception_message;
@@ -1015,6 +1021,7 @@ int digitizer_source::work_stream(int noutput_items, gr_vector_void_star& output
         return -1; // stop
     } else if (ec == digitizer_block_errc::Watchdog) {
         GR_LOG_ERROR(d_logger, "Watchdog triggered, rearming device...");
+        d_watchdog_count++;
         // Rearm device
         disarm();
         arm();
@@ -1063,6 +1070,7 @@ int digitizer_source::work_stream(int noutput_items, gr_vector_void_star& output
     // std::endl;
 
     if (lost_count) {
+        d_lost_buffers_count += static_cast<uint64_t>(lost_count);
         GR_LOG_ERROR(d_logger,
                      std::to_string(lost_count) +
                          " digitizer data buffers lost. Usually the cause of this error "
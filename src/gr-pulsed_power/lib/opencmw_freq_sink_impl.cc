@@ -4,8 +4,11 @@
 namespace gr {
 namespace pulsed_power {
 
-std::mutex globalFrequencySinksRegistryMutex;
-std::vector<opencmw_freq_sink*> globalFrequencySinksRegistry;
+sink_registry<opencmw_freq_sink>& freq_sink_registry()
+{
+    static sink_registry<opencmw_freq_sink> registry;
+    return registry;
+}
 
 using input_type = float;
 opencmw_freq_sink::sptr
@@ -15,8 +18,10 @@ opencmw_freq_sink::make(const std::vector<std::string>& signal_names,
                         float bandwidth,
                         size_t vector_size)
 {
-    return gnuradio::make_block_sptr<opencmw_freq_sink_impl>(
+    auto sink = gnuradio::make_block_sptr<opencmw_freq_sink_impl>(
         signal_names, signal_units, sample_rate, bandwidth, vector_size);
+    freq_sink_registry().add(sink);
+    return sink;
 }
 
 
@@ -39,20 +44,15 @@ opencmw_freq_sink_impl::opencmw_freq_sink_impl(
       _sample_rate(sample_rate),
       _bandwidth(bandwidth),
       _vector_size(vector_size),
-      _timestamp(0)
+      _timestamp(0),
+      _subscribers(std::make_shared<subscriber_list<cb_copy_data_t>>())
 {
-    std::scoped_lock lock(globalFrequencySinksRegistryMutex);
-    register_sink();
 }
 
 /*
  * Our virtual destructor.
  */
-opencmw_freq_sink_impl::~opencmw_freq_sink_impl()
-{
-    std::scoped_lock lock(globalFrequencySinksRegistryMutex);
-    deregister_sink();
-}
+opencmw_freq_sink_impl::~opencmw_freq_sink_impl() { freq_sink_registry().remove(this); }
 
 int opencmw_freq_sink_impl::work(int noutput_items,
                                  gr_vector_const_void_star& input_items,
@@ -68,38 +68,26 @@ int opencmw_freq_sink_impl::work(int noutput_items,
                           // static_cast<int64_t>(1e9 / _sample_rate)?
     }
 
-    for (auto callback : _cb_copy_data) {
-        std::invoke(callback,
-                    input_items,
-                    noutput_items,
-                    _vector_size,
-                    _signal_names,
-                    _sample_rate,
-                    _timestamp);
-    }
+    _subscribers->dispatch(input_items,
+                           noutput_items,
+                           _vector_size,
+                           _signal_names,
+                           _sample_rate,
+                           _timestamp);
 
     _timestamp += noutput_items * _vector_size * static_cast<int64_t>(1e9 / _sample_rate);
 
     return noutput_items;
 }
 
-void opencmw_freq_sink_impl::register_sink()
+subscription opencmw_freq_sink_impl::subscribe(cb_copy_data_t cb_copy_data)
 {
-    globalFrequencySinksRegistry.push_back(this);
-}
-
-void opencmw_freq_sink_impl::deregister_sink()
-{
-    auto result = std::find(
-        globalFrequencySinksRegistry.begin(), globalFrequencySinksRegistry.end(), this);
-    if (result != globalFrequencySinksRegistry.end()) {
-        globalFrequencySinksRegistry.erase(result);
-    }
+    return _subscribers->add(std::move(cb_copy_data));
 }
 
 void opencmw_freq_sink_impl::set_callback(cb_copy_data_t cb_copy_data)
 {
-    _cb_copy_data.push_back(cb_copy_data);
+    subscribe(std::move(cb_copy_data)).release();
 }
 
 float opencmw_freq_sink_impl::get_bandwidth() { return _bandwidth; }
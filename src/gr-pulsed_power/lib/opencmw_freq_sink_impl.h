@@ -15,7 +15,7 @@ private:
     float _bandwidth;
     size_t _vector_size;
     int64_t _timestamp;
-    std::vector<cb_copy_data_t> _cb_copy_data;
+    std::shared_ptr<subscriber_list<cb_copy_data_t>> _subscribers;
 
 public:
     opencmw_freq_sink_impl(const std::vector<std::string>& signal_names,
@@ -29,9 +29,7 @@ public:
              gr_vector_const_void_star& input_items,
              gr_vector_void_star& output_items) override;
 
-    void register_sink();
-
-    void deregister_sink();
+    subscription subscribe(cb_copy_data_t cb_copy_data) override;
 
     void set_callback(cb_copy_data_t cb_copy_data) override;
 
@@ -4,8 +4,11 @@
 namespace gr {
 namespace pulsed_power {
 
-std::mutex globalTimeSinksRegistryMutex;
-std::vector<opencmw_time_sink*> globalTimeSinksRegistry;
+sink_registry<opencmw_time_sink>& time_sink_registry()
+{
+    static sink_registry<opencmw_time_sink> registry;
+    return registry;
+}
 
 using input_type = float;
 opencmw_time_sink::sptr
@@ -13,8 +16,10 @@ opencmw_time_sink::make(const std::vector<std::string>& signal_names,
                         const std::vector<std::string>& signal_units,
                         float sample_rate)
 {
-    return gnuradio::make_block_sptr<opencmw_time_sink_impl>(
+    auto sink = gnuradio::make_block_sptr<opencmw_time_sink_impl>(
         signal_names, signal_units, sample_rate);
+    time_sink_registry().add(sink);
+    return sink;
 }
 
 
@@ -29,17 +34,12 @@ opencmw_time_sink_impl::opencmw_time_sink_impl(
       _signal_names(signal_names),
       _signal_units(signal_units),
       _sample_rate(sample_rate),
+      _subscribers(std::make_shared<subscriber_list<cb_copy_data_t>>()),
       _timestamp(0)
 {
-    std::scoped_lock lock(globalTimeSinksRegistryMutex);
-    register_sink();
 }
 
-opencmw_time_sink_impl::~opencmw_time_sink_impl()
-{
-    std::scoped_lock lock(globalTimeSinksRegistryMutex);
-    deregister_sink();
-}
+opencmw_time_sink_impl::~opencmw_time_sink_impl() { time_sink_registry().remove(this); }
 
 int opencmw_time_sink_impl::work(int noutput_items,
                                  gr_vector_const_void_star& input_items,
@@ -53,33 +53,22 @@ int opencmw_time_sink_impl::work(int noutput_items,
                           // static_cast<int64_t>(1e9 / _sample_rate)?
     }
 
-    for (auto callback : _cb_copy_data) {
-        std::invoke(callback,
-                    input_items,
-                    noutput_items,
-                    _signal_names,
-                    _sample_rate,
-                    _timestamp);
-    }
+    _subscribers->dispatch(
+        input_items, noutput_items, _signal_names, _sample_rate, _timestamp);
 
     _timestamp += noutput_items * static_cast<int64_t>(1e9 / _sample_rate);
 
     return noutput_items;
 }
-void opencmw_time_sink_impl::register_sink() { globalTimeSinksRegistry.push_back(this); }
 
-void opencmw_time_sink_impl::deregister_sink()
+subscription opencmw_time_sink_impl::subscribe(cb_copy_data_t cb_copy_data)
 {
-    auto result =
-        std::find(globalTimeSinksRegistry.begin(), globalTimeSinksRegistry.end(), this);
-    if (result != globalTimeSinksRegistry.end()) {
-        globalTimeSinksRegistry.erase(result);
-    }
+    return _subscribers->add(std::move(cb_copy_data));
 }
 
 void opencmw_time_sink_impl::set_callback(cb_copy_data_t cb_copy_data)
 {
-    _cb_copy_data.push_back(cb_copy_data);
+    subscribe(std::move(cb_copy_data)).release();
 }
 
 float opencmw_time_sink_impl::get_sample_rate() { return _sample_rate; }
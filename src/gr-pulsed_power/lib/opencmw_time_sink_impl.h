@@ -12,7 +12,7 @@ private:
     std::vector<std::string> _signal_names;
     std::vector<std::string> _signal_units;
     float _sample_rate;
-    std::vector<cb_copy_data_t> _cb_copy_data;
+    std::shared_ptr<subscriber_list<cb_copy_data_t>> _subscribers;
     int64_t _timestamp;
 
 public:
@@ -24,9 +24,8 @@ public:
     int work(int noutput_items,
              gr_vector_const_void_star& input_items,
              gr_vector_void_star& output_items) override;
-    void register_sink();
 
-    void deregister_sink();
+    subscription subscribe(cb_copy_data_t cb_copy_data) override;
 
     void set_callback(cb_copy_data_t cb_copy_data) override;
 
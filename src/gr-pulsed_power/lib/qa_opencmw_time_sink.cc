@@ -10,5 +10,42 @@ BOOST_AUTO_TEST_CASE(test_timestamps)
     // Put test here
 }
 
+BOOST_AUTO_TEST_CASE(test_registry_and_subscriptions)
+{
+    auto sink = opencmw_time_sink::make({ "P", "Q" }, { "W", "Var" }, 100.0f);
+    BOOST_REQUIRE(time_sink_registry().find("P@100Hz") == sink);
+    BOOST_CHECK(time_sink_registry().find("Q@100Hz") == sink);
+    BOOST_CHECK(!time_sink_registry().find("P@1Hz"));
+
+    std::vector<float> p(4, 1.0f);
+    std::vector<float> q(4, 2.0f);
+    gr_vector_const_void_star input_items = { p.data(), q.data() };
+    gr_vector_void_star output_items;
+    int items = 0;
+    auto subscription = sink->subscribe([&items](std::vector<const void*>& inputs,
+                                                 int& noutput_items,
+                                                 const std::vector<std::string>& names,
+                                                 float sample_rate,
+                                                 int64_t) {
+        BOOST_CHECK_EQUAL(inputs.size(), names.size());
+        BOOST_CHECK_EQUAL(sample_rate, 100.0f);
+        items += noutput_items;
+    });
+    sink->work(4, input_items, output_items);
+    BOOST_CHECK_EQUAL(items, 4);
+
+    // detached callbacks are no longer called
+    subscription.reset();
+    sink->work(4, input_items, output_items);
+    BOOST_CHECK_EQUAL(items, 4);
+
+    // the registry does not keep sinks alive
+    subscription = sink->subscribe(
+        [](std::vector<const void*>&, int&, const std::vector<std::string>&, float, int64_t) {});
+    sink.reset();
+    BOOST_CHECK(!time_sink_registry().find("P@100Hz"));
+    BOOST_CHECK(!subscription.active());
+}
+
 } /* namespace pulsed_power */
 } /* namespace gr */
@@ -14,7 +14,7 @@
 /* BINDTOOL_GEN_AUTOMATIC(0)                                                       */
 /* BINDTOOL_USE_PYGCCXML(0)                                                        */
 /* BINDTOOL_HEADER_FILE(opencmw_freq_sink.h)                                        */
-/* BINDTOOL_HEADER_FILE_HASH(5183e9cc3a3748f27aded421c8889596)                     */
+/* BINDTOOL_HEADER_FILE_HASH(84a32520ef06b82e95d7b77d8583f95a)                     */
 /***********************************************************************************/
 
 #include <pybind11/complex.h>
@@ -14,7 +14,7 @@
 /* BINDTOOL_GEN_AUTOMATIC(0)                                                       */
 /* BINDTOOL_USE_PYGCCXML(0)                                                        */
 /* BINDTOOL_HEADER_FILE(opencmw_time_sink.h)                                        */
-/* BINDTOOL_HEADER_FILE_HASH(e98882e0c949209824cc1d74305845d0)                     */
+/* BINDTOOL_HEADER_FILE_HASH(fe619f16f35b01e5d6d728bde5049d11)                     */
 /***********************************************************************************/
 
 #include <pybind11/complex.h>
@@ -182,7 +182,27 @@ void Acquisition::addToBuffers(const StrideArray &strideArray, const std::vector
     }
 }
 
+void Acquisition::update(StrideArray &strideArray, std::vector<double> &relativeTimestamps, uint64_t refTrigger_ns, bool convertValuesBool) {
+    this->lastRefTrigger = refTrigger_ns;
+    if (!relativeTimestamps.empty()) {
+        this->lastTimeStamp = this->lastRefTrigger + relativeTimestamps.back() * 1e9;
+        if (convertValuesBool) {
+            ConvertPair ret    = convertValues(strideArray, relativeTimestamps);
+            relativeTimestamps = ret.relativeTimestamps;
+            refTrigger_ns      = ret.referenceTimestamps;
+            strideArray        = ret.strideArray;
+        }
+        addToBuffers(strideArray, relativeTimestamps, refTrigger_ns);
+    } else {
+        this->lastTimeStamp = this->lastRefTrigger;
+    }
+}
+
 void Acquisition::deserialize() {
+    if (this->binary) {
+        deserializeBinary();
+        return;
+    }
     std::vector<double> relativeTimestamps = {};
     uint64_t            refTrigger_ns      = 0;
     StrideArray         strideArray;
@@ -214,19 +234,7 @@ void Acquisition::deserialize() {
             strideArray.values = std::vector<double>(element.value()["values"]);
         }
     }
-    this->lastRefTrigger = refTrigger_ns;
-    if (!relativeTimestamps.empty()) {
-        this->lastTimeStamp = this->lastRefTrigger + relativeTimestamps.back() * 1e9;
-        if (convertValuesBool) {
-            ConvertPair ret    = convertValues(strideArray, relativeTimestamps);
-            relativeTimestamps = ret.relativeTimestamps;
-            refTrigger_ns      = ret.referenceTimestamps;
-            strideArray        = ret.strideArray;
-        }
-        addToBuffers(strideArray, relativeTimestamps, refTrigger_ns);
-    } else {
-        this->lastTimeStamp = this->lastRefTrigger;
-    }
+    update(strideArray, relativeTimestamps, refTrigger_ns, convertValuesBool);
 }
 
 AcquisitionSpectra::AcquisitionSpectra() {}
@@ -242,6 +250,10 @@ void AcquisitionSpectra::addToBuffers(const std::vector<double> &channelFrequenc
 }
 
 void AcquisitionSpectra::deserialize() {
+    if (this->binary) {
+        deserializeBinary();
+        return;
+    }
     std::vector<double> channelMagnitudeValues;
     std::vector<double> channelFrequencyValues;
     uint64_t            refTrigger_ns      = 0;
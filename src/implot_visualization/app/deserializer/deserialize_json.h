@@ -69,6 +69,8 @@ class IAcquisition {
 public:
     std::vector<std::string> signalNames;
     std::string              jsonString    = "";
+    std::string              binaryString  = "";
+    bool                     binary        = false; // payload is YaS encoded (contentType=application/octet-stream)
     uint64_t                 lastTimeStamp = 0.0;
     std::vector<T>           buffers;
     bool                     success = false;
@@ -96,6 +98,8 @@ public:
 private:
     uint64_t lastRefTrigger = 0;
 
+    void     deserializeBinary();
+    void     update(StrideArray &strideArray, std::vector<double> &relativeTimestamps, uint64_t refTrigger_ns, bool convertValuesBool);
     void     addToBuffers(const StrideArray &strideArray, const std::vector<double> &relativeTimestamp, double refTrigger_ns);
     bool     receivedVoltageCurrentData(std::vector<std::string> receivedSignals);
 };
@@ -110,6 +114,7 @@ public:
     void deserialize();
 
 private:
+    void deserializeBinary();
     void addToBuffers(const std::vector<double> &channelMagnitudeValues, const std::vector<double> &channelFrequencyValues);
 };
 
@@ -0,0 +1,66 @@
+#include "deserialize_json.h"
+#include "deserialize_yas.h"
+#include <iostream>
+
+namespace {
+
+StrideArray toStrideArray(const opencmw::MultiArray<float, 2> &multiArray) {
+    StrideArray strideArray;
+    strideArray.dims = { static_cast<int>(multiArray.n(0)), static_cast<int>(multiArray.n(1)) };
+    strideArray.values.assign(multiArray.elements().begin(), multiArray.elements().end());
+    return strideArray;
+}
+
+} // namespace
+
+void Acquisition::deserializeBinary() {
+    wire::Acquisition acq;
+    if (!decodeYaS(this->binaryString, acq)) {
+        std::cout << "Invalid YaS data in Acquisition" << std::endl;
+        return;
+    }
+    // empty response
+    if (acq.refTriggerStamp == 0) {
+        return;
+    }
+    if (!this->receivedRequestedSignals(acq.channelNames)) {
+        std::cout << "Received other signals than requested (Acquisition)" << std::endl;
+        return;
+    }
+    bool                convertValuesBool = receivedVoltageCurrentData(acq.channelNames);
+    std::vector<double> relativeTimestamps(acq.channelTimeSinceRefTrigger.begin(), acq.channelTimeSinceRefTrigger.end());
+    StrideArray         strideArray = toStrideArray(acq.channelValues);
+    update(strideArray, relativeTimestamps, static_cast<uint64_t>(acq.refTriggerStamp), convertValuesBool);
+}
+
+void AcquisitionSpectra::deserializeBinary() {
+    wire::AcquisitionSpectra acq;
+    if (!decodeYaS(this->binaryString, acq)) {
+        std::cout << "Invalid YaS data in AcquisitionSpectra" << std::endl;
+        return;
+    }
+    // empty response
+    if (acq.refTriggerStamp == 0) {
+        return;
+    }
+    if (!this->receivedRequestedSignals({ acq.channelName })) {
+        std::cout << "Received other signals than requested (AcquisitionSpectra)" << std::endl;
+        return;
+    }
+    // only the latest spectrum is displayed
+    std::vector<double> channelMagnitudeValues;
+    const auto          vectorSize = acq.channelMagnitude_values.n(1);
+    const auto          numValues  = acq.channelMagnitude_values.n(0);
+    if (numValues > 0) {
+        const auto &elements = acq.channelMagnitude_values.elements();
+        channelMagnitudeValues.assign(elements.begin() + vectorSize * (numValues - 1), elements.begin() + vectorSize * numValues);
+    }
+    std::vector<double> channelFrequencyValues(acq.channelMagnitude_dim2_discrete_freq_values.begin(), acq.channelMagnitude_dim2_discrete_freq_values.end());
+
+    if (!acq.channelTimeSinceRefTrigger.empty()) {
+        this->lastTimeStamp = acq.refTriggerStamp + acq.channelTimeSinceRefTrigger.back() * 1e9;
+    } else {
+        this->lastTimeStamp = acq.refTriggerStamp;
+    }
+    addToBuffers(channelFrequencyValues, channelMagnitudeValues);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <IoBuffer.hpp>
+#include <IoSerialiserYaS.hpp>
+#include <MultiArray.hpp>
+#include <opencmw.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Mirrors of the structs served by the opencmw workers (src/opencmw_worker/src).
+// Field names have to match the worker side, the YaS deserialiser matches fields by name.
+namespace wire {
+
+struct Acquisition {
+    std::string                   refTriggerName  = { "NO_REF_TRIGGER" };
+    int64_t                       refTriggerStamp = 0;
+    std::vector<float>            channelTimeSinceRefTrigger;
+    float                         channelUserDelay   = 0.0f;
+    float                         channelActualDelay = 0.0f;
+    std::vector<std::string>      channelNames;
+    opencmw::MultiArray<float, 2> channelValues;
+    opencmw::MultiArray<float, 2> channelErrors;
+    std::vector<std::string>      channelUnits;
+    std::vector<int64_t>          status;
+    std::vector<float>            channelRangeMin;
+    std::vector<float>            channelRangeMax;
+    std::vector<float>            temperature;
+};
+
+struct AcquisitionSpectra {
+    std::string                   refTriggerName  = { "NO_REF_TRIGGER" };
+    int64_t                       refTriggerStamp = 0;
+    std::vector<float>            channelTimeSinceRefTrigger;
+    std::string                   channelName;
+    opencmw::MultiArray<float, 2> channelMagnitude_values;
+    std::string                   channelMagnitude_unit;
+    std::vector<long>             channelMagnitude_dim1_discrete_time_values;
+    std::vector<float>            channelMagnitude_dim2_discrete_freq_values;
+    opencmw::MultiArray<float, 2> channelPhase_values;
+    std::string                   channelPhase_unit;
+    std::vector<long>             channelPhase_dim1_discrete_time_values;
+    std::vector<float>            channelPhase_dim2_discrete_freq_values;
+};
+
+} // namespace wire
+
+ENABLE_REFLECTION_FOR(wire::Acquisition, refTriggerName, refTriggerStamp, channelTimeSinceRefTrigger, channelUserDelay, channelActualDelay, channelNames, channelValues, channelErrors, channelUnits, status, channelRangeMin, channelRangeMax, temperature)
+ENABLE_REFLECTION_FOR(wire::AcquisitionSpectra, refTriggerName, refTriggerStamp, channelTimeSinceRefTrigger, channelName, channelMagnitude_values, channelMagnitude_unit, channelMagnitude_dim1_discrete_time_values, channelMagnitude_dim2_discrete_freq_values, channelPhase_values, channelPhase_unit, channelPhase_dim1_discrete_time_values, channelPhase_dim2_discrete_freq_values)
+
+// false for an empty payload or one the lenient deserialiser reported issues for (out may be partially filled then)
+template<typename T>
+bool decodeYaS(const std::string &data, T &out) {
+    if (data.empty()) {
+        return false;
+    }
+    opencmw::IoBuffer buffer;
+    buffer.put<opencmw::IoBuffer::MetaInfo::WITHOUT>(data);
+    const auto result = opencmw::deserialise<opencmw::YaS, opencmw::ProtocolCheck::LENIENT>(buffer, out);
+    if (!result.exceptions.empty()) {
+        std::cout << "YaS deserialisation failed with " << result.exceptions.size() << " issue(s)" << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -9,7 +9,11 @@
 template<typename T>
 void Subscription<T>::downloadSucceeded(emscripten_fetch_t *fetch) {
     // The data is now available at fetch->data[0] through fetch->data[fetch->numBytes-1];
-    this->acquisition.jsonString.assign(fetch->data, fetch->numBytes);
+    if (this->acquisition.binary) {
+        this->acquisition.binaryString.assign(fetch->data, fetch->numBytes);
+    } else {
+        this->acquisition.jsonString.assign(fetch->data, fetch->numBytes);
+    }
 
     emscripten_fetch_close(fetch); // Free data associated with the fetch.
     this->fetchSuccessful     = true;
@@ -45,7 +49,7 @@ std::string Subscription<T>::buildSignalString(const std::string name, const dou
 }
 
 template<typename T>
-Subscription<T>::Subscription(const std::string &_url, const std::vector<std::string> &_requestedSignals, const double _sampRate, const int _bufferSize, const float _updateFrequency)
+Subscription<T>::Subscription(const std::string &_url, const std::vector<std::string> &_requestedSignals, const double _sampRate, const int _bufferSize, const float _updateFrequency, const bool _binary)
     : url(_url), updateFrequency(_updateFrequency) {
     for (std::string signalName : _requestedSignals) {
         if (_sampRate == 0) {
@@ -61,8 +65,14 @@ Subscription<T>::Subscription(const std::string &_url, const std::vector<std::st
         this->url.pop_back();
     }
 
+    // request YaS binary instead of JSON
+    if (_binary) {
+        this->url = this->url + (this->url.find('?') != std::string::npos ? "&" : "?") + "contentType=application/octet-stream";
+    }
+
     T _acquisition(requestedSignals, _bufferSize);
-    this->acquisition = _acquisition;
+    this->acquisition        = _acquisition;
+    this->acquisition.binary = _binary;
 
     if (url.find("channelNameFilter") != std::string::npos) {
         this->extendedUrl = this->url + "&lastRefTrigger=0";
@@ -14,7 +14,7 @@ public:
     bool           fetchFinished   = true;
     bool           fetchSuccessful = false;
 
-    Subscription(const std::string &_url, const std::vector<std::string> &_requestedSignals, const double _sampRate, const int _bufferSize, const float _updateFrequency);
+    Subscription(const std::string &_url, const std::vector<std::string> &_requestedSignals, const double _sampRate, const int _bufferSize, const float _updateFrequency, const bool _binary = false);
 
     void fetch();
     void downloadSucceeded(emscripten_fetch_t *fetch);
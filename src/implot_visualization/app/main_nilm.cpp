@@ -98,7 +98,7 @@ int         main(int argc, char **argv) {
 
     Subscription<PowerUsage>     nilmSubscription("http://localhost:8081/", { "nilm_predict_values" }, 0, 1, updateFreq);
     Subscription<RealPowerUsage> integratedValues("http://localhost:8080/pulsed_power/Acquisition?channelNameFilter=", { "P_Int_" + integrationInterval, "S_Int_" + integrationInterval }, 1, 1, updateFreq);
-    Subscription<Acquisition>    powerSubscription("http://localhost:8080/pulsed_power/Acquisition?channelNameFilter=", { "P", "Q", "S", "phi" }, sampRate, 30'000, updateFreq);
+    Subscription<Acquisition>    powerSubscription("http://localhost:8080/pulsed_power/Acquisition?channelNameFilter=", { "P", "Q", "S", "phi" }, sampRate, 30'000, updateFreq, true);
 
     // Subscription<PowerUsage>     nilmSubscription("http://10.0.0.2:8081/", { "nilm_predict_values" }, 0, 1, updateFreq);
     // Subscription<RealPowerUsage> integratedValues("http://10.0.0.2:8080/pulsed_power/Acquisition?channelNameFilter=", { "P_Int_" + integrationInterval, "S_Int_" + integrationInterval }, 1, 1, updateFreq);
@@ -0,0 +1,361 @@
+#ifndef FLOWGRAPH_CONFIG_H
+#define FLOWGRAPH_CONFIG_H
+
+#include <IoSerialiserJson.hpp>
+
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/*
+ * Parameters of PulsedPowerFlowgraph, read from a JSON file.
+ *
+ * Every field has the default of the former hard-coded flowgraph, so a file
+ * only lists what differs, e.g. { "source": { "type": "simulated" } }.
+ * Decimations are not configured directly but derived from the rates, which
+ * have to divide each other.
+ */
+struct SourceConfig {
+    std::string type              = "picoscope"; // picoscope or simulated
+    std::string serial;                          // picoscope serial number, empty: first device found
+    std::string name;                            // device namespace of the sinks, e.g. circuit2 publishes circuit2/P@100Hz
+    int32_t     phases            = 1;           // 1: U on channel A, I on B; 3: L1 on A/B, L2 on C/D, L3 on E/F
+    float       sampleRate        = 2'000'000.0f;
+    float       voltageRange      = 5.0f;   // V, picoscope voltage channels
+    float       currentRange      = 1.0f;   // V, picoscope current channels
+    float       voltageCorrection = 100.0f; // measuring adapter
+    float       currentCorrection = 2.5f;   // current clamp
+    int32_t     nrBuffers         = 64;
+    int32_t     driverBufferSize  = 102'400;
+    int32_t     bufferSize        = 204'800;
+    double      streamingInterval = 0.0005; // s
+    bool        addNoise          = true;   // simulated source only
+};
+
+ENABLE_REFLECTION_FOR(SourceConfig, type, serial, name, phases, sampleRate, voltageRange, currentRange, voltageCorrection, currentCorrection, nrBuffers, driverBufferSize, bufferSize, streamingInterval, addNoise)
+
+// output rates in Hz
+struct RateConfig {
+    float signals   = 1'000.0f; // U, I and the band pass filtered signals
+    float phaseCalc = 1'000.0f; // phase difference and P, Q, S, phi
+    float shortTerm = 100.0f;
+    float midTerm   = 1.0f;
+    float longTerm  = 1.0f / 60.0f;
+    float integrals = 1.0f; // day, week and month integrals of P and S
+};
+
+ENABLE_REFLECTION_FOR(RateConfig, signals, phaseCalc, shortTerm, midTerm, longTerm, integrals)
+
+struct ProcessingConfig {
+    float       bandPassLow        = 20.0f; // Hz
+    float       bandPassHigh       = 80.0f;
+    float       bandPassTransition = 1'000.0f;
+    std::string bandPassWindow     = "hann";
+    float       lowPassCutoff      = 60.0f; // Hz, after mixing with the phase reference
+    float       lowPassTransition  = 10.0f;
+    std::string lowPassWindow      = "hamming";
+    float       phaseReference     = 55.0f; // Hz
+    double      powerCalcAlpha     = 0.001;
+    float       mainsFrequencyLow  = -100.0f; // thresholds of the zero crossing detection
+    float       mainsFrequencyHigh = 100.0f;
+};
+
+ENABLE_REFLECTION_FOR(ProcessingConfig, bandPassLow, bandPassHigh, bandPassTransition, bandPassWindow, lowPassCutoff, lowPassTransition, lowPassWindow, phaseReference, powerCalcAlpha, mainsFrequencyLow, mainsFrequencyHigh)
+
+struct SpectraConfig {
+    int32_t     nilmFftSize           = 131'072; // U, I and S spectra of the NILM
+    std::string nilmWindow            = "blackmanharris";
+    int32_t     ppemFftSize           = 512; // spectrum of U * I on the PPEM dashboard
+    std::string ppemWindow            = "rectangular";
+    int32_t     ppemPreDecimation     = 4'000; // keep one in n before the low pass
+    float       ppemSampleRate        = 50.0f; // Hz, after the low pass
+    float       ppemLowPassCutoff     = 20.0f;
+    float       ppemLowPassTransition = 100.0f;
+};
+
+ENABLE_REFLECTION_FOR(SpectraConfig, nilmFftSize, nilmWindow, ppemFftSize, ppemWindow, ppemPreDecimation, ppemSampleRate, ppemLowPassCutoff, ppemLowPassTransition)
+
+struct SinkConfig {
+    int32_t maxNoutputItems        = 256; // time sinks
+    int32_t maxNoutputItemsSpectra = 1;   // frequency sinks, one vector per work call
+};
+
+ENABLE_REFLECTION_FOR(SinkConfig, maxNoutputItems, maxNoutputItemsSpectra)
+
+// thread settings of a group of blocks, applied before the flowgraph starts
+struct ThreadConfig {
+    std::vector<int32_t> cores;               // CPU affinity, empty: any core
+    int32_t              priority        = 0; // real-time priority 1..99, 0: default scheduling
+    int32_t              maxNoutputItems = 0; // items per work call, 0: unchanged
+    int32_t              minOutputBuffer = 0; // items, 0: GNU Radio default
+};
+
+ENABLE_REFLECTION_FOR(ThreadConfig, cores, priority, maxNoutputItems, minOutputBuffer)
+
+// every block belongs to one group, e.g. pin the source and power calculation to isolated cores:
+// { "placement": { "source": { "cores": [2], "priority": 90 }, "power": { "cores": [3] } } }
+struct PlacementConfig {
+    ThreadConfig source;     // digitizer or simulated sources
+    ThreadConfig processing; // filters, decimation and phase calculation
+    ThreadConfig power;      // power calculation, statistics and integrals
+    ThreadConfig spectra;    // FFTs
+    ThreadConfig sinks;      // OpenCMW sinks
+};
+
+ENABLE_REFLECTION_FOR(PlacementConfig, source, processing, power, spectra, sinks)
+
+struct PerformanceConfig {
+    float publishRate = 1.0f; // Hz, GNU Radio performance counters on flowgraph/Performance, 0: counters off
+};
+
+ENABLE_REFLECTION_FOR(PerformanceConfig, publishRate)
+
+struct FlowgraphConfig {
+    SourceConfig      source;
+    RateConfig        rates;
+    ProcessingConfig  processing;
+    SpectraConfig     spectra;
+    SinkConfig        sinks;
+    PlacementConfig   placement;
+    PerformanceConfig performance;
+
+    // integer decimation from inRate to outRate, 0 if outRate does not divide inRate
+    static int32_t decimation(double inRate, double outRate) {
+        if (inRate <= 0.0 || outRate <= 0.0 || outRate > inRate) {
+            return 0;
+        }
+        const double ratio   = inRate / outRate;
+        const double rounded = std::round(ratio);
+        return std::abs(ratio - rounded) <= 1e-4 * ratio ? static_cast<int32_t>(rounded) : 0;
+    }
+
+    static bool knownWindow(const std::string &window) {
+        static const std::vector<std::string> windows = { "rectangular", "hann", "hamming", "blackman", "blackmanharris" };
+        return std::find(windows.begin(), windows.end(), window) != windows.end();
+    }
+
+    static void check(std::vector<std::string> &errors, bool ok, std::string message) {
+        if (!ok) {
+            errors.push_back(std::move(message));
+        }
+    }
+
+    static void checkDivides(std::vector<std::string> &errors, const char *from, double inRate, const char *to, double outRate) {
+        check(errors, decimation(inRate, outRate) > 0, fmt::format("{} ({} Hz) is not an integer multiple of {} ({} Hz)", from, inRate, to, outRate));
+    }
+
+    // prefix of every sink name of this device, empty without a device name
+    std::string signalPrefix() const {
+        return source.name.empty() ? "" : source.name + "/";
+    }
+
+    static bool isPowerOfTwo(int32_t n) {
+        return n > 0 && (n & (n - 1)) == 0;
+    }
+
+    static void checkThreads(std::vector<std::string> &errors, const char *group, const ThreadConfig &threads) {
+        const auto processors = static_cast<int32_t>(std::thread::hardware_concurrency());
+        for (const int32_t core : threads.cores) {
+            check(errors, core >= 0 && (processors == 0 || core < processors), fmt::format("placement.{}.cores: core {} does not exist, this host has {} cores", group, core, processors));
+        }
+        check(errors, threads.priority >= 0 && threads.priority <= 99, fmt::format("placement.{}.priority {} is not within 0..99", group, threads.priority));
+        check(errors, threads.maxNoutputItems >= 0 && threads.minOutputBuffer >= 0, fmt::format("placement.{}: item counts must not be negative", group));
+    }
+
+    // all problems of the configuration, empty if the flowgraph can be built
+    std::vector<std::string> validate() const {
+        std::vector<std::string> errors;
+        check(errors, source.type == "picoscope" || source.type == "simulated", fmt::format("source.type '{}' is neither 'picoscope' nor 'simulated'", source.type));
+        check(errors, source.name.find_first_of("/@,") == std::string::npos, fmt::format("source.name '{}' must not contain '/', '@' or ','", source.name));
+        check(errors, source.phases == 1 || source.phases == 3, fmt::format("source.phases {} is neither 1 nor 3", source.phases));
+        check(errors, source.sampleRate > 0.0f, "source.sampleRate has to be positive");
+        if (source.type == "picoscope") {
+            check(errors, source.voltageRange > 0.0f && source.currentRange > 0.0f, "source ranges have to be positive");
+            check(errors, source.nrBuffers > 0 && source.driverBufferSize > 0 && source.bufferSize > 0, "source buffer sizes have to be positive");
+            check(errors, source.streamingInterval > 0.0, "source.streamingInterval has to be positive");
+        }
+
+        for (const float rate : { rates.signals, rates.phaseCalc, rates.shortTerm, rates.midTerm, rates.longTerm, rates.integrals }) {
+            check(errors, rate > 0.0f, fmt::format("rates have to be positive, got {}", rate));
+        }
+        checkDivides(errors, "source.sampleRate", source.sampleRate, "rates.signals", rates.signals);
+        checkDivides(errors, "rates.signals", rates.signals, "rates.phaseCalc", rates.phaseCalc);
+        checkDivides(errors, "rates.phaseCalc", rates.phaseCalc, "rates.shortTerm", rates.shortTerm);
+        checkDivides(errors, "rates.phaseCalc", rates.phaseCalc, "rates.midTerm", rates.midTerm);
+        checkDivides(errors, "rates.phaseCalc", rates.phaseCalc, "rates.longTerm", rates.longTerm);
+        checkDivides(errors, "rates.phaseCalc", rates.phaseCalc, "rates.integrals", rates.integrals);
+
+        check(errors, processing.bandPassLow > 0.0f && processing.bandPassLow < processing.bandPassHigh, "processing.bandPassLow has to be positive and below processing.bandPassHigh");
+        check(errors, processing.bandPassHigh < rates.signals / 2.0f, fmt::format("processing.bandPassHigh ({} Hz) has to be below half of rates.signals", processing.bandPassHigh));
+        check(errors, processing.bandPassTransition > 0.0f && processing.lowPassTransition > 0.0f, "filter transition widths have to be positive");
+        check(errors, processing.lowPassCutoff > 0.0f && processing.lowPassCutoff < rates.phaseCalc / 2.0f, fmt::format("processing.lowPassCutoff ({} Hz) has to be below half of rates.phaseCalc", processing.lowPassCutoff));
+        check(errors, processing.phaseReference > 0.0f && processing.phaseReference < rates.phaseCalc / 2.0f, fmt::format("processing.phaseReference ({} Hz) has to be below half of rates.phaseCalc", processing.phaseReference));
+        check(errors, processing.mainsFrequencyLow < processing.mainsFrequencyHigh, "processing.mainsFrequencyLow has to be below processing.mainsFrequencyHigh");
+
+        check(errors, isPowerOfTwo(spectra.nilmFftSize), fmt::format("spectra.nilmFftSize {} is not a power of two", spectra.nilmFftSize));
+        check(errors, isPowerOfTwo(spectra.ppemFftSize), fmt::format("spectra.ppemFftSize {} is not a power of two", spectra.ppemFftSize));
+        for (const auto &window : { processing.bandPassWindow, processing.lowPassWindow, spectra.nilmWindow, spectra.ppemWindow }) {
+            check(errors, knownWindow(window), fmt::format("unknown window '{}', use rectangular, hann, hamming, blackman or blackmanharris", window));
+        }
+        check(errors, spectra.ppemPreDecimation > 0, "spectra.ppemPreDecimation has to be positive");
+        if (spectra.ppemPreDecimation > 0) {
+            const float preRate = source.sampleRate / static_cast<float>(spectra.ppemPreDecimation);
+            checkDivides(errors, "source.sampleRate / spectra.ppemPreDecimation", preRate, "spectra.ppemSampleRate", spectra.ppemSampleRate);
+            check(errors, spectra.ppemLowPassCutoff > 0.0f && spectra.ppemLowPassCutoff < spectra.ppemSampleRate / 2.0f, "spectra.ppemLowPassCutoff has to be below half of spectra.ppemSampleRate");
+            check(errors, spectra.ppemLowPassTransition > 0.0f, "spectra.ppemLowPassTransition has to be positive");
+        }
+
+        check(errors, sinks.maxNoutputItems > 0 && sinks.maxNoutputItemsSpectra > 0, "sink output item limits have to be positive");
+        checkThreads(errors, "source", placement.source);
+        checkThreads(errors, "processing", placement.processing);
+        checkThreads(errors, "power", placement.power);
+        checkThreads(errors, "spectra", placement.spectra);
+        checkThreads(errors, "sinks", placement.sinks);
+        check(errors, performance.publishRate >= 0.0f && performance.publishRate <= 100.0f, fmt::format("performance.publishRate ({} Hz) is not within 0..100 Hz", performance.publishRate));
+        return errors;
+    }
+};
+
+ENABLE_REFLECTION_FOR(FlowgraphConfig, source, rates, processing, spectra, sinks, placement, performance)
+
+// sample rates along the processing chain, printed by the dry run
+struct BlockRate {
+    std::string block;
+    double      inputRate;
+    double      outputRate; // samples or vectors per second
+    int32_t     decimation;
+};
+
+inline void addBlockRate(std::vector<BlockRate> &rates, std::string block, double inputRate, double outputRate) {
+    rates.push_back({ std::move(block), inputRate, outputRate, FlowgraphConfig::decimation(inputRate, outputRate) });
+}
+
+inline std::vector<BlockRate> flowgraphRates(const FlowgraphConfig &config) {
+    const double           source  = config.source.sampleRate;
+    const auto            &r       = config.rates;
+    const auto            &spectra = config.spectra;
+    std::vector<BlockRate> rates;
+
+    // blocks marked per phase exist once for every phase
+    const std::string perPhase = config.source.phases == 1 ? "" : " per phase";
+    addBlockRate(rates, fmt::format("source ({}, {} phase)", config.source.type, config.source.phases), source, source);
+    addBlockRate(rates, "decimation U, I" + perPhase, source, r.signals);
+    addBlockRate(rates, "band pass filter U, I" + perPhase, source, r.signals);
+    addBlockRate(rates, "decimation phase calculation" + perPhase, r.signals, r.phaseCalc);
+    addBlockRate(rates, "low pass filters phase" + perPhase, r.phaseCalc, r.phaseCalc);
+    addBlockRate(rates, "power calculation P, Q, S, phi" + perPhase, r.phaseCalc, r.phaseCalc);
+    for (const auto &[term, rate] : { std::pair{ "short-term", r.shortTerm }, std::pair{ "mid-term", r.midTerm }, std::pair{ "long-term", r.longTerm } }) {
+        addBlockRate(rates, fmt::format("mains frequency {}", term), source, rate);
+        addBlockRate(rates, fmt::format("decimation power {}{}", term, perPhase), r.phaseCalc, rate);
+        addBlockRate(rates, fmt::format("statistics {}", term), r.phaseCalc, rate);
+    }
+    addBlockRate(rates, "integration day, week, month", r.phaseCalc, r.integrals);
+    addBlockRate(rates, fmt::format("fft NILM U, I, S ({} points)", spectra.nilmFftSize), source, source / static_cast<double>(spectra.nilmFftSize));
+    const double ppemPreRate = spectra.ppemPreDecimation > 0 ? source / static_cast<double>(spectra.ppemPreDecimation) : 0.0;
+    addBlockRate(rates, "decimation PPEM spectrum", source, ppemPreRate);
+    addBlockRate(rates, "low pass filter PPEM spectrum", ppemPreRate, spectra.ppemSampleRate);
+    addBlockRate(rates, fmt::format("fft PPEM spectrum ({} points)", spectra.ppemFftSize), spectra.ppemSampleRate, spectra.ppemSampleRate / static_cast<double>(spectra.ppemFftSize));
+    return rates;
+}
+
+inline void printFlowgraphRates(const FlowgraphConfig &config) {
+    fmt::print("{:<40} {:>14} {:>14} {:>10}\n", "block", "input [Hz]", "output [Hz]", "decimation");
+    for (const auto &rate : flowgraphRates(config)) {
+        fmt::print("{:<40} {:>14.7g} {:>14.7g} {:>10}\n", rate.block, rate.inputRate, rate.outputRate, rate.decimation);
+    }
+}
+
+// reads and validates a configuration, unknown keys and invalid values are reported together
+inline FlowgraphConfig loadFlowgraphConfig(const std::string &path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::invalid_argument(fmt::format("cannot open flowgraph configuration '{}'", path));
+    }
+    std::stringstream content;
+    content << file.rdbuf();
+
+    FlowgraphConfig   config;
+    opencmw::IoBuffer buffer;
+    buffer.put<opencmw::IoBuffer::MetaInfo::WITHOUT>(content.str());
+    const auto info   = opencmw::deserialise<opencmw::Json, opencmw::ProtocolCheck::LENIENT>(buffer, config);
+
+    auto       errors = config.validate();
+    for (const auto &field : info.additionalFields) {
+        errors.push_back(fmt::format("unknown key '{}'", std::get<0>(field)));
+    }
+    if (!info.exceptions.empty()) {
+        errors.push_back(fmt::format("cannot parse: {}", info));
+    }
+    if (!errors.empty()) {
+        throw std::invalid_argument(fmt::format("invalid flowgraph configuration '{}':\n  {}", path, fmt::join(errors, "\n  ")));
+    }
+    return config;
+}
+
+inline std::set<int32_t> placementCores(const PlacementConfig &placement) {
+    std::set<int32_t> cores;
+    for (const auto *threads : { &placement.source, &placement.processing, &placement.power, &placement.spectra, &placement.sinks }) {
+        cores.insert(threads->cores.begin(), threads->cores.end());
+    }
+    return cores;
+}
+
+// problems of running several devices, one flowgraph each, in one service: every device needs a distinct
+// name and serial, and the devices must not share cores so that each added device brings its own cores
+inline std::vector<std::string> validateDevices(const std::vector<FlowgraphConfig> &configs) {
+    std::vector<std::string> errors;
+    if (configs.size() < 2) {
+        return errors;
+    }
+    std::set<std::string> names;
+    std::set<std::string> serials;
+    for (size_t i = 0; i < configs.size(); i++) {
+        const auto &source = configs[i].source;
+        FlowgraphConfig::check(errors, !source.name.empty(), fmt::format("device {}: source.name is required with several devices", i + 1));
+        FlowgraphConfig::check(errors, source.name.empty() || names.insert(source.name).second, fmt::format("device {}: source.name '{}' is used twice", i + 1, source.name));
+        if (source.type == "picoscope") {
+            FlowgraphConfig::check(errors, !source.serial.empty(), fmt::format("device '{}': source.serial is required with several devices", source.name));
+            FlowgraphConfig::check(errors, source.serial.empty() || serials.insert(source.serial).second, fmt::format("device '{}': source.serial '{}' is used twice", source.name, source.serial));
+        }
+        FlowgraphConfig::check(errors, configs[i].performance.publishRate == configs[0].performance.publishRate, fmt::format("device '{}': performance.publishRate differs from the first device", source.name));
+        const auto cores = placementCores(configs[i].placement);
+        for (size_t j = 0; j < i; j++) {
+            std::vector<int32_t> shared;
+            const auto           other = placementCores(configs[j].placement);
+            std::set_intersection(cores.begin(), cores.end(), other.begin(), other.end(), std::back_inserter(shared));
+            FlowgraphConfig::check(errors, shared.empty(), fmt::format("devices '{}' and '{}' share the cores {}", configs[j].source.name, source.name, fmt::join(shared, ",")));
+        }
+    }
+    return errors;
+}
+
+// one configuration per device, the built-in defaults without any file
+inline std::vector<FlowgraphConfig> loadFlowgraphConfigs(const std::vector<std::string> &paths) {
+    std::vector<FlowgraphConfig> configs;
+    for (const auto &path : paths) {
+        configs.push_back(loadFlowgraphConfig(path));
+    }
+    if (configs.empty()) {
+        configs.emplace_back();
+    }
+    const auto errors = validateDevices(configs);
+    if (!errors.empty()) {
+        throw std::invalid_argument(fmt::format("invalid device configuration:\n  {}", fmt::join(errors, "\n  ")));
+    }
+    return configs;
+}
+
+#endif /* FLOWGRAPH_CONFIG_H */
@@ -0,0 +1,162 @@
+#ifndef FLOWGRAPH_PERFORMANCE_WORKER_H
+#define FLOWGRAPH_PERFORMANCE_WORKER_H
+
+#include <majordomo/Worker.hpp>
+
+#include <gnuradio/block.h>
+#include <gnuradio/block_detail.h>
+#include <gnuradio/high_res_timer.h>
+#include <gnuradio/pulsed_power/digitizer_base.h>
+
+#include "Snapshot.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <utility>
+
+using opencmw::Annotated;
+using opencmw::NoUnit;
+
+struct FlowgraphPerformanceContext {
+    opencmw::MIME::MimeType contentType = opencmw::MIME::JSON;
+};
+
+ENABLE_REFLECTION_FOR(FlowgraphPerformanceContext, contentType)
+
+// GNU Radio performance counters of every block, one entry per block in each vector
+struct FlowgraphPerformance {
+    int64_t                  timestamp = 0;        // ns since the epoch
+    float                    interval  = 0.0f;     // s since the previous sample
+    std::vector<std::string> blocks;               // unique block names, e.g. fft_filter_fff12
+    std::vector<double>      workTime;             // s spent in work() since the start
+    std::vector<float>       load;                 // share of the interval spent in work(), near 1: the block is the bottleneck
+    std::vector<int64_t>     itemsProduced;        // items of the first output since the start, consumed items for sinks
+    std::vector<float>       inputBuffersFull;     // 0..1, average fill of the fullest input buffer
+    std::vector<float>       outputBuffersFull;    // 0..1, average fill of the fullest output buffer
+    int64_t                  lostBuffers      = 0; // digitizer buffers lost since the start
+    int64_t                  watchdogTriggers = 0; // digitizer re-arms since the start
+    int64_t                  replyCacheHits   = 0; // data worker GETs answered from an already encoded reply since the start
+    int64_t                  replyCacheMisses = 0; // data worker GETs that had to encode their reply since the start
+};
+
+ENABLE_REFLECTION_FOR(FlowgraphPerformance, timestamp, interval, blocks, workTime, load, itemsProduced, inputBuffersFull, outputBuffersFull, lostBuffers, watchdogTriggers, replyCacheHits, replyCacheMisses)
+
+// summed ReplyCache hits and misses of the data workers
+using ReplyCacheCounters = std::function<std::pair<uint64_t, uint64_t>()>;
+
+using namespace opencmw::majordomo;
+template<units::basic_fixed_string serviceName, typename... Meta>
+class FlowgraphPerformanceWorker : public Worker<serviceName, FlowgraphPerformanceContext, Empty, FlowgraphPerformance, Meta...> {
+    std::vector<gr::block_sptr>                                    _blocks;
+    std::vector<std::shared_ptr<gr::pulsed_power::digitizer_base>> _digitizers;
+    ReplyCacheCounters                                             _replyCacheCounters;
+    std::vector<double>                                            _lastWorkTime;
+    std::chrono::steady_clock::time_point                          _lastSample = std::chrono::steady_clock::now();
+    FlowgraphPerformance                                           _performance; // built by the publish thread only
+    Snapshot<FlowgraphPerformance>                                 _published;
+    std::mutex                                                     _sleepMutex;
+    std::condition_variable_any                                    _sleep; // never notified, interrupted by request_stop()
+    std::jthread                                                   _publishThread;
+
+public:
+    using super_t = Worker<serviceName, FlowgraphPerformanceContext, Empty, FlowgraphPerformance, Meta...>;
+
+    // the counters are only updated if the flowgraph was started with GNU Radio's PerfCounters on
+    template<typename BrokerType>
+    explicit FlowgraphPerformanceWorker(const BrokerType &broker, const std::vector<gr::basic_block_sptr> &blocks, std::vector<std::shared_ptr<gr::pulsed_power::digitizer_base>> digitizers, std::chrono::milliseconds interval, ReplyCacheCounters replyCacheCounters = {})
+        : super_t(broker, {}), _digitizers(std::move(digitizers)), _replyCacheCounters(std::move(replyCacheCounters)) {
+        for (const auto &basic_block : blocks) {
+            if (auto block = std::dynamic_pointer_cast<gr::block>(basic_block)) {
+                _blocks.push_back(block);
+                _performance.blocks.push_back(block->alias());
+            }
+        }
+        _lastWorkTime.assign(_blocks.size(), 0.0);
+        _published.publish(_performance);
+
+        _publishThread = std::jthread([this, interval](std::stop_token stopToken) {
+            while (!stopToken.stop_requested()) {
+                {
+                    std::unique_lock lock(_sleepMutex);
+                    _sleep.wait_for(lock, stopToken, interval, [] { return false; });
+                }
+                if (stopToken.stop_requested()) {
+                    break;
+                }
+                sample();
+                _published.publish(_performance);
+                FlowgraphPerformanceContext context;
+                super_t::notify("/Performance", context, _performance);
+            }
+        });
+
+        super_t::setCallback([this](RequestContext &rawCtx, const FlowgraphPerformanceContext &requestContext, const Empty &, FlowgraphPerformanceContext &replyContext, FlowgraphPerformance &out) {
+            replyContext.contentType = requestContext.contentType;
+            if (rawCtx.request.command() == Command::Get) {
+                out = *_published.load();
+            }
+        });
+    }
+
+    // returns at once, also with long publish intervals
+    ~FlowgraphPerformanceWorker() {
+        _publishThread.request_stop();
+        _publishThread.join();
+    }
+
+private:
+    static float fullest(const std::vector<float> &buffers) {
+        return buffers.empty() ? 0.0f : *std::max_element(buffers.begin(), buffers.end());
+    }
+
+    void sample() {
+        const auto   now            = std::chrono::steady_clock::now();
+        const double elapsed        = std::chrono::duration<double>(now - _lastSample).count();
+        const double ticksPerSecond = static_cast<double>(gr::high_res_timer_tps());
+        const size_t count          = _blocks.size();
+        _lastSample                 = now;
+
+        _performance.timestamp      = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        _performance.interval       = static_cast<float>(elapsed);
+        _performance.workTime.resize(count, 0.0);
+        _performance.load.resize(count, 0.0f);
+        _performance.itemsProduced.resize(count, 0);
+        _performance.inputBuffersFull.resize(count, 0.0f);
+        _performance.outputBuffersFull.resize(count, 0.0f);
+        for (size_t i = 0; i < count; i++) {
+            const auto &block  = _blocks[i];
+            const auto  detail = block->detail();
+            if (!detail) {
+                continue; // the flowgraph is not running
+            }
+            const double workTime             = static_cast<double>(block->pc_work_time_total()) / ticksPerSecond;
+            _performance.load[i]              = elapsed > 0.0 ? static_cast<float>((workTime - _lastWorkTime[i]) / elapsed) : 0.0f;
+            _performance.workTime[i]          = workTime;
+            _lastWorkTime[i]                  = workTime;
+            _performance.itemsProduced[i]     = static_cast<int64_t>(detail->noutputs() > 0 ? block->nitems_written(0) : block->nitems_read(0));
+            _performance.inputBuffersFull[i]  = fullest(block->pc_input_buffers_full());
+            _performance.outputBuffersFull[i] = fullest(block->pc_output_buffers_full());
+        }
+
+        _performance.lostBuffers      = 0;
+        _performance.watchdogTriggers = 0;
+        for (const auto &digitizer : _digitizers) {
+            _performance.lostBuffers      += static_cast<int64_t>(digitizer->get_lost_buffers_count());
+            _performance.watchdogTriggers += static_cast<int64_t>(digitizer->get_watchdog_count());
+        }
+
+        if (_replyCacheCounters) {
+            const auto [hits, misses]     = _replyCacheCounters();
+            _performance.replyCacheHits   = static_cast<int64_t>(hits);
+            _performance.replyCacheMisses = static_cast<int64_t>(misses);
+        }
+    }
+};
+
+#endif /* FLOWGRAPH_PERFORMANCE_WORKER_H */
@@ -3,7 +3,8 @@
 
 #define BOOST_BIND_NO_PLACEHOLDERS
 
-#include "Ringbuffer.hpp"
+#include "ReplyCache.hpp"
+#include "SpectrumArena.hpp"
 #include <majordomo/Worker.hpp>
 
 #include <gnuradio/pulsed_power/opencmw_freq_sink.h>
@@ -54,17 +55,17 @@ private:
     // std::atomic<bool>  _shutdownRequested;
     // std::jthread       _pollingThread;
     AcquisitionSpectra _reply;
-    struct RingBufferData {
-        std::vector<float> chunk;
-        int64_t            timestamp = 0;
-    };
-    using ringbuffer_t = std::shared_ptr<Ringbuffer<RingBufferData>>;
+    using arena_t      = std::shared_ptr<SpectrumArena>;
+    using replycache_t = std::shared_ptr<ReplyCache>;
     struct SignalData {
         gr::pulsed_power::opencmw_freq_sink *sink = nullptr;
-        ringbuffer_t                         ringBuffer;
+        arena_t                              arena;
+        replycache_t                         replyCache;
+        std::vector<float>                   frequencyValues; // precomputed frequency axis
     };
 
-    std::unordered_map<std::string, SignalData> _signalsMap; // <completeSignalName, signalData>
+    std::unordered_map<std::string, SignalData> _signalsMap;    // <completeSignalName, signalData>
+    std::vector<gr::pulsed_power::subscription> _subscriptions; // the sinks stop calling into this worker when it is destroyed
 
 public:
     using super_t = Worker<ServiceName, FreqDomainContext, Empty, AcquisitionSpectra, Meta...>;
@@ -104,28 +105,30 @@ public:
                 std::this_thread::sleep_for(willSleepFor);
             }
         });*/
-        // map signal names and ringbuffers, register callback
-        std::scoped_lock lock(gr::pulsed_power::globalFrequencySinksRegistryMutex);
-        fmt::print("GR: number of frequency-domain sinks found: {}\n", gr::pulsed_power::globalFrequencySinksRegistry.size());
-        for (gr::pulsed_power::opencmw_freq_sink *sink : gr::pulsed_power::globalFrequencySinksRegistry) {
+        // map signal names and ringbuffers, subscribe to the sinks
+        const auto freqSinks = gr::pulsed_power::freq_sink_registry().sinks();
+        fmt::print("GR: number of frequency-domain sinks found: {}\n", freqSinks.size());
+        for (const auto &sink : freqSinks) {
             const auto signalNames = sink->get_signal_names();
             const auto sampleRate  = sink->get_sample_rate();
 
-            // init RingBuffer and name for siganl (only one signal possible per freq_sink)
-            auto       ringbuffer         = std::make_shared<Ringbuffer<RingBufferData>>(RING_BUFFER_SIZE);
-            const auto completeSignalName = fmt::format("{}@{}Hz", signalNames[0], sampleRate);
-            _signalsMap.insert({ completeSignalName, SignalData(sink, ringbuffer) });
+            // init spectrum arena and name for signal (only one signal possible per freq_sink), only the upper half of each vector is stored
+            const size_t bins               = sink->get_vector_size() / 2;
+            auto         arena              = std::make_shared<SpectrumArena>(RING_BUFFER_SIZE, bins);
+            const auto   completeSignalName = gr::pulsed_power::qualified_signal_name(signalNames[0], sampleRate);
+            auto         replyCache         = std::make_shared<ReplyCache>();
+            _signalsMap.insert({ completeSignalName, SignalData(sink.get(), arena, replyCache, frequencyAxis(bins, sampleRate)) });
             fmt::print("GR: OpenCMW Frequency Sink '{}' added\n", completeSignalName);
 
-            // register callback
-            sink->set_callback(std::bind(&FrequencyDomainWorker::callbackCopySinkData, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4, std::placeholders::_5, std::placeholders::_6));
+            // callback bound to the pre-resolved arena of this sink
+            _subscriptions.push_back(sink->subscribe([arena](std::vector<const void *> &input_items, int &nitems, size_t vector_size, const std::vector<std::string> &, float sample_rate, int64_t timestamp) {
+                callbackCopySinkData(*arena, input_items, nitems, vector_size, sample_rate, timestamp);
+            }));
         }
 
-        super_t::setCallback([this](RequestContext &rawCtx, const FreqDomainContext            &requestContext, const Empty &,
-                                     FreqDomainContext /* &replyContext */, AcquisitionSpectra &out) {
-            if (rawCtx.request.command() == Command::Get) {
-                handleGetRequest(requestContext, out);
-            }
+        // reply in the requested wire format (JSON, YaS binary or CmwLight), encoded once per arena range
+        super_t::setHandler([this](RequestContext &rawCtx) {
+            replyEncoded<FreqDomainContext, AcquisitionSpectra>(rawCtx, [this](const FreqDomainContext &requestContext) { return handleGetRequest(requestContext); });
         });
     }
 
@@ -134,77 +137,92 @@ public:
         _pollingThread.join();
     } */
 
-    void callbackCopySinkData(std::vector<const void *> &input_items, int &nitems, size_t vector_size, const std::vector<std::string> &signal_name, float sample_rate, int64_t timestamp) {
-        const float *in                 = static_cast<const float *>(input_items[0]);
-        const auto   completeSignalName = fmt::format("{}@{}Hz", signal_name[0], sample_rate);
-        if (_signalsMap.contains(completeSignalName)) {
-            const SignalData &signalData = _signalsMap.at(completeSignalName);
-
-            for (int i = 0; i < nitems; i++) {
-                // publish data
-                RingBufferData bufferData;
-                bufferData.timestamp = timestamp + (static_cast<int64_t>((static_cast<float>(i) * 1e9f) / sample_rate));
-                size_t offset        = static_cast<size_t>(i) * vector_size;
-                bufferData.chunk.assign(in + offset + (vector_size / 2), in + offset + vector_size);
-                signalData.ringBuffer->push(bufferData);
-            }
+    uint64_t replyCacheHits() const {
+        uint64_t hits = 0;
+        for (const auto &[name, signalData] : _signalsMap) {
+            hits += signalData.replyCache->hits();
+        }
+        return hits;
+    }
+
+    uint64_t replyCacheMisses() const {
+        uint64_t misses = 0;
+        for (const auto &[name, signalData] : _signalsMap) {
+            misses += signalData.replyCache->misses();
+        }
+        return misses;
+    }
+
+    static void callbackCopySinkData(SpectrumArena &arena, std::vector<const void *> &input_items, int &nitems, size_t vector_size, float sample_rate, int64_t timestamp) {
+        const float *in = static_cast<const float *>(input_items[0]);
+        for (int i = 0; i < nitems; i++) {
+            // publish data
+            const int64_t frameTimestamp = timestamp + (static_cast<int64_t>((static_cast<float>(i) * 1e9f) / sample_rate));
+            const size_t  offset         = static_cast<size_t>(i) * vector_size;
+            arena.push(in + offset + vector_size - arena.bins(), frameTimestamp);
         }
     }
 
 private:
-    bool handleGetRequest(const FreqDomainContext &requestContext, AcquisitionSpectra &out) {
+    ReplyCache::payload_t handleGetRequest(const FreqDomainContext &requestContext) {
         std::string requestedSignal = requestContext.channelNameFilter;
         if (!_signalsMap.contains(requestedSignal)) {
-            return false;
+            return std::make_shared<const std::string>(encodeReply(requestContext.contentType, AcquisitionSpectra()));
         }
 
-        bool result = pollSignal(requestedSignal, requestContext.lastRefTrigger, out);
-        return result;
+        return pollSignal(requestedSignal, requestContext.lastRefTrigger, requestContext.contentType);
     }
 
-    bool pollSignal(const std::string &requestedSignal, int64_t lastRefTrigger, AcquisitionSpectra &out) {
-        auto signalData     = _signalsMap.at(requestedSignal);
+    ReplyCache::payload_t pollSignal(const std::string &requestedSignal, int64_t lastRefTrigger, const opencmw::MIME::MimeType &contentType) {
+        const SignalData &signalData = _signalsMap.at(requestedSignal);
 
+        const auto [firstSequence, endSequence] = signalData.arena->sequence_range_since(lastRefTrigger);
+        if (endSequence == 0) {
+            return std::make_shared<const std::string>(encodeReply(contentType, AcquisitionSpectra()));
+        }
+        // clients polling with a similar lastRefTrigger resolve to the same sequence range and share one encoded reply
+        const ReplyCache::Key key{ requestedSignal, firstSequence, endSequence, std::string(contentType.typeName()) };
+        return signalData.replyCache->getOrEncode(key, [&, firstSequence = firstSequence, endSequence = endSequence] {
+            AcquisitionSpectra out;
+            assemble(requestedSignal, signalData, firstSequence, endSequence, out);
+            return encodeReply(contentType, out);
+        });
+    }
+
+    static void assemble(const std::string &requestedSignal, const SignalData &signalData, int64_t firstSequence, int64_t endSequence, AcquisitionSpectra &out) {
         out.refTriggerStamp = 0;
         out.channelName     = requestedSignal;
+        out.channelMagnitude_dim1_discrete_time_values.clear();
+        out.channelTimeSinceRefTrigger.clear();
 
-        std::vector<RingBufferData> currentValues;
-        signalData.ringBuffer->get_all(currentValues);
-        size_t             chunkSize = 0;
-        int                numData   = 0;
+        const size_t       bins = signalData.arena->bins();
         std::vector<float> stridedValues;
-        if (!currentValues.empty()) {
-            out.channelMagnitude_values.clear(); // TODO is clear working?
-            out.channelMagnitude_dim1_discrete_time_values.clear();
-            out.channelTimeSinceRefTrigger.clear();
-            int64_t firstTimestamp = 0;
-            for (RingBufferData bufferData : currentValues) {
-                if (bufferData.timestamp > lastRefTrigger) {
-                    if (firstTimestamp == 0) {
-                        firstTimestamp      = bufferData.timestamp;
-                        out.refTriggerStamp = bufferData.timestamp;
-                    }
-                    chunkSize = bufferData.chunk.size();
-                    stridedValues.insert(stridedValues.end(), bufferData.chunk.begin(), bufferData.chunk.end());
-                    out.channelMagnitude_dim1_discrete_time_values.push_back(bufferData.timestamp);
-                    out.channelTimeSinceRefTrigger.push_back(static_cast<float>(bufferData.timestamp - firstTimestamp) / 1e9f);
-                    numData++;
-                }
+        stridedValues.reserve(static_cast<size_t>(endSequence - firstSequence) * bins);
+        uint32_t numData        = 0;
+        int64_t  firstTimestamp = 0;
+        signalData.arena->visit(firstSequence, endSequence, [&](std::span<const float> spectrum, int64_t timestamp) {
+            if (numData == 0) {
+                firstTimestamp      = timestamp;
+                out.refTriggerStamp = timestamp;
             }
-            out.channelMagnitude_values = opencmw::MultiArray<float, 2>(std::move(stridedValues), { static_cast<uint32_t>(numData), static_cast<uint32_t>(chunkSize) });
-            //  generate frequency values
-            const int   vectorSize = static_cast<int>(chunkSize);
-            const float sampleRate = signalData.sink->get_sample_rate();
-            out.channelMagnitude_dim2_discrete_freq_values.clear();
-            out.channelMagnitude_dim2_discrete_freq_values.reserve(chunkSize);
-            const float freqStartValue = 0;
-            const float freqStepValue  = 0.5f * sampleRate / static_cast<float>(vectorSize);
-            for (int i = 0; i < vectorSize; i++) {
-                out.channelMagnitude_dim2_discrete_freq_values.push_back(freqStartValue + static_cast<float>(i) * freqStepValue);
-            }
-            return true;
+            stridedValues.insert(stridedValues.end(), spectrum.begin(), spectrum.end());
+            out.channelMagnitude_dim1_discrete_time_values.push_back(timestamp);
+            out.channelTimeSinceRefTrigger.push_back(static_cast<float>(timestamp - firstTimestamp) / 1e9f);
+            numData++;
+        });
+        out.channelMagnitude_values                    = opencmw::MultiArray<float, 2>(std::move(stridedValues), { numData, static_cast<uint32_t>(bins) });
+        out.channelMagnitude_dim2_discrete_freq_values = signalData.frequencyValues;
+    }
+
+    static std::vector<float> frequencyAxis(size_t bins, float sampleRate) {
+        std::vector<float> frequencyValues;
+        frequencyValues.reserve(bins);
+        const float freqStartValue = 0;
+        const float freqStepValue  = 0.5f * sampleRate / static_cast<float>(bins);
+        for (size_t i = 0; i < bins; i++) {
+            frequencyValues.push_back(freqStartValue + static_cast<float>(i) * freqStepValue);
         }
-        return false;
+        return frequencyValues;
     }
 };
 
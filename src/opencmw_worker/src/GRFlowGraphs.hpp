@@ -3,6 +3,7 @@
 
 #include <gnuradio/analog/noise_source.h>
 #include <gnuradio/analog/sig_source.h>
+#include <gnuradio/block.h>
 #include <gnuradio/blocks/add_blk.h>
 #include <gnuradio/blocks/complex_to_mag.h>
 #include <gnuradio/blocks/complex_to_mag_squared.h>
@@ -22,6 +23,7 @@
 #include <gnuradio/fft/window.h>
 #include <gnuradio/filter/fft_filter_fff.h>
 #include <gnuradio/filter/firdes.h>
+#include <gnuradio/prefs.h>
 #include <gnuradio/top_block.h>
 
 #include <gnuradio/pulsed_power/integration.h>
@@ -33,8 +35,26 @@
 #include <gnuradio/pulsed_power/power_calc_mul_ph_ff.h>
 #include <gnuradio/pulsed_power/statistics.h>
 
+#include "FlowgraphConfig.hpp"
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
 const float PI = 3.141592653589793238463f;
 
+// window names of FlowgraphConfig
+inline gr::fft::window::win_type windowType(const std::string &name) {
+    if (name == "rectangular") return gr::fft::window::win_type::WIN_RECTANGULAR;
+    if (name == "hann") return gr::fft::window::win_type::WIN_HANN;
+    if (name == "hamming") return gr::fft::window::win_type::WIN_HAMMING;
+    if (name == "blackman") return gr::fft::window::win_type::WIN_BLACKMAN;
+    return gr::fft::window::win_type::WIN_BLACKMAN_hARRIS;
+}
+
 class GRFlowGraph {
 private:
     gr::top_block_sptr top;
@@ -120,28 +140,480 @@ public:
 
 class PulsedPowerFlowgraph {
 private:
-    gr::top_block_sptr top;
+    gr::top_block_sptr                                          top;
+    std::vector<gr::basic_block_sptr>                           blocks; // every connected block, in order of connection
+    std::vector<gr::pulsed_power::picoscope_4000a_source::sptr> digitizers;
+    std::string                                                 device_name;   // source.name, empty with a single device
+    std::string                                                 signal_prefix; // device namespace of the sinks, see FlowgraphConfig::signalPrefix()
+
+    // placement group of a block by its GNU Radio name, see PlacementConfig
+    static std::string placement_group(const std::string &block_name) {
+        static const std::map<std::string, std::string> groups = {
+            { "picoscope_4000a_source", "source" },
+            { "sig_source", "source" },
+            { "noise_source", "source" },
+            { "throttle", "source" },
+            { "power_calc", "power" },
+            { "statistics", "power" },
+            { "integration", "power" },
+            { "stream_to_vector", "spectra" },
+            { "fft_v_fftw", "spectra" },
+            { "complex_to_mag", "spectra" },
+            { "complex_to_mag_squared", "spectra" },
+            { "opencmw_time_sink", "sinks" },
+            { "opencmw_freq_sink", "sinks" },
+            { "null_sink", "sinks" },
+        };
+        const auto group = groups.find(block_name);
+        return group == groups.end() ? "processing" : group->second;
+    }
+
+    static std::vector<std::pair<std::string, const ThreadConfig *>> placement_groups(const PlacementConfig &placement) {
+        return { { "source", &placement.source }, { "processing", &placement.processing }, { "power", &placement.power }, { "spectra", &placement.spectra }, { "sinks", &placement.sinks } };
+    }
+
+    // connects two blocks and remembers them for the thread placement
+    void connect(const gr::basic_block_sptr &src, int src_port, const gr::basic_block_sptr &dst, int dst_port) {
+        for (const auto &block : { src, dst }) {
+            if (std::find(blocks.begin(), blocks.end(), block) == blocks.end()) {
+                blocks.push_back(block);
+            }
+        }
+        top->hier_block2::connect(src, src_port, dst, dst_port);
+    }
+
+    // the scheduler applies affinity and priority when it starts the thread of a block
+    void apply_placement(const PlacementConfig &placement) {
+        for (const auto &[group, threads] : placement_groups(placement)) {
+            for (const auto &basic_block : blocks) {
+                auto block = std::dynamic_pointer_cast<gr::block>(basic_block);
+                if (!block || placement_group(block->name()) != group) {
+                    continue;
+                }
+                if (!threads->cores.empty()) {
+                    block->set_processor_affinity(std::vector<int>(threads->cores.begin(), threads->cores.end()));
+                }
+                if (threads->priority > 0) {
+                    block->set_thread_priority(threads->priority);
+                }
+                if (threads->maxNoutputItems > 0) {
+                    block->set_max_noutput_items(threads->maxNoutputItems);
+                }
+                if (threads->minOutputBuffer > 0) {
+                    block->set_min_output_buffer(threads->minOutputBuffer);
+                }
+            }
+        }
+    }
+
+    using output_t = std::pair<gr::basic_block_sptr, int>; // block and output port
+
+    // sinks of several devices are told apart by the device prefix, e.g. circuit2/P
+    gr::pulsed_power::opencmw_time_sink::sptr make_time_sink(const std::vector<std::string> &names, const std::vector<std::string> &units, float samp_rate) const {
+        std::vector<std::string> qualified_names;
+        for (const auto &name : names) {
+            qualified_names.push_back(signal_prefix + name);
+        }
+        return gr::pulsed_power::opencmw_time_sink::make(qualified_names, units, samp_rate);
+    }
+
+    gr::pulsed_power::opencmw_freq_sink::sptr make_freq_sink(const std::vector<std::string> &names, const std::vector<std::string> &units, float samp_rate, float bandwidth, size_t vector_size) const {
+        std::vector<std::string> qualified_names;
+        for (const auto &name : names) {
+            qualified_names.push_back(signal_prefix + name);
+        }
+        return gr::pulsed_power::opencmw_freq_sink::make(qualified_names, units, samp_rate, bandwidth, vector_size);
+    }
+
+    // the integrals are stored in the working directory, one set of files per device
+    std::string integral_file(const std::string &name) const {
+        return device_name.empty() ? name : fmt::format("{}_{}", device_name, name);
+    }
+
+    static gr::filter::fft_filter_fff::sptr make_band_pass_filter(const FlowgraphConfig &config) {
+        return gr::filter::fft_filter_fff::make(
+                FlowgraphConfig::decimation(config.source.sampleRate, config.rates.signals),
+                gr::filter::firdes::band_pass(
+                        1,
+                        config.source.sampleRate,
+                        config.processing.bandPassLow,
+                        config.processing.bandPassHigh,
+                        config.processing.bandPassTransition,
+                        windowType(config.processing.bandPassWindow),
+                        6.76));
+    }
+
+    static gr::filter::fft_filter_fff::sptr make_low_pass_filter(const FlowgraphConfig &config) {
+        return gr::filter::fft_filter_fff::make(
+                1,
+                gr::filter::firdes::low_pass(
+                        1,
+                        config.rates.phaseCalc,
+                        config.processing.lowPassCutoff,
+                        config.processing.lowPassTransition,
+                        windowType(config.processing.lowPassWindow),
+                        6.76));
+    }
+
+    // publishes the outputs in one time sink, keeping one in decimation samples of each
+    void connect_time_sink(const std::vector<output_t> &outputs, int decimation, const std::vector<std::string> &names, const std::vector<std::string> &units, float samp_rate, int noutput_items) {
+        auto sink = make_time_sink(names, units, samp_rate);
+        sink->set_max_noutput_items(noutput_items);
+        for (size_t i = 0; i < outputs.size(); i++) {
+            const auto &[block, port] = outputs[i];
+            if (decimation == 1) {
+                connect(block, port, sink, static_cast<int>(i));
+                continue;
+            }
+            auto keep_one_in_n = gr::blocks::keep_one_in_n::make(sizeof(float), decimation);
+            connect(block, port, keep_one_in_n, 0);
+            connect(keep_one_in_n, 0, sink, static_cast<int>(i));
+        }
+    }
+
+    // mean, min and max of P, Q, S and phi in one time sink, the standard deviations are dropped
+    void connect_statistics_sink(const std::vector<output_t> &power, int decimation, float samp_rate, int noutput_items) {
+        auto sink = make_time_sink(
+                { "P_mean", "P_min", "P_max", "Q_mean", "Q_min", "Q_max", "S_mean", "S_min", "S_max", "phi_mean", "phi_min", "phi_max" },
+                { "W", "W", "W", "Var", "Var", "Var", "VA", "VA", "VA", "rad", "rad", "rad" },
+                samp_rate);
+        sink->set_max_noutput_items(noutput_items);
+        auto null_sink_std_dev = gr::blocks::null_sink::make(sizeof(float));
+        for (size_t i = 0; i < power.size(); i++) {
+            const int port       = static_cast<int>(i);
+            auto      statistics = gr::pulsed_power::statistics::make(decimation);
+            connect(power[i].first, power[i].second, statistics, 0);
+            connect(statistics, 0, sink, 3 * port);     // mean
+            connect(statistics, 1, sink, 3 * port + 1); // min
+            connect(statistics, 2, sink, 3 * port + 2); // max
+            connect(statistics, 3, null_sink_std_dev, port);
+        }
+    }
+
+    // magnitude squared spectrum of a signal at the source rate for the NILM
+    void connect_nilm_spectrum(const FlowgraphConfig &config, const gr::basic_block_sptr &signal, const std::string &name, const std::string &unit) {
+        const int    fft_size         = config.spectra.nilmFftSize;
+        const size_t fft_vector_size  = static_cast<size_t>(fft_size);
+        auto         stream_to_vector = gr::blocks::stream_to_vector::make(sizeof(float) * 1, fft_vector_size);
+        auto         fft              = gr::fft::fft_v<float, true>::make(fft_size, gr::fft::window::build(windowType(config.spectra.nilmWindow), fft_size), false, 1);
+        auto         complex_to_mag   = gr::blocks::complex_to_mag_squared::make(fft_vector_size);
+        auto         sink             = make_freq_sink({ name }, { unit }, config.source.sampleRate, config.source.sampleRate, fft_vector_size);
+        sink->set_max_noutput_items(config.sinks.maxNoutputItemsSpectra);
+
+        connect(signal, 0, stream_to_vector, 0);
+        connect(stream_to_vector, 0, fft, 0);
+        connect(fft, 0, complex_to_mag, 0);
+        connect(complex_to_mag, 0, sink, 0);
+    }
+
+    // amplitude spectrum of the low pass filtered power on the PPEM dashboard
+    void connect_ppem_spectrum(const FlowgraphConfig &config, const gr::basic_block_sptr &power) {
+        const int    fft_size        = config.spectra.ppemFftSize;
+        const size_t fft_vector_size = static_cast<size_t>(fft_size);
+        const float  samp_rate_pre   = config.source.sampleRate / static_cast<float>(config.spectra.ppemPreDecimation);
+        const float  samp_rate       = config.spectra.ppemSampleRate;
+        auto         one_in_n        = gr::blocks::keep_one_in_n::make(sizeof(float), config.spectra.ppemPreDecimation);
+        auto         low_pass        = gr::filter::fft_filter_fff::make(FlowgraphConfig::decimation(samp_rate_pre, samp_rate), gr::filter::firdes::low_pass(1, samp_rate_pre, config.spectra.ppemLowPassCutoff, config.spectra.ppemLowPassTransition, gr::fft::window::win_type::WIN_HAMMING, 6.76));
+        auto         stream_to_vec   = gr::blocks::stream_to_vector::make(sizeof(float), fft_vector_size);
+        auto         fft             = gr::fft::fft_v<float, true>::make(fft_size, gr::fft::window::build(windowType(config.spectra.ppemWindow), fft_size), true, 1);
+        auto         multiply_const  = gr::blocks::multiply_const<gr_complex>::make(2.0 / static_cast<double>(fft_size), fft_vector_size);
+        auto         complex_to_mag  = gr::blocks::complex_to_mag::make(fft_vector_size);
+        auto         sink            = make_freq_sink({ "sinus_fft" }, { "W" }, samp_rate, samp_rate, fft_vector_size);
+        sink->set_max_noutput_items(config.sinks.maxNoutputItemsSpectra);
+
+        connect(power, 0, one_in_n, 0);
+        connect(one_in_n, 0, low_pass, 0);
+        connect(low_pass, 0, stream_to_vec, 0);
+        connect(stream_to_vec, 0, fft, 0);
+        connect(fft, 0, multiply_const, 0);
+        connect(multiply_const, 0, complex_to_mag, 0);
+        connect(complex_to_mag, 0, sink, 0);
+    }
+
+    // band pass, phase difference and power of one phase, returns the power calculation with the outputs P, Q, S, phi.
+    // Every phase is a separate branch of blocks, the thread-per-block scheduler processes the phases in parallel.
+    gr::basic_block_sptr connect_phase(const FlowgraphConfig &config, const std::string &phase, const gr::basic_block_sptr &voltage, const gr::basic_block_sptr &current) {
+        const float samp_rate_delta_phi_calc  = config.rates.phaseCalc;
+        const int   decimation_out_raw        = FlowgraphConfig::decimation(config.source.sampleRate, config.rates.signals);
+        const int   decimation_delta_phi_calc = FlowgraphConfig::decimation(config.rates.signals, samp_rate_delta_phi_calc);
+
+        // blocks
+        auto out_decimation_voltage       = gr::blocks::keep_one_in_n::make(sizeof(float), decimation_out_raw);
+        auto out_decimation_current       = gr::blocks::keep_one_in_n::make(sizeof(float), decimation_out_raw);
+        auto band_pass_filter_voltage     = make_band_pass_filter(config);
+        auto band_pass_filter_current     = make_band_pass_filter(config);
+        auto decimation_block_voltage_bpf = gr::blocks::keep_one_in_n::make(sizeof(float), decimation_delta_phi_calc);
+        auto decimation_block_current_bpf = gr::blocks::keep_one_in_n::make(sizeof(float), decimation_delta_phi_calc);
+
+        auto analog_sig_source_phase_sin  = gr::analog::sig_source_f::make(samp_rate_delta_phi_calc, gr::analog::GR_SIN_WAVE, config.processing.phaseReference, 1, 0, 0.0f);
+        auto analog_sig_source_phase_cos  = gr::analog::sig_source_f::make(samp_rate_delta_phi_calc, gr::analog::GR_COS_WAVE, config.processing.phaseReference, 1, 0, 0.0f);
+        auto blocks_multiply_phase_0      = gr::blocks::multiply_ff::make(1);
+        auto blocks_multiply_phase_1      = gr::blocks::multiply_ff::make(1);
+        auto blocks_multiply_phase_2      = gr::blocks::multiply_ff::make(1);
+        auto blocks_multiply_phase_3      = gr::blocks::multiply_ff::make(1);
+        auto low_pass_filter_voltage_0    = make_low_pass_filter(config);
+        auto low_pass_filter_voltage_1    = make_low_pass_filter(config);
+        auto low_pass_filter_current_0    = make_low_pass_filter(config);
+        auto low_pass_filter_current_1    = make_low_pass_filter(config);
+        auto blocks_divide_phase_0        = gr::blocks::divide_ff::make(1);
+        auto blocks_divide_phase_1        = gr::blocks::divide_ff::make(1);
+        auto blocks_transcendental_0      = gr::blocks::transcendental::make("atan");
+        auto blocks_transcendental_1      = gr::blocks::transcendental::make("atan");
+        auto blocks_sub_phase             = gr::blocks::sub_ff::make(1);
+        auto power_calc                   = gr::pulsed_power::power_calc_ff::make(config.processing.powerCalcAlpha);
+
+        // U, I and the band pass filtered signals
+        auto opencmw_time_sink_signals = make_time_sink(
+                { "U_" + phase, "I_" + phase, "U_bpf_" + phase, "I_bpf_" + phase },
+                { "V", "A", "V", "A" },
+                config.rates.signals);
+        opencmw_time_sink_signals->set_max_noutput_items(config.sinks.maxNoutputItems);
+
+        // connections
+        // signal
+        connect(voltage, 0, out_decimation_voltage, 0);
+        connect(current, 0, out_decimation_current, 0);
+        connect(out_decimation_voltage, 0, opencmw_time_sink_signals, 0); // U_raw
+        connect(out_decimation_current, 0, opencmw_time_sink_signals, 1); // I_raw
+        // Bandpass filter
+        connect(voltage, 0, band_pass_filter_voltage, 0);
+        connect(current, 0, band_pass_filter_current, 0);
+        connect(band_pass_filter_voltage, 0, opencmw_time_sink_signals, 2); // U_bpf
+        connect(band_pass_filter_current, 0, opencmw_time_sink_signals, 3); // I_bpf
+        // Calculate phase shift
+        connect(band_pass_filter_voltage, 0, decimation_block_voltage_bpf, 0);
+        connect(band_pass_filter_current, 0, decimation_block_current_bpf, 0);
+        connect(decimation_block_voltage_bpf, 0, blocks_multiply_phase_0, 0);
+        connect(decimation_block_voltage_bpf, 0, blocks_multiply_phase_1, 0);
+        connect(decimation_block_current_bpf, 0, blocks_multiply_phase_2, 0);
+        connect(decimation_block_current_bpf, 0, blocks_multiply_phase_3, 0);
+        connect(analog_sig_source_phase_sin, 0, blocks_multiply_phase_0, 1);
+        connect(analog_sig_source_phase_sin, 0, blocks_multiply_phase_2, 1);
+        connect(analog_sig_source_phase_cos, 0, blocks_multiply_phase_1, 1);
+        connect(analog_sig_source_phase_cos, 0, blocks_multiply_phase_3, 1);
+        connect(blocks_multiply_phase_0, 0, low_pass_filter_voltage_0, 0);
+        connect(blocks_multiply_phase_1, 0, low_pass_filter_voltage_1, 0);
+        connect(blocks_multiply_phase_2, 0, low_pass_filter_current_0, 0);
+        connect(blocks_multiply_phase_3, 0, low_pass_filter_current_1, 0);
+        connect(low_pass_filter_voltage_0, 0, blocks_divide_phase_0, 0);
+        connect(low_pass_filter_voltage_1, 0, blocks_divide_phase_0, 1);
+        connect(low_pass_filter_current_0, 0, blocks_divide_phase_1, 0);
+        connect(low_pass_filter_current_1, 0, blocks_divide_phase_1, 1);
+        connect(blocks_divide_phase_0, 0, blocks_transcendental_0, 0);
+        connect(blocks_divide_phase_1, 0, blocks_transcendental_1, 0);
+        connect(blocks_transcendental_0, 0, blocks_sub_phase, 0);
+        connect(blocks_transcendental_1, 0, blocks_sub_phase, 1);
+        // Calculate P, Q, S, phi
+        connect(decimation_block_voltage_bpf, 0, power_calc, 0);
+        connect(decimation_block_current_bpf, 0, power_calc, 1);
+        connect(blocks_sub_phase, 0, power_calc, 2);
+        return power_calc;
+    }
+
+    // three phases on picoscope channels A/B, C/D and E/F, per phase sinks are suffixed with the phase name,
+    // the sums over all phases are published under the names of the single phase flowgraph
+    void connect_three_phase(const FlowgraphConfig &config) {
+        const int                         noutput_items    = config.sinks.maxNoutputItems;
+        const float                       source_samp_rate = config.source.sampleRate;
+        const std::array<std::string, 3>  phase_names      = { "L1", "L2", "L3" };
+        std::vector<gr::basic_block_sptr> voltages;
+        std::vector<gr::basic_block_sptr> currents;
+        std::vector<gr::basic_block_sptr> power_calcs;
+        for (size_t phase = 0; phase < phase_names.size(); phase++) {
+            voltages.push_back(gr::blocks::multiply_const_ff::make(1));
+            currents.push_back(gr::blocks::multiply_const_ff::make(1));
+        }
+
+        if (config.source.type == "picoscope") {
+            gr::pulsed_power::coupling_t picoscope_coupling = gr::pulsed_power::AC_1M;
+
+            // blocks
+            auto picoscope_source = gr::pulsed_power::picoscope_4000a_source::make(config.source.serial, true);
+            digitizers.push_back(picoscope_source);
+            picoscope_source->set_trigger_once(false);
+            picoscope_source->set_samp_rate(source_samp_rate);
+            picoscope_source->set_downsampling(gr::pulsed_power::DOWNSAMPLING_MODE_NONE, 1);
+            picoscope_source->set_aichan_a(true, config.source.voltageRange, picoscope_coupling, 0.0);
+            picoscope_source->set_aichan_b(true, config.source.currentRange, picoscope_coupling, 0.0);
+            picoscope_source->set_aichan_c(true, config.source.voltageRange, picoscope_coupling, 0.0);
+            picoscope_source->set_aichan_d(true, config.source.currentRange, picoscope_coupling, 0.0);
+            picoscope_source->set_aichan_e(true, config.source.voltageRange, picoscope_coupling, 0.0);
+            picoscope_source->set_aichan_f(true, config.source.currentRange, picoscope_coupling, 0.0);
+            picoscope_source->set_aichan_g(false, 5.0, picoscope_coupling, 5.0);
+            picoscope_source->set_aichan_h(false, 5.0, picoscope_coupling, 0.0);
+
+            // mode = streaming
+            picoscope_source->set_nr_buffers(config.source.nrBuffers);
+            picoscope_source->set_driver_buffer_size(config.source.driverBufferSize);
+            picoscope_source->set_streaming(config.source.streamingInterval);
+            picoscope_source->set_buffer_size(config.source.bufferSize);
+
+            // outputs 2 * channel are the values, the others the errors and the unused channels G and H
+            auto null_sink_picoscope = gr::blocks::null_sink::make(sizeof(float));
+            int  null_sink_port      = 0;
+            for (int output = 0; output < 16; output++) {
+                if (output % 2 == 1 || output >= 12) {
+                    connect(picoscope_source, output, null_sink_picoscope, null_sink_port++);
+                }
+            }
+            for (size_t phase = 0; phase < phase_names.size(); phase++) {
+                auto voltage = gr::blocks::multiply_const_ff::make(config.source.voltageCorrection);
+                auto current = gr::blocks::multiply_const_ff::make(config.source.currentCorrection);
+                connect(picoscope_source, 4 * static_cast<int>(phase), voltage, 0);
+                connect(picoscope_source, 4 * static_cast<int>(phase) + 2, current, 0);
+                connect(voltage, 0, voltages[phase], 0);
+                connect(current, 0, currents[phase], 0);
+            }
+        } else {
+            for (size_t phase = 0; phase < phase_names.size(); phase++) {
+                // phases shifted by 120 degrees
+                const float shift                     = 2.0f * PI / 3.0f * static_cast<float>(phase);
+                auto        analog_sig_source_voltage = gr::analog::sig_source_f::make(source_samp_rate, gr::analog::GR_SIN_WAVE, 50, 325, 0, shift);       // U_raw
+                auto        analog_sig_source_current = gr::analog::sig_source_f::make(source_samp_rate, gr::analog::GR_SIN_WAVE, 50, 50, 0, shift + 0.2f); // I_raw
+                auto        throttle_voltage          = gr::blocks::throttle::make(sizeof(float) * 1, source_samp_rate, true);
+                auto        throttle_current          = gr::blocks::throttle::make(sizeof(float) * 1, source_samp_rate, true);
+                connect(analog_sig_source_voltage, 0, throttle_voltage, 0);
+                connect(analog_sig_source_current, 0, throttle_current, 0);
+                if (!config.source.addNoise) {
+                    connect(throttle_voltage, 0, voltages[phase], 0);
+                    connect(throttle_current, 0, currents[phase], 0);
+                    continue;
+                }
+                auto noise_source_voltage   = gr::analog::noise_source_f::make(gr::analog::GR_GAUSSIAN, 16.25f);
+                auto noise_source_current   = gr::analog::noise_source_f::make(gr::analog::GR_GAUSSIAN, 0.25f);
+                auto throttle_noise_voltage = gr::blocks::throttle::make(sizeof(float) * 1, source_samp_rate, true);
+                auto throttle_noise_current = gr::blocks::throttle::make(sizeof(float) * 1, source_samp_rate, true);
+                auto add_noise_voltage      = gr::blocks::add_ff::make(1);
+                auto add_noise_current      = gr::blocks::add_ff::make(1);
+                connect(noise_source_voltage, 0, throttle_noise_voltage, 0);
+                connect(noise_source_current, 0, throttle_noise_current, 0);
+                connect(throttle_voltage, 0, add_noise_voltage, 0);
+                connect(throttle_noise_voltage, 0, add_noise_voltage, 1);
+                connect(throttle_current, 0, add_noise_current, 0);
+                connect(throttle_noise_current, 0, add_noise_current, 1);
+                connect(add_noise_voltage, 0, voltages[phase], 0);
+                connect(add_noise_current, 0, currents[phase], 0);
+            }
+        }
+
+        // per phase branches, summed up at rates.phaseCalc
+        const float samp_rate_delta_phi_calc = config.rates.phaseCalc;
+        auto        add_p                    = gr::blocks::add_ff::make(1);
+        auto        add_q                    = gr::blocks::add_ff::make(1);
+        auto        add_s                    = gr::blocks::add_ff::make(1); // arithmetic apparent power
+        auto        divide_q_p               = gr::blocks::divide_ff::make(1);
+        auto        transcendental_phi       = gr::blocks::transcendental::make("atan");
+        auto        add_voltage_current      = gr::blocks::add_ff::make(1); // instantaneous power of all phases
+        for (size_t phase = 0; phase < phase_names.size(); phase++) {
+            const int port                     = static_cast<int>(phase);
+            auto      power_calc               = connect_phase(config, phase_names[phase], voltages[phase], currents[phase]);
+            auto      multiply_voltage_current = gr::blocks::multiply_ff::make(1);
+            connect(power_calc, 0, add_p, port);
+            connect(power_calc, 1, add_q, port);
+            connect(power_calc, 2, add_s, port);
+            connect(voltages[phase], 0, multiply_voltage_current, 0);
+            connect(currents[phase], 0, multiply_voltage_current, 1);
+            connect(multiply_voltage_current, 0, add_voltage_current, port);
+            power_calcs.push_back(power_calc);
+        }
+        connect(add_q, 0, divide_q_p, 0);
+        connect(add_p, 0, divide_q_p, 1);
+        connect(divide_q_p, 0, transcendental_phi, 0);
+        const std::vector<output_t> totals = { { add_p, 0 }, { add_q, 0 }, { add_s, 0 }, { transcendental_phi, 0 } };
+
+        // Mains frequency (L1), power, statistics
+        auto calc_mains_frequency = gr::pulsed_power::mains_frequency_calc::make(source_samp_rate, config.processing.mainsFrequencyLow, config.processing.mainsFrequencyHigh);
+        connect(voltages[0], 0, calc_mains_frequency, 0);
+        for (const float rate : { config.rates.shortTerm, config.rates.midTerm, config.rates.longTerm }) {
+            const int decimation = FlowgraphConfig::decimation(samp_rate_delta_phi_calc, rate);
+            connect_time_sink({ { calc_mains_frequency, 0 } }, FlowgraphConfig::decimation(source_samp_rate, rate), { "mains_freq" }, { "Hz" }, rate, noutput_items);
+            for (size_t phase = 0; phase < phase_names.size(); phase++) {
+                const auto &name = phase_names[phase];
+                connect_time_sink({ { power_calcs[phase], 0 }, { power_calcs[phase], 1 }, { power_calcs[phase], 2 }, { power_calcs[phase], 3 } }, decimation,
+                        { "P_" + name, "Q_" + name, "S_" + name, "phi_" + name }, { "W", "Var", "VA", "rad" }, rate, noutput_items);
+            }
+            connect_time_sink(totals, decimation, { "P", "Q", "S", "phi" }, { "W", "Var", "VA", "rad" }, rate, noutput_items);
+            connect_statistics_sink(totals, decimation, rate, noutput_items);
+        }
+
+        // Integrals
+        const int decimation_integrals = FlowgraphConfig::decimation(samp_rate_delta_phi_calc, config.rates.integrals);
+        for (const auto &[duration, name] : { std::pair{ gr::pulsed_power::INTEGRATION_DURATION::DAY, "Day" }, std::pair{ gr::pulsed_power::INTEGRATION_DURATION::WEEK, "Week" }, std::pair{ gr::pulsed_power::INTEGRATION_DURATION::MONTH, "Month" } }) {
+            auto integrate_P = gr::pulsed_power::integration::make(decimation_integrals, static_cast<int>(samp_rate_delta_phi_calc), duration, integral_file(fmt::format("P{}.txt", name)));
+            auto integrate_S = gr::pulsed_power::integration::make(decimation_integrals, static_cast<int>(samp_rate_delta_phi_calc), duration, integral_file(fmt::format("S{}.txt", name)));
+            connect(add_p, 0, integrate_P, 0);
+            connect(add_s, 0, integrate_S, 0);
+            connect_time_sink({ { integrate_P, 0 }, { integrate_S, 0 } }, 1, { fmt::format("P_Int_{}", name), fmt::format("S_Int_{}", name) }, { "Wh", "VAh" }, config.rates.integrals, noutput_items);
+        }
+
+        // Frequency spectras, U and I of L1, S and the PPEM spectrum of the power of all phases
+        connect_nilm_spectrum(config, voltages[0], "VoltageSpectrumNilm", "V");
+        connect_nilm_spectrum(config, currents[0], "CurrentSpectrumNilm", "A");
+        connect_nilm_spectrum(config, add_voltage_current, "ApparentPowerSpectrumNilm", "VA");
+        connect_ppem_spectrum(config, add_voltage_current);
+    }
 
 public:
-    PulsedPowerFlowgraph(int noutput_items, bool use_picoscope = false, bool add_noise = true)
-        : top(gr::make_top_block("GNURadio")) {
-        float source_samp_rate          = 2'000'000.0f;
-        auto  source_interface_voltage0 = gr::blocks::multiply_const_ff::make(1);
-        auto  source_interface_current0 = gr::blocks::multiply_const_ff::make(1);
-        if (use_picoscope) {
-            source_samp_rate                                                  = 2'000'000.0f;
-            const float                           current_correction_factor   = 2.5f;
-            const float                           voltage_correction_factor   = 100.0f;
+    // the configuration has to be valid, see FlowgraphConfig::validate()
+    explicit PulsedPowerFlowgraph(const FlowgraphConfig &config)
+        : top(gr::make_top_block("GNURadio")), device_name(config.source.name), signal_prefix(config.signalPrefix()) {
+        if (config.source.phases == 3) {
+            connect_three_phase(config);
+        } else {
+            connect_single_phase(config);
+        }
+        apply_placement(config.placement);
+        // read by the block executors when the flowgraph starts
+        gr::prefs::singleton()->set_bool("PerfCounters", "on", config.performance.publishRate > 0.0f);
+    }
+    ~PulsedPowerFlowgraph() { top->stop(); }
+    // start gnuradio flowgraph
+    void start() { top->start(); }
+
+    const std::vector<gr::basic_block_sptr> &get_blocks() const { return blocks; }
+
+    const std::vector<gr::pulsed_power::picoscope_4000a_source::sptr> &get_digitizers() const { return digitizers; }
+
+    // thread settings and blocks of every placement group
+    void print_placement(const PlacementConfig &placement) const {
+        std::map<std::string, std::map<std::string, int>> group_blocks; // group -> block name -> count
+        for (const auto &block : blocks) {
+            group_blocks[placement_group(block->name())][block->name()]++;
+        }
+        auto setting = [](int32_t value) { return value > 0 ? std::to_string(value) : std::string("-"); };
+        fmt::print("flowgraph {}thread placement, {} blocks, one thread each\n", device_name.empty() ? "" : fmt::format("'{}' ", device_name), blocks.size());
+        fmt::print("{:<12} {:<12} {:>8} {:>10} {:>10}  {}\n", "group", "cores", "priority", "max items", "min buffer", "blocks");
+        for (const auto &[group, threads] : placement_groups(placement)) {
+            std::vector<std::string> names;
+            for (const auto &[name, count] : group_blocks[group]) {
+                names.push_back(count == 1 ? name : fmt::format("{} x{}", name, count));
+            }
+            const std::string cores = threads->cores.empty() ? "any" : fmt::format("{}", fmt::join(threads->cores, ","));
+            fmt::print("{:<12} {:<12} {:>8} {:>10} {:>10}  {}\n", group, cores, setting(threads->priority), setting(threads->maxNoutputItems), setting(threads->minOutputBuffer), fmt::join(names, ", "));
+        }
+    }
+
+private:
+    void connect_single_phase(const FlowgraphConfig &config) {
+        const int   noutput_items             = config.sinks.maxNoutputItems;
+        const int   noutput_items_spectra     = config.sinks.maxNoutputItemsSpectra;
+        const float source_samp_rate          = config.source.sampleRate;
+        auto        source_interface_voltage0 = gr::blocks::multiply_const_ff::make(1);
+        auto        source_interface_current0 = gr::blocks::multiply_const_ff::make(1);
+        if (config.source.type == "picoscope") {
+            const float                           current_correction_factor   = config.source.currentCorrection;
+            const float                           voltage_correction_factor   = config.source.voltageCorrection;
             gr::pulsed_power::downsampling_mode_t picoscope_downsampling_mode = gr::pulsed_power::DOWNSAMPLING_MODE_NONE;
             gr::pulsed_power::coupling_t          picoscope_coupling          = gr::pulsed_power::AC_1M;
 
             // blocks
-            auto picoscope_source = gr::pulsed_power::picoscope_4000a_source::make("", true);
+            auto picoscope_source = gr::pulsed_power::picoscope_4000a_source::make(config.source.serial, true);
+            digitizers.push_back(picoscope_source);
             picoscope_source->set_trigger_once(false);
             picoscope_source->set_samp_rate(source_samp_rate);
             picoscope_source->set_downsampling(picoscope_downsampling_mode, 1);
-            picoscope_source->set_aichan_a(true, 5, picoscope_coupling, 0.0);
-            picoscope_source->set_aichan_b(true, 1, picoscope_coupling, 0.0);
+            picoscope_source->set_aichan_a(true, config.source.voltageRange, picoscope_coupling, 0.0);
+            picoscope_source->set_aichan_b(true, config.source.currentRange, picoscope_coupling, 0.0);
             picoscope_source->set_aichan_c(false, 5.0, picoscope_coupling, 5.0);
             picoscope_source->set_aichan_d(false, 5.0, picoscope_coupling, 0.0);
             picoscope_source->set_aichan_e(false, 5, picoscope_coupling, 0.0);
@@ -150,37 +622,37 @@ public:
             picoscope_source->set_aichan_h(false, 5.0, picoscope_coupling, 0.0);
 
             // mode = streaming
-            picoscope_source->set_nr_buffers(64);
-            picoscope_source->set_driver_buffer_size(102400);
-            picoscope_source->set_streaming(0.0005);
-            picoscope_source->set_buffer_size(204800);
+            picoscope_source->set_nr_buffers(config.source.nrBuffers);
+            picoscope_source->set_driver_buffer_size(config.source.driverBufferSize);
+            picoscope_source->set_streaming(config.source.streamingInterval);
+            picoscope_source->set_buffer_size(config.source.bufferSize);
 
             auto null_sink_picoscope = gr::blocks::null_sink::make(sizeof(float));
             auto voltage0            = gr::blocks::multiply_const_ff::make(voltage_correction_factor);
             auto current0            = gr::blocks::multiply_const_ff::make(current_correction_factor);
 
             // connections
-            top->hier_block2::connect(picoscope_source, 0, voltage0, 0);
-            top->hier_block2::connect(picoscope_source, 2, current0, 0);
-            top->hier_block2::connect(picoscope_source, 1, null_sink_picoscope, 0);
-            top->hier_block2::connect(picoscope_source, 8, null_sink_picoscope, 1);
-            top->hier_block2::connect(picoscope_source, 3, null_sink_picoscope, 2);
-            top->hier_block2::connect(picoscope_source, 4, null_sink_picoscope, 3);
-            top->hier_block2::connect(picoscope_source, 5, null_sink_picoscope, 4);
-            top->hier_block2::connect(picoscope_source, 6, null_sink_picoscope, 5);
-            top->hier_block2::connect(picoscope_source, 7, null_sink_picoscope, 6);
-            top->hier_block2::connect(picoscope_source, 9, null_sink_picoscope, 7);
-            top->hier_block2::connect(picoscope_source, 10, null_sink_picoscope, 8);
-            top->hier_block2::connect(picoscope_source, 11, null_sink_picoscope, 9);
-            top->hier_block2::connect(picoscope_source, 12, null_sink_picoscope, 10);
-            top->hier_block2::connect(picoscope_source, 13, null_sink_picoscope, 11);
-            top->hier_block2::connect(picoscope_source, 14, null_sink_picoscope, 12);
-            top->hier_block2::connect(picoscope_source, 15, null_sink_picoscope, 13);
-            top->hier_block2::connect(voltage0, 0, source_interface_voltage0, 0);
-            top->hier_block2::connect(current0, 0, source_interface_current0, 0);
+            connect(picoscope_source, 0, voltage0, 0);
+            connect(picoscope_source, 2, current0, 0);
+            connect(picoscope_source, 1, null_sink_picoscope, 0);
+            connect(picoscope_source, 8, null_sink_picoscope, 1);
+            connect(picoscope_source, 3, null_sink_picoscope, 2);
+            connect(picoscope_source, 4, null_sink_picoscope, 3);
+            connect(picoscope_source, 5, null_sink_picoscope, 4);
+            connect(picoscope_source, 6, null_sink_picoscope, 5);
+            connect(picoscope_source, 7, null_sink_picoscope, 6);
+            connect(picoscope_source, 9, null_sink_picoscope, 7);
+            connect(picoscope_source, 10, null_sink_picoscope, 8);
+            connect(picoscope_source, 11, null_sink_picoscope, 9);
+            connect(picoscope_source, 12, null_sink_picoscope, 10);
+            connect(picoscope_source, 13, null_sink_picoscope, 11);
+            connect(picoscope_source, 14, null_sink_picoscope, 12);
+            connect(picoscope_source, 15, null_sink_picoscope, 13);
+            connect(voltage0, 0, source_interface_voltage0, 0);
+            connect(current0, 0, source_interface_current0, 0);
 
         } else {
-            if (add_noise) {
+            if (config.source.addNoise) {
                 // blocks
                 auto analog_sig_source_voltage0        = gr::analog::sig_source_f::make(source_samp_rate, gr::analog::GR_SIN_WAVE, 50, 325, 0, 0.0f); // U_raw
                 auto analog_sig_source_current0        = gr::analog::sig_source_f::make(source_samp_rate, gr::analog::GR_SIN_WAVE, 50, 50, 0, 0.2f);  // I_raw
@@ -201,22 +673,22 @@ public:
                 auto add_noise_voltage0                = gr::blocks::add_ff::make(1);
 
                 // connections
-                top->hier_block2::connect(analog_sig_source_voltage0, 0, throttle_voltage0, 0);
-                top->hier_block2::connect(analog_sig_source_current0, 0, throttle_current0, 0);
-                top->hier_block2::connect(analog_sig_source_freq_modulation, 0, throttle_freq_modulation, 0);
-                top->hier_block2::connect(noise_source_voltage0, 0, throttle_noise_voltage0, 0);
-                top->hier_block2::connect(noise_source_current0, 0, throttle_noise_current0, 0);
+                connect(analog_sig_source_voltage0, 0, throttle_voltage0, 0);
+                connect(analog_sig_source_current0, 0, throttle_current0, 0);
+                connect(analog_sig_source_freq_modulation, 0, throttle_freq_modulation, 0);
+                connect(noise_source_voltage0, 0, throttle_noise_voltage0, 0);
+                connect(noise_source_current0, 0, throttle_noise_current0, 0);
                 // multiply frequency modulation
-                top->hier_block2::connect(throttle_current0, 0, multiply_freq_modulation, 0);
-                top->hier_block2::connect(throttle_freq_modulation, 0, multiply_freq_modulation, 1);
+                connect(throttle_current0, 0, multiply_freq_modulation, 0);
+                connect(throttle_freq_modulation, 0, multiply_freq_modulation, 1);
                 // add noise
-                top->hier_block2::connect(throttle_voltage0, 0, add_noise_voltage0, 0);
-                top->hier_block2::connect(throttle_noise_voltage0, 0, add_noise_voltage0, 1);
-                top->hier_block2::connect(multiply_freq_modulation, 0, add_noise_current0, 0);
-                top->hier_block2::connect(throttle_noise_current0, 0, add_noise_current0, 1);
+                connect(throttle_voltage0, 0, add_noise_voltage0, 0);
+                connect(throttle_noise_voltage0, 0, add_noise_voltage0, 1);
+                connect(multiply_freq_modulation, 0, add_noise_current0, 0);
+                connect(throttle_noise_current0, 0, add_noise_current0, 1);
                 // connect to interface
-                top->hier_block2::connect(add_noise_voltage0, 0, source_interface_voltage0, 0);
-                top->hier_block2::connect(add_noise_current0, 0, source_interface_current0, 0);
+                connect(add_noise_voltage0, 0, source_interface_voltage0, 0);
+                connect(add_noise_current0, 0, source_interface_current0, 0);
             } else {
                 // blocks
                 auto analog_sig_source_voltage0 = gr::analog::sig_source_f::make(source_samp_rate, gr::analog::GR_SIN_WAVE, 50, 325, 0, 0.0f); // U_raw
@@ -226,83 +698,93 @@ public:
                 auto throttle_current0          = gr::blocks::throttle::make(sizeof(float) * 1, source_samp_rate, true);
 
                 // connections
-                top->hier_block2::connect(analog_sig_source_voltage0, 0, throttle_voltage0, 0);
-                top->hier_block2::connect(analog_sig_source_current0, 0, throttle_current0, 0);
+                connect(analog_sig_source_voltage0, 0, throttle_voltage0, 0);
+                connect(analog_sig_source_current0, 0, throttle_current0, 0);
                 // connect to interface
-                top->hier_block2::connect(throttle_voltage0, 0, source_interface_voltage0, 0);
-                top->hier_block2::connect(throttle_current0, 0, source_interface_current0, 0);
+                connect(throttle_voltage0, 0, source_interface_voltage0, 0);
+                connect(throttle_current0, 0, source_interface_current0, 0);
             }
         }
 
         // parameters
-        const float samp_rate_delta_phi_calc = 1'000.0f;
+        const auto  decimation               = FlowgraphConfig::decimation;
+        const float samp_rate_delta_phi_calc = config.rates.phaseCalc;
         // parameters decimation
-        const float out_samp_rate_ui                     = 1'000.0f;
-        const float out_samp_rate_power_shortterm        = 100.0f;
-        const float out_samp_rate_power_midterm          = 1.0f;
-        const float out_samp_rate_power_longterm         = 1.0f / 60.0f;
-        int         decimation_out_raw                   = static_cast<int>(roundf(source_samp_rate / out_samp_rate_ui));
-        int         decimation_out_bpf                   = static_cast<int>(roundf(source_samp_rate / out_samp_rate_ui));
-        int         decimation_out_mains_freq_short_term = static_cast<int>(roundf(source_samp_rate / out_samp_rate_power_shortterm));
-        int         decimation_out_mains_freq_mid_term   = static_cast<int>(roundf(source_samp_rate / out_samp_rate_power_midterm));
-        int         decimation_out_mains_freq_long_term  = static_cast<int>(roundf(source_samp_rate / out_samp_rate_power_longterm));
-        int         decimation_out_short_term            = static_cast<int>(roundf(samp_rate_delta_phi_calc / out_samp_rate_power_shortterm));
-        int         decimation_out_mid_term              = static_cast<int>(roundf(samp_rate_delta_phi_calc / out_samp_rate_power_midterm));
-        int         decimation_out_long_term             = static_cast<int>(roundf(samp_rate_delta_phi_calc / out_samp_rate_power_longterm));
+        const float out_samp_rate_ui                     = config.rates.signals;
+        const float out_samp_rate_power_shortterm        = config.rates.shortTerm;
+        const float out_samp_rate_power_midterm          = config.rates.midTerm;
+        const float out_samp_rate_power_longterm         = config.rates.longTerm;
+        const float out_samp_rate_integrals              = config.rates.integrals;
+        int         decimation_out_raw                   = decimation(source_samp_rate, out_samp_rate_ui);
+        int         decimation_out_bpf                   = decimation(source_samp_rate, out_samp_rate_ui);
+        int         decimation_out_mains_freq_short_term = decimation(source_samp_rate, out_samp_rate_power_shortterm);
+        int         decimation_out_mains_freq_mid_term   = decimation(source_samp_rate, out_samp_rate_power_midterm);
+        int         decimation_out_mains_freq_long_term  = decimation(source_samp_rate, out_samp_rate_power_longterm);
+        int         decimation_out_short_term            = decimation(samp_rate_delta_phi_calc, out_samp_rate_power_shortterm);
+        int         decimation_out_mid_term              = decimation(samp_rate_delta_phi_calc, out_samp_rate_power_midterm);
+        int         decimation_out_long_term             = decimation(samp_rate_delta_phi_calc, out_samp_rate_power_longterm);
+        int         decimation_integrals                 = decimation(samp_rate_delta_phi_calc, out_samp_rate_integrals);
         // parameters band pass filter
-        const int   decimation_bpf            = static_cast<int>(roundf(source_samp_rate / out_samp_rate_ui));
-        const float bpf_high_cut              = 80.0f;
-        const float bpf_low_cut               = 20.0f;
-        const float bpf_trans                 = 1000.0f;
-        const int   decimation_delta_phi_calc = static_cast<int>(roundf(out_samp_rate_ui / samp_rate_delta_phi_calc));
+        const int   decimation_bpf            = decimation(source_samp_rate, out_samp_rate_ui);
+        const float bpf_high_cut              = config.processing.bandPassHigh;
+        const float bpf_low_cut               = config.processing.bandPassLow;
+        const float bpf_trans                 = config.processing.bandPassTransition;
+        const auto  bpf_window                = windowType(config.processing.bandPassWindow);
+        const int   decimation_delta_phi_calc = decimation(out_samp_rate_ui, samp_rate_delta_phi_calc);
         // parameters low pass filter
         const int   decimation_lpf   = 1;
         const float lpf_in_samp_rate = samp_rate_delta_phi_calc;
-        const float lpf_trans        = 10.0f;
+        const float lpf_cut          = config.processing.lowPassCutoff;
+        const float lpf_trans        = config.processing.lowPassTransition;
+        const auto  lpf_window       = windowType(config.processing.lowPassWindow);
         // parameters frequency spectra
-        const int fft_size_ppem        = 512;
-        size_t    fft_vector_size_ppem = static_cast<size_t>(fft_size_ppem);
-        const int fft_size_nilm        = 131072;
-        size_t    fft_vector_size_nilm = static_cast<size_t>(fft_size_nilm);
-        float     bandwidth_nilm       = source_samp_rate;
+        const int   fft_size_ppem        = config.spectra.ppemFftSize;
+        size_t      fft_vector_size_ppem = static_cast<size_t>(fft_size_ppem);
+        const float samp_rate_ppem_pre   = source_samp_rate / static_cast<float>(config.spectra.ppemPreDecimation);
+        const float samp_rate_ppem       = config.spectra.ppemSampleRate;
+        const int   fft_size_nilm        = config.spectra.nilmFftSize;
+        size_t      fft_vector_size_nilm = static_cast<size_t>(fft_size_nilm);
+        float       bandwidth_nilm       = source_samp_rate;
+        const auto  fft_window_nilm      = gr::fft::window::build(windowType(config.spectra.nilmWindow), fft_size_nilm);
+        const auto  fft_window_ppem      = gr::fft::window::build(windowType(config.spectra.ppemWindow), fft_size_ppem);
 
         // blocks
         auto stream_to_vector_U       = gr::blocks::stream_to_vector::make(sizeof(float) * 1, fft_vector_size_nilm);
-        auto fft_U                    = gr::fft::fft_v<float, true>::make(fft_size_nilm, gr::fft::window::blackmanharris(fft_size_nilm), false, 1);
+        auto fft_U                    = gr::fft::fft_v<float, true>::make(fft_size_nilm, fft_window_nilm, false, 1);
         auto complex_to_mag_U         = gr::blocks::complex_to_mag_squared::make(fft_vector_size_nilm);
 
         auto stream_to_vector_I       = gr::blocks::stream_to_vector::make(sizeof(float) * 1, fft_vector_size_nilm);
-        auto fft_I                    = gr::fft::fft_v<float, true>::make(fft_size_nilm, gr::fft::window::blackmanharris(fft_size_nilm), false, 1);
+        auto fft_I                    = gr::fft::fft_v<float, true>::make(fft_size_nilm, fft_window_nilm, false, 1);
         auto complex_to_mag_I         = gr::blocks::complex_to_mag_squared::make(fft_vector_size_nilm);
 
         auto stream_to_vector_S       = gr::blocks::stream_to_vector::make(sizeof(float) * 1, fft_vector_size_nilm);
-        auto fft_S                    = gr::fft::fft_v<float, true>::make(fft_size_nilm, gr::fft::window::blackmanharris(fft_size_nilm), false, 1);
+        auto fft_S                    = gr::fft::fft_v<float, true>::make(fft_size_nilm, fft_window_nilm, false, 1);
         auto complex_to_mag_S         = gr::blocks::complex_to_mag_squared::make(fft_vector_size_nilm);
 
         auto multiply_voltage_current = gr::blocks::multiply_ff::make(1);
-        auto frequency_spec_one_in_n  = gr::blocks::keep_one_in_n::make(sizeof(float), 4000);
+        auto frequency_spec_one_in_n  = gr::blocks::keep_one_in_n::make(sizeof(float), config.spectra.ppemPreDecimation);
         auto frequency_spec_low_pass  = gr::filter::fft_filter_fff::make(
-                 10,
+                 decimation(samp_rate_ppem_pre, samp_rate_ppem),
                  gr::filter::firdes::low_pass(
                          1,
-                         500,
-                         20,
-                         100,
+                         samp_rate_ppem_pre,
+                         config.spectra.ppemLowPassCutoff,
+                         config.spectra.ppemLowPassTransition,
                          gr::fft::window::win_type::WIN_HAMMING,
                          6.76));
         auto frequency_spec_stream_to_vec  = gr::blocks::stream_to_vector::make(sizeof(float), fft_size_ppem);
-        auto frequency_spec_fft            = gr::fft::fft_v<float, true>::make(fft_size_ppem, gr::fft::window::rectangular(fft_size_ppem), true, 1);
+        auto frequency_spec_fft            = gr::fft::fft_v<float, true>::make(fft_size_ppem, fft_window_ppem, true, 1);
         auto frequency_multiply_const      = gr::blocks::multiply_const<gr_complex>::make(2.0 / static_cast<double>(fft_size_ppem), fft_vector_size_ppem);
         auto frequency_spec_complex_to_mag = gr::blocks::complex_to_mag::make(fft_vector_size_ppem);
 
-        auto calc_mains_frequency          = gr::pulsed_power::mains_frequency_calc::make(source_samp_rate, -100.0f, 100.0f);
+        auto calc_mains_frequency          = gr::pulsed_power::mains_frequency_calc::make(source_samp_rate, config.processing.mainsFrequencyLow, config.processing.mainsFrequencyHigh);
 
-        auto integrate_S_day               = gr::pulsed_power::integration::make(1000, 1000, gr::pulsed_power::INTEGRATION_DURATION::DAY, "SDay.txt");
-        auto integrate_S_week              = gr::pulsed_power::integration::make(1000, 1000, gr::pulsed_power::INTEGRATION_DURATION::WEEK, "SWeek.txt");
-        auto integrate_S_month             = gr::pulsed_power::integration::make(1000, 1000, gr::pulsed_power::INTEGRATION_DURATION::MONTH, "SMonth.txt");
-        auto integrate_P_day               = gr::pulsed_power::integration::make(1000, 1000, gr::pulsed_power::INTEGRATION_DURATION::DAY, "PDay.txt");
-        auto integrate_P_week              = gr::pulsed_power::integration::make(1000, 1000, gr::pulsed_power::INTEGRATION_DURATION::WEEK, "PWeek.txt");
-        auto integrate_P_month             = gr::pulsed_power::integration::make(1000, 1000, gr::pulsed_power::INTEGRATION_DURATION::MONTH, "PMonth.txt");
+        auto integrate_S_day               = gr::pulsed_power::integration::make(decimation_integrals, static_cast<int>(samp_rate_delta_phi_calc), gr::pulsed_power::INTEGRATION_DURATION::DAY, integral_file("SDay.txt"));
+        auto integrate_S_week              = gr::pulsed_power::integration::make(decimation_integrals, static_cast<int>(samp_rate_delta_phi_calc), gr::pulsed_power::INTEGRATION_DURATION::WEEK, integral_file("SWeek.txt"));
+        auto integrate_S_month             = gr::pulsed_power::integration::make(decimation_integrals, static_cast<int>(samp_rate_delta_phi_calc), gr::pulsed_power::INTEGRATION_DURATION::MONTH, integral_file("SMonth.txt"));
+        auto integrate_P_day               = gr::pulsed_power::integration::make(decimation_integrals, static_cast<int>(samp_rate_delta_phi_calc), gr::pulsed_power::INTEGRATION_DURATION::DAY, integral_file("PDay.txt"));
+        auto integrate_P_week              = gr::pulsed_power::integration::make(decimation_integrals, static_cast<int>(samp_rate_delta_phi_calc), gr::pulsed_power::INTEGRATION_DURATION::WEEK, integral_file("PWeek.txt"));
+        auto integrate_P_month             = gr::pulsed_power::integration::make(decimation_integrals, static_cast<int>(samp_rate_delta_phi_calc), gr::pulsed_power::INTEGRATION_DURATION::MONTH, integral_file("PMonth.txt"));
 
         auto band_pass_filter_current0     = gr::filter::fft_filter_fff::make(
                     decimation_bpf,
@@ -312,7 +794,7 @@ public:
                             bpf_low_cut,
                             bpf_high_cut,
                             bpf_trans,
-                            gr::fft::window::win_type::WIN_HANN,
+                            bpf_window,
                             6.76));
         auto band_pass_filter_voltage0 = gr::filter::fft_filter_fff::make(
                 decimation_bpf,
@@ -322,11 +804,11 @@ public:
                         bpf_low_cut,
                         bpf_high_cut,
                         bpf_trans,
-                        gr::fft::window::win_type::WIN_HANN,
+                        bpf_window,
                         6.76));
 
-        auto analog_sig_source_phase0_sin = gr::analog::sig_source_f::make(samp_rate_delta_phi_calc, gr::analog::GR_SIN_WAVE, 55, 1, 0, 0.0f);
-        auto analog_sig_source_phase0_cos = gr::analog::sig_source_f::make(samp_rate_delta_phi_calc, gr::analog::GR_COS_WAVE, 55, 1, 0, 0.0f);
+        auto analog_sig_source_phase0_sin = gr::analog::sig_source_f::make(samp_rate_delta_phi_calc, gr::analog::GR_SIN_WAVE, config.processing.phaseReference, 1, 0, 0.0f);
+        auto analog_sig_source_phase0_cos = gr::analog::sig_source_f::make(samp_rate_delta_phi_calc, gr::analog::GR_COS_WAVE, config.processing.phaseReference, 1, 0, 0.0f);
 
         auto blocks_multiply_phase0_0     = gr::blocks::multiply_ff::make(1);
         auto blocks_multiply_phase0_1     = gr::blocks::multiply_ff::make(1);
@@ -338,36 +820,36 @@ public:
                   gr::filter::firdes::low_pass(
                           1,
                           lpf_in_samp_rate,
-                          60,
+                          lpf_cut,
                           lpf_trans,
-                          gr::fft::window::win_type::WIN_HAMMING,
+                          lpf_window,
                           6.76));
         auto low_pass_filter_current0_1 = gr::filter::fft_filter_fff::make(
                 decimation_lpf,
                 gr::filter::firdes::low_pass(
                         1,
                         lpf_in_samp_rate,
-                        60,
+                        lpf_cut,
                         lpf_trans,
-                        gr::fft::window::win_type::WIN_HAMMING,
+                        lpf_window,
                         6.76));
         auto low_pass_filter_voltage0_0 = gr::filter::fft_filter_fff::make(
                 decimation_lpf,
                 gr::filter::firdes::low_pass(
                         1,
                         lpf_in_samp_rate,
-                        60,
+                        lpf_cut,
                         lpf_trans,
-                        gr::fft::window::win_type::WIN_HAMMING,
+                        lpf_window,
                         6.76));
         auto low_pass_filter_voltage0_1 = gr::filter::fft_filter_fff::make(
                 decimation_lpf,
                 gr::filter::firdes::low_pass(
                         1,
                         lpf_in_samp_rate,
-                        60,
+                        lpf_cut,
                         lpf_trans,
-                        gr::fft::window::win_type::WIN_HAMMING,
+                        lpf_window,
                         6.76));
 
         auto blocks_divide_phase0_0                   = gr::blocks::divide_ff::make(1);
@@ -378,7 +860,7 @@ public:
 
         auto blocks_sub_phase0                        = gr::blocks::sub_ff::make(1);
 
-        auto pulsed_power_power_calc_ff_0_0           = gr::pulsed_power::power_calc_ff::make(0.001);
+        auto pulsed_power_power_calc_ff_0_0           = gr::pulsed_power::power_calc_ff::make(config.processing.powerCalcAlpha);
 
         auto out_decimation_current0                  = gr::blocks::keep_one_in_n::make(sizeof(float), decimation_out_raw);
         auto out_decimation_voltage0                  = gr::blocks::keep_one_in_n::make(sizeof(float), decimation_out_raw);
@@ -418,75 +900,75 @@ public:
         auto statistics_s_longterm                    = gr::pulsed_power::statistics::make(decimation_out_long_term);
         auto statistics_phi_longterm                  = gr::pulsed_power::statistics::make(decimation_out_long_term);
 
-        auto opencmw_time_sink_signals                = gr::pulsed_power::opencmw_time_sink::make(
+        auto opencmw_time_sink_signals                = make_time_sink(
                                { "U", "I", "U_bpf", "I_bpf" },
                                { "V", "A", "V", "A" },
                                out_samp_rate_ui);
         opencmw_time_sink_signals->set_max_noutput_items(noutput_items);
 
         // Mains frequency sinks
-        auto opencmw_time_sink_mains_freq_shortterm = gr::pulsed_power::opencmw_time_sink::make(
+        auto opencmw_time_sink_mains_freq_shortterm = make_time_sink(
                 { "mains_freq" },
                 { "Hz" },
                 out_samp_rate_power_shortterm);
         opencmw_time_sink_mains_freq_shortterm->set_max_noutput_items(noutput_items);
-        auto opencmw_time_sink_mains_freq_midterm = gr::pulsed_power::opencmw_time_sink::make(
+        auto opencmw_time_sink_mains_freq_midterm = make_time_sink(
                 { "mains_freq" },
                 { "Hz" },
                 out_samp_rate_power_midterm);
         opencmw_time_sink_mains_freq_midterm->set_max_noutput_items(noutput_items);
-        auto opencmw_time_sink_mains_freq_longterm = gr::pulsed_power::opencmw_time_sink::make(
+        auto opencmw_time_sink_mains_freq_longterm = make_time_sink(
                 { "mains_freq" },
                 { "Hz" },
                 out_samp_rate_power_longterm);
         opencmw_time_sink_mains_freq_longterm->set_max_noutput_items(noutput_items);
 
         // Power sinks
-        auto opencmw_time_sink_power_shortterm = gr::pulsed_power::opencmw_time_sink::make(
+        auto opencmw_time_sink_power_shortterm = make_time_sink(
                 { "P", "Q", "S", "phi" },
                 { "W", "Var", "VA", "rad" },
                 out_samp_rate_power_shortterm);
         opencmw_time_sink_power_shortterm->set_max_noutput_items(noutput_items);
-        auto opencmw_time_sink_power_midterm = gr::pulsed_power::opencmw_time_sink::make(
+        auto opencmw_time_sink_power_midterm = make_time_sink(
                 { "P", "Q", "S", "phi" },
                 { "W", "Var", "VA", "rad" },
                 out_samp_rate_power_midterm);
         opencmw_time_sink_power_midterm->set_max_noutput_items(noutput_items);
-        auto opencmw_time_sink_power_longterm = gr::pulsed_power::opencmw_time_sink::make(
+        auto opencmw_time_sink_power_longterm = make_time_sink(
                 { "P", "Q", "S", "phi" },
                 { "W", "Var", "VA", "rad" },
                 out_samp_rate_power_longterm);
         opencmw_time_sink_power_longterm->set_max_noutput_items(noutput_items);
 
         // Integral sinks
-        auto opencmw_time_sink_int_day = gr::pulsed_power::opencmw_time_sink::make(
+        auto opencmw_time_sink_int_day = make_time_sink(
                 { "P_Int_Day", "S_Int_Day" },
                 { "Wh", "VAh" },
-                1.0f);
+                out_samp_rate_integrals);
         opencmw_time_sink_int_day->set_max_noutput_items(noutput_items);
-        auto opencmw_time_sink_int_week = gr::pulsed_power::opencmw_time_sink::make(
+        auto opencmw_time_sink_int_week = make_time_sink(
                 { "P_Int_Week", "S_Int_Week" },
                 { "Wh", "VAh" },
-                1.0f);
+                out_samp_rate_integrals);
         opencmw_time_sink_int_week->set_max_noutput_items(noutput_items);
-        auto opencmw_time_sink_int_month = gr::pulsed_power::opencmw_time_sink::make(
+        auto opencmw_time_sink_int_month = make_time_sink(
                 { "P_Int_Month", "S_Int_Month" },
                 { "Wh", "VAh" },
-                1.0f);
+                out_samp_rate_integrals);
         opencmw_time_sink_int_month->set_max_noutput_items(noutput_items);
 
         // Statistic sinks
-        auto opencmw_time_sink_power_stats_shortterm = gr::pulsed_power::opencmw_time_sink::make(
+        auto opencmw_time_sink_power_stats_shortterm = make_time_sink(
                 { "P_mean", "P_min", "P_max", "Q_mean", "Q_min", "Q_max", "S_mean", "S_min", "S_max", "phi_mean", "phi_min", "phi_max" },
                 { "W", "W", "W", "Var", "Var", "Var", "VA", "VA", "VA", "rad", "rad", "rad" },
                 out_samp_rate_power_shortterm);
         opencmw_time_sink_power_stats_shortterm->set_max_noutput_items(noutput_items);
-        auto opencmw_time_sink_power_stats_midterm = gr::pulsed_power::opencmw_time_sink::make(
+        auto opencmw_time_sink_power_stats_midterm = make_time_sink(
                 { "P_mean", "P_min", "P_max", "Q_mean", "Q_min", "Q_max", "S_mean", "S_min", "S_max", "phi_mean", "phi_min", "phi_max" },
                 { "W", "W", "W", "Var", "Var", "Var", "VA", "VA", "VA", "rad", "rad", "rad" },
                 out_samp_rate_power_midterm);
         opencmw_time_sink_power_stats_midterm->set_max_noutput_items(noutput_items);
-        auto opencmw_time_sink_power_stats_longterm = gr::pulsed_power::opencmw_time_sink::make(
+        auto opencmw_time_sink_power_stats_longterm = make_time_sink(
                 { "P_mean", "P_min", "P_max", "Q_mean", "Q_min", "Q_max", "S_mean", "S_min", "S_max", "phi_mean", "phi_min", "phi_max" },
                 { "W", "W", "W", "Var", "Var", "Var", "VA", "VA", "VA", "rad", "rad", "rad" },
                 out_samp_rate_power_longterm);
@@ -497,203 +979,200 @@ public:
         auto null_sink_stats_longterm  = gr::blocks::null_sink::make(sizeof(float));
 
         // Frequency spectra sinks
-        auto frequency_spec_pulsed_power_opencmw_freq_sink = gr::pulsed_power::opencmw_freq_sink::make(
+        auto frequency_spec_pulsed_power_opencmw_freq_sink = make_freq_sink(
                 { "sinus_fft" },
-                { "W" }, 50, 50, 512);
-        frequency_spec_pulsed_power_opencmw_freq_sink->set_max_noutput_items(1);
-        auto opencmw_freq_sink_nilm_U = gr::pulsed_power::opencmw_freq_sink::make(
+                { "W" }, samp_rate_ppem, samp_rate_ppem, fft_vector_size_ppem);
+        frequency_spec_pulsed_power_opencmw_freq_sink->set_max_noutput_items(noutput_items_spectra);
+        auto opencmw_freq_sink_nilm_U = make_freq_sink(
                 { "VoltageSpectrumNilm" },
                 { "V" },
                 source_samp_rate,
                 bandwidth_nilm,
                 fft_vector_size_nilm);
-        opencmw_freq_sink_nilm_U->set_max_noutput_items(1);
-        auto opencmw_freq_sink_nilm_I = gr::pulsed_power::opencmw_freq_sink::make(
+        opencmw_freq_sink_nilm_U->set_max_noutput_items(noutput_items_spectra);
+        auto opencmw_freq_sink_nilm_I = make_freq_sink(
                 { "CurrentSpectrumNilm" },
                 { "A" },
                 source_samp_rate,
                 bandwidth_nilm,
                 fft_vector_size_nilm);
-        opencmw_freq_sink_nilm_I->set_max_noutput_items(1);
-        auto opencmw_freq_sink_nilm_S = gr::pulsed_power::opencmw_freq_sink::make(
+        opencmw_freq_sink_nilm_I->set_max_noutput_items(noutput_items_spectra);
+        auto opencmw_freq_sink_nilm_S = make_freq_sink(
                 { "ApparentPowerSpectrumNilm" },
                 { "VA" },
                 source_samp_rate,
                 bandwidth_nilm,
                 fft_vector_size_nilm);
-        opencmw_freq_sink_nilm_S->set_max_noutput_items(1);
+        opencmw_freq_sink_nilm_S->set_max_noutput_items(noutput_items_spectra);
 
         // Connections:
         // signal
-        top->hier_block2::connect(source_interface_voltage0, 0, out_decimation_voltage0, 0);
-        top->hier_block2::connect(source_interface_current0, 0, out_decimation_current0, 0);
-        top->hier_block2::connect(out_decimation_voltage0, 0, opencmw_time_sink_signals, 0); // U_raw
-        top->hier_block2::connect(out_decimation_current0, 0, opencmw_time_sink_signals, 1); // I_raw
+        connect(source_interface_voltage0, 0, out_decimation_voltage0, 0);
+        connect(source_interface_current0, 0, out_decimation_current0, 0);
+        connect(out_decimation_voltage0, 0, opencmw_time_sink_signals, 0); // U_raw
+        connect(out_decimation_current0, 0, opencmw_time_sink_signals, 1); // I_raw
         // Mains frequency
-        top->hier_block2::connect(source_interface_voltage0, 0, calc_mains_frequency, 0);
-        top->hier_block2::connect(calc_mains_frequency, 0, out_decimation_mains_frequency_shortterm, 0);
-        top->hier_block2::connect(out_decimation_mains_frequency_shortterm, 0, opencmw_time_sink_mains_freq_shortterm, 0); // mains_freq short-term
-        top->hier_block2::connect(calc_mains_frequency, 0, out_decimation_mains_frequency_midterm, 0);
-        top->hier_block2::connect(out_decimation_mains_frequency_midterm, 0, opencmw_time_sink_mains_freq_midterm, 0); // mains_freq mid-term
-        top->hier_block2::connect(calc_mains_frequency, 0, out_decimation_mains_frequency_longterm, 0);
-        top->hier_block2::connect(out_decimation_mains_frequency_longterm, 0, opencmw_time_sink_mains_freq_longterm, 0); // mains_freq long-term
+        connect(source_interface_voltage0, 0, calc_mains_frequency, 0);
+        connect(calc_mains_frequency, 0, out_decimation_mains_frequency_shortterm, 0);
+        connect(out_decimation_mains_frequency_shortterm, 0, opencmw_time_sink_mains_freq_shortterm, 0); // mains_freq short-term
+        connect(calc_mains_frequency, 0, out_decimation_mains_frequency_midterm, 0);
+        connect(out_decimation_mains_frequency_midterm, 0, opencmw_time_sink_mains_freq_midterm, 0); // mains_freq mid-term
+        connect(calc_mains_frequency, 0, out_decimation_mains_frequency_longterm, 0);
+        connect(out_decimation_mains_frequency_longterm, 0, opencmw_time_sink_mains_freq_longterm, 0); // mains_freq long-term
         // Bandpass filter
-        top->hier_block2::connect(source_interface_voltage0, 0, band_pass_filter_voltage0, 0);
-        top->hier_block2::connect(source_interface_current0, 0, band_pass_filter_current0, 0);
-        top->hier_block2::connect(band_pass_filter_voltage0, 0, opencmw_time_sink_signals, 2); // U_bpf
-        top->hier_block2::connect(band_pass_filter_current0, 0, opencmw_time_sink_signals, 3); // I_bpf
+        connect(source_interface_voltage0, 0, band_pass_filter_voltage0, 0);
+        connect(source_interface_current0, 0, band_pass_filter_current0, 0);
+        connect(band_pass_filter_voltage0, 0, opencmw_time_sink_signals, 2); // U_bpf
+        connect(band_pass_filter_current0, 0, opencmw_time_sink_signals, 3); // I_bpf
         //  Calculate phase shift
-        top->hier_block2::connect(band_pass_filter_voltage0, 0, decimation_block_voltage_bpf0, 0);
-        top->hier_block2::connect(band_pass_filter_current0, 0, decimation_block_current_bpf0, 0);
-
-        top->hier_block2::connect(decimation_block_voltage_bpf0, 0, blocks_multiply_phase0_0, 0);
-        top->hier_block2::connect(decimation_block_voltage_bpf0, 0, blocks_multiply_phase0_1, 0);
-        top->hier_block2::connect(decimation_block_current_bpf0, 0, blocks_multiply_phase0_2, 0);
-        top->hier_block2::connect(decimation_block_current_bpf0, 0, blocks_multiply_phase0_3, 0);
-        top->hier_block2::connect(decimation_block_voltage_bpf0, 0, pulsed_power_power_calc_ff_0_0, 0);
-        top->hier_block2::connect(decimation_block_current_bpf0, 0, pulsed_power_power_calc_ff_0_0, 1);
-        top->hier_block2::connect(analog_sig_source_phase0_sin, 0, blocks_multiply_phase0_0, 1);
-        top->hier_block2::connect(analog_sig_source_phase0_sin, 0, blocks_multiply_phase0_2, 1);
-        top->hier_block2::connect(analog_sig_source_phase0_cos, 0, blocks_multiply_phase0_1, 1);
-        top->hier_block2::connect(analog_sig_source_phase0_cos, 0, blocks_multiply_phase0_3, 1);
-        top->hier_block2::connect(blocks_multiply_phase0_0, 0, low_pass_filter_voltage0_0, 0);
-        top->hier_block2::connect(blocks_multiply_phase0_1, 0, low_pass_filter_voltage0_1, 0);
-        top->hier_block2::connect(blocks_multiply_phase0_2, 0, low_pass_filter_current0_0, 0);
-        top->hier_block2::connect(blocks_multiply_phase0_3, 0, low_pass_filter_current0_1, 0);
-        top->hier_block2::connect(low_pass_filter_voltage0_0, 0, blocks_divide_phase0_0, 0);
-        top->hier_block2::connect(low_pass_filter_voltage0_1, 0, blocks_divide_phase0_0, 1);
-        top->hier_block2::connect(low_pass_filter_current0_0, 0, blocks_divide_phase0_1, 0);
-        top->hier_block2::connect(low_pass_filter_current0_1, 0, blocks_divide_phase0_1, 1);
-        top->hier_block2::connect(blocks_divide_phase0_0, 0, blocks_transcendental_phase0_0, 0);
-        top->hier_block2::connect(blocks_divide_phase0_1, 0, blocks_transcendental_phase0_1, 0);
-        top->hier_block2::connect(blocks_transcendental_phase0_0, 0, blocks_sub_phase0, 0);
-        top->hier_block2::connect(blocks_transcendental_phase0_1, 0, blocks_sub_phase0, 1);
-        top->hier_block2::connect(blocks_sub_phase0, 0, pulsed_power_power_calc_ff_0_0, 2);
+        connect(band_pass_filter_voltage0, 0, decimation_block_voltage_bpf0, 0);
+        connect(band_pass_filter_current0, 0, decimation_block_current_bpf0, 0);
+
+        connect(decimation_block_voltage_bpf0, 0, blocks_multiply_phase0_0, 0);
+        connect(decimation_block_voltage_bpf0, 0, blocks_multiply_phase0_1, 0);
+        connect(decimation_block_current_bpf0, 0, blocks_multiply_phase0_2, 0);
+        connect(decimation_block_current_bpf0, 0, blocks_multiply_phase0_3, 0);
+        connect(decimation_block_voltage_bpf0, 0, pulsed_power_power_calc_ff_0_0, 0);
+        connect(decimation_block_current_bpf0, 0, pulsed_power_power_calc_ff_0_0, 1);
+        connect(analog_sig_source_phase0_sin, 0, blocks_multiply_phase0_0, 1);
+        connect(analog_sig_source_phase0_sin, 0, blocks_multiply_phase0_2, 1);
+        connect(analog_sig_source_phase0_cos, 0, blocks_multiply_phase0_1, 1);
+        connect(analog_sig_source_phase0_cos, 0, blocks_multiply_phase0_3, 1);
+        connect(blocks_multiply_phase0_0, 0, low_pass_filter_voltage0_0, 0);
+        connect(blocks_multiply_phase0_1, 0, low_pass_filter_voltage0_1, 0);
+        connect(blocks_multiply_phase0_2, 0, low_pass_filter_current0_0, 0);
+        connect(blocks_multiply_phase0_3, 0, low_pass_filter_current0_1, 0);
+        connect(low_pass_filter_voltage0_0, 0, blocks_divide_phase0_0, 0);
+        connect(low_pass_filter_voltage0_1, 0, blocks_divide_phase0_0, 1);
+        connect(low_pass_filter_current0_0, 0, blocks_divide_phase0_1, 0);
+        connect(low_pass_filter_current0_1, 0, blocks_divide_phase0_1, 1);
+        connect(blocks_divide_phase0_0, 0, blocks_transcendental_phase0_0, 0);
+        connect(blocks_divide_phase0_1, 0, blocks_transcendental_phase0_1, 0);
+        connect(blocks_transcendental_phase0_0, 0, blocks_sub_phase0, 0);
+        connect(blocks_transcendental_phase0_1, 0, blocks_sub_phase0, 1);
+        connect(blocks_sub_phase0, 0, pulsed_power_power_calc_ff_0_0, 2);
         // Calculate P, Q, S, phi
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 0, out_decimation_p_shortterm, 0);
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 1, out_decimation_q_shortterm, 0);
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 2, out_decimation_s_shortterm, 0);
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 3, out_decimation_phi_shortterm, 0);
-        top->hier_block2::connect(out_decimation_p_shortterm, 0, opencmw_time_sink_power_shortterm, 0);   // P short-term
-        top->hier_block2::connect(out_decimation_q_shortterm, 0, opencmw_time_sink_power_shortterm, 1);   // Q short-term
-        top->hier_block2::connect(out_decimation_s_shortterm, 0, opencmw_time_sink_power_shortterm, 2);   // S short-term
-        top->hier_block2::connect(out_decimation_phi_shortterm, 0, opencmw_time_sink_power_shortterm, 3); // phi short-term
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 0, out_decimation_p_midterm, 0);
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 1, out_decimation_q_midterm, 0);
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 2, out_decimation_s_midterm, 0);
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 3, out_decimation_phi_midterm, 0);
-        top->hier_block2::connect(out_decimation_p_midterm, 0, opencmw_time_sink_power_midterm, 0);   // P mid-term
-        top->hier_block2::connect(out_decimation_q_midterm, 0, opencmw_time_sink_power_midterm, 1);   // Q mid-term
-        top->hier_block2::connect(out_decimation_s_midterm, 0, opencmw_time_sink_power_midterm, 2);   // S mid-term
-        top->hier_block2::connect(out_decimation_phi_midterm, 0, opencmw_time_sink_power_midterm, 3); // phi mid-term
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 0, out_decimation_p_longterm, 0);
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 1, out_decimation_q_longterm, 0);
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 2, out_decimation_s_longterm, 0);
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 3, out_decimation_phi_longterm, 0);
-        top->hier_block2::connect(out_decimation_p_longterm, 0, opencmw_time_sink_power_longterm, 0);   // P long-term
-        top->hier_block2::connect(out_decimation_q_longterm, 0, opencmw_time_sink_power_longterm, 1);   // Q long-term
-        top->hier_block2::connect(out_decimation_s_longterm, 0, opencmw_time_sink_power_longterm, 2);   // S long-term
-        top->hier_block2::connect(out_decimation_phi_longterm, 0, opencmw_time_sink_power_longterm, 3); // phi long-term
+        connect(pulsed_power_power_calc_ff_0_0, 0, out_decimation_p_shortterm, 0);
+        connect(pulsed_power_power_calc_ff_0_0, 1, out_decimation_q_shortterm, 0);
+        connect(pulsed_power_power_calc_ff_0_0, 2, out_decimation_s_shortterm, 0);
+        connect(pulsed_power_power_calc_ff_0_0, 3, out_decimation_phi_shortterm, 0);
+        connect(out_decimation_p_shortterm, 0, opencmw_time_sink_power_shortterm, 0);   // P short-term
+        connect(out_decimation_q_shortterm, 0, opencmw_time_sink_power_shortterm, 1);   // Q short-term
+        connect(out_decimation_s_shortterm, 0, opencmw_time_sink_power_shortterm, 2);   // S short-term
+        connect(out_decimation_phi_shortterm, 0, opencmw_time_sink_power_shortterm, 3); // phi short-term
+        connect(pulsed_power_power_calc_ff_0_0, 0, out_decimation_p_midterm, 0);
+        connect(pulsed_power_power_calc_ff_0_0, 1, out_decimation_q_midterm, 0);
+        connect(pulsed_power_power_calc_ff_0_0, 2, out_decimation_s_midterm, 0);
+        connect(pulsed_power_power_calc_ff_0_0, 3, out_decimation_phi_midterm, 0);
+        connect(out_decimation_p_midterm, 0, opencmw_time_sink_power_midterm, 0);   // P mid-term
+        connect(out_decimation_q_midterm, 0, opencmw_time_sink_power_midterm, 1);   // Q mid-term
+        connect(out_decimation_s_midterm, 0, opencmw_time_sink_power_midterm, 2);   // S mid-term
+        connect(out_decimation_phi_midterm, 0, opencmw_time_sink_power_midterm, 3); // phi mid-term
+        connect(pulsed_power_power_calc_ff_0_0, 0, out_decimation_p_longterm, 0);
+        connect(pulsed_power_power_calc_ff_0_0, 1, out_decimation_q_longterm, 0);
+        connect(pulsed_power_power_calc_ff_0_0, 2, out_decimation_s_longterm, 0);
+        connect(pulsed_power_power_calc_ff_0_0, 3, out_decimation_phi_longterm, 0);
+        connect(out_decimation_p_longterm, 0, opencmw_time_sink_power_longterm, 0);   // P long-term
+        connect(out_decimation_q_longterm, 0, opencmw_time_sink_power_longterm, 1);   // Q long-term
+        connect(out_decimation_s_longterm, 0, opencmw_time_sink_power_longterm, 2);   // S long-term
+        connect(out_decimation_phi_longterm, 0, opencmw_time_sink_power_longterm, 3); // phi long-term
         // Integrals
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 0, integrate_P_day, 0);
-        top->hier_block2::connect(integrate_P_day, 0, opencmw_time_sink_int_day, 0); // int P day
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 2, integrate_S_day, 0);
-        top->hier_block2::connect(integrate_S_day, 0, opencmw_time_sink_int_day, 1); // int S day
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 0, integrate_P_week, 0);
-        top->hier_block2::connect(integrate_P_week, 0, opencmw_time_sink_int_week, 0); // int P week
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 2, integrate_S_week, 0);
-        top->hier_block2::connect(integrate_S_week, 0, opencmw_time_sink_int_week, 1); // int S week
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 0, integrate_P_month, 0);
-        top->hier_block2::connect(integrate_P_month, 0, opencmw_time_sink_int_month, 0); // int P month
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 2, integrate_S_month, 0);
-        top->hier_block2::connect(integrate_S_month, 0, opencmw_time_sink_int_month, 1); // int S month
+        connect(pulsed_power_power_calc_ff_0_0, 0, integrate_P_day, 0);
+        connect(integrate_P_day, 0, opencmw_time_sink_int_day, 0); // int P day
+        connect(pulsed_power_power_calc_ff_0_0, 2, integrate_S_day, 0);
+        connect(integrate_S_day, 0, opencmw_time_sink_int_day, 1); // int S day
+        connect(pulsed_power_power_calc_ff_0_0, 0, integrate_P_week, 0);
+        connect(integrate_P_week, 0, opencmw_time_sink_int_week, 0); // int P week
+        connect(pulsed_power_power_calc_ff_0_0, 2, integrate_S_week, 0);
+        connect(integrate_S_week, 0, opencmw_time_sink_int_week, 1); // int S week
+        connect(pulsed_power_power_calc_ff_0_0, 0, integrate_P_month, 0);
+        connect(integrate_P_month, 0, opencmw_time_sink_int_month, 0); // int P month
+        connect(pulsed_power_power_calc_ff_0_0, 2, integrate_S_month, 0);
+        connect(integrate_S_month, 0, opencmw_time_sink_int_month, 1); // int S month
         // Statistics
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 0, statistics_p_shortterm, 0);
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 1, statistics_q_shortterm, 0);
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 2, statistics_s_shortterm, 0);
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 3, statistics_phi_shortterm, 0);
-        top->hier_block2::connect(statistics_p_shortterm, 0, opencmw_time_sink_power_stats_shortterm, 0);    // P_mean short-term
-        top->hier_block2::connect(statistics_p_shortterm, 1, opencmw_time_sink_power_stats_shortterm, 1);    // P_min short-term
-        top->hier_block2::connect(statistics_p_shortterm, 2, opencmw_time_sink_power_stats_shortterm, 2);    // P_max short-term
-        top->hier_block2::connect(statistics_p_shortterm, 3, null_sink_stats_shortterm, 0);                  // P_std_dev short-term
-        top->hier_block2::connect(statistics_q_shortterm, 0, opencmw_time_sink_power_stats_shortterm, 3);    // Q_mean short-term
-        top->hier_block2::connect(statistics_q_shortterm, 1, opencmw_time_sink_power_stats_shortterm, 4);    // Q_min short-term
-        top->hier_block2::connect(statistics_q_shortterm, 2, opencmw_time_sink_power_stats_shortterm, 5);    // Q_max short-term
-        top->hier_block2::connect(statistics_q_shortterm, 3, null_sink_stats_shortterm, 1);                  // Q_std_dev short-term
-        top->hier_block2::connect(statistics_s_shortterm, 0, opencmw_time_sink_power_stats_shortterm, 6);    // S_mean short-term
-        top->hier_block2::connect(statistics_s_shortterm, 1, opencmw_time_sink_power_stats_shortterm, 7);    // S_min short-term
-        top->hier_block2::connect(statistics_s_shortterm, 2, opencmw_time_sink_power_stats_shortterm, 8);    // S_max short-term
-        top->hier_block2::connect(statistics_s_shortterm, 3, null_sink_stats_shortterm, 2);                  // S_std_dev short-term
-        top->hier_block2::connect(statistics_phi_shortterm, 0, opencmw_time_sink_power_stats_shortterm, 9);  // phi_mean short-term
-        top->hier_block2::connect(statistics_phi_shortterm, 1, opencmw_time_sink_power_stats_shortterm, 10); // phi_min short-term
-        top->hier_block2::connect(statistics_phi_shortterm, 2, opencmw_time_sink_power_stats_shortterm, 11); // phi_max short-term
-        top->hier_block2::connect(statistics_phi_shortterm, 3, null_sink_stats_shortterm, 3);                // phi_std_dev short-term
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 0, statistics_p_midterm, 0);
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 1, statistics_q_midterm, 0);
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 2, statistics_s_midterm, 0);
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 3, statistics_phi_midterm, 0);
-        top->hier_block2::connect(statistics_p_midterm, 0, opencmw_time_sink_power_stats_midterm, 0);    // P_mean mid-term
-        top->hier_block2::connect(statistics_p_midterm, 1, opencmw_time_sink_power_stats_midterm, 1);    // P_min mid-term
-        top->hier_block2::connect(statistics_p_midterm, 2, opencmw_time_sink_power_stats_midterm, 2);    // P_max mid-term
-        top->hier_block2::connect(statistics_p_midterm, 3, null_sink_stats_midterm, 0);                  // P_std_dev mid-term
-        top->hier_block2::connect(statistics_q_midterm, 0, opencmw_time_sink_power_stats_midterm, 3);    // Q_mean mid-term
-        top->hier_block2::connect(statistics_q_midterm, 1, opencmw_time_sink_power_stats_midterm, 4);    // Q_min mid-term
-        top->hier_block2::connect(statistics_q_midterm, 2, opencmw_time_sink_power_stats_midterm, 5);    // Q_max mid-term
-        top->hier_block2::connect(statistics_q_midterm, 3, null_sink_stats_midterm, 1);                  // Q_std_dev mid-term
-        top->hier_block2::connect(statistics_s_midterm, 0, opencmw_time_sink_power_stats_midterm, 6);    // S_mean mid-term
-        top->hier_block2::connect(statistics_s_midterm, 1, opencmw_time_sink_power_stats_midterm, 7);    // S_min mid-term
-        top->hier_block2::connect(statistics_s_midterm, 2, opencmw_time_sink_power_stats_midterm, 8);    // S_max mid-term
-        top->hier_block2::connect(statistics_s_midterm, 3, null_sink_stats_midterm, 2);                  // S_std_dev mid-term
-        top->hier_block2::connect(statistics_phi_midterm, 0, opencmw_time_sink_power_stats_midterm, 9);  // phi_mean mid-term
-        top->hier_block2::connect(statistics_phi_midterm, 1, opencmw_time_sink_power_stats_midterm, 10); // phi_min mid-term
-        top->hier_block2::connect(statistics_phi_midterm, 2, opencmw_time_sink_power_stats_midterm, 11); // phi_max mid-term
-        top->hier_block2::connect(statistics_phi_midterm, 3, null_sink_stats_midterm, 3);                // phi_std_dev mid-term
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 0, statistics_p_longterm, 0);
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 1, statistics_q_longterm, 0);
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 2, statistics_s_longterm, 0);
-        top->hier_block2::connect(pulsed_power_power_calc_ff_0_0, 3, statistics_phi_longterm, 0);
-        top->hier_block2::connect(statistics_p_longterm, 0, opencmw_time_sink_power_stats_longterm, 0);    // P_mean long-term
-        top->hier_block2::connect(statistics_p_longterm, 1, opencmw_time_sink_power_stats_longterm, 1);    // P_min long-term
-        top->hier_block2::connect(statistics_p_longterm, 2, opencmw_time_sink_power_stats_longterm, 2);    // P_max long-term
-        top->hier_block2::connect(statistics_p_longterm, 3, null_sink_stats_longterm, 0);                  // P_std_dev long-term
-        top->hier_block2::connect(statistics_q_longterm, 0, opencmw_time_sink_power_stats_longterm, 3);    // Q_mean long-term
-        top->hier_block2::connect(statistics_q_longterm, 1, opencmw_time_sink_power_stats_longterm, 4);    // Q_min long-term
-        top->hier_block2::connect(statistics_q_longterm, 2, opencmw_time_sink_power_stats_longterm, 5);    // Q_max long-term
-        top->hier_block2::connect(statistics_q_longterm, 3, null_sink_stats_longterm, 1);                  // Q_std_dev long-term
-        top->hier_block2::connect(statistics_s_longterm, 0, opencmw_time_sink_power_stats_longterm, 6);    // S_mean long-term
-        top->hier_block2::connect(statistics_s_longterm, 1, opencmw_time_sink_power_stats_longterm, 7);    // S_min long-term
-        top->hier_block2::connect(statistics_s_longterm, 2, opencmw_time_sink_power_stats_longterm, 8);    // S_max long-term
-        top->hier_block2::connect(statistics_s_longterm, 3, null_sink_stats_longterm, 2);                  // S_std_dev long-term
-        top->hier_block2::connect(statistics_phi_longterm, 0, opencmw_time_sink_power_stats_longterm, 9);  // phi_mean long-term
-        top->hier_block2::connect(statistics_phi_longterm, 1, opencmw_time_sink_power_stats_longterm, 10); // phi_min long-term
-        top->hier_block2::connect(statistics_phi_longterm, 2, opencmw_time_sink_power_stats_longterm, 11); // phi_max long-term
-        top->hier_block2::connect(statistics_phi_longterm, 3, null_sink_stats_longterm, 3);                // phi_std_dev long-term
+        connect(pulsed_power_power_calc_ff_0_0, 0, statistics_p_shortterm, 0);
+        connect(pulsed_power_power_calc_ff_0_0, 1, statistics_q_shortterm, 0);
+        connect(pulsed_power_power_calc_ff_0_0, 2, statistics_s_shortterm, 0);
+        connect(pulsed_power_power_calc_ff_0_0, 3, statistics_phi_shortterm, 0);
+        connect(statistics_p_shortterm, 0, opencmw_time_sink_power_stats_shortterm, 0);    // P_mean short-term
+        connect(statistics_p_shortterm, 1, opencmw_time_sink_power_stats_shortterm, 1);    // P_min short-term
+        connect(statistics_p_shortterm, 2, opencmw_time_sink_power_stats_shortterm, 2);    // P_max short-term
+        connect(statistics_p_shortterm, 3, null_sink_stats_shortterm, 0);                  // P_std_dev short-term
+        connect(statistics_q_shortterm, 0, opencmw_time_sink_power_stats_shortterm, 3);    // Q_mean short-term
+        connect(statistics_q_shortterm, 1, opencmw_time_sink_power_stats_shortterm, 4);    // Q_min short-term
+        connect(statistics_q_shortterm, 2, opencmw_time_sink_power_stats_shortterm, 5);    // Q_max short-term
+        connect(statistics_q_shortterm, 3, null_sink_stats_shortterm, 1);                  // Q_std_dev short-term
+        connect(statistics_s_shortterm, 0, opencmw_time_sink_power_stats_shortterm, 6);    // S_mean short-term
+        connect(statistics_s_shortterm, 1, opencmw_time_sink_power_stats_shortterm, 7);    // S_min short-term
+        connect(statistics_s_shortterm, 2, opencmw_time_sink_power_stats_shortterm, 8);    // S_max short-term
+        connect(statistics_s_shortterm, 3, null_sink_stats_shortterm, 2);                  // S_std_dev short-term
+        connect(statistics_phi_shortterm, 0, opencmw_time_sink_power_stats_shortterm, 9);  // phi_mean short-term
+        connect(statistics_phi_shortterm, 1, opencmw_time_sink_power_stats_shortterm, 10); // phi_min short-term
+        connect(statistics_phi_shortterm, 2, opencmw_time_sink_power_stats_shortterm, 11); // phi_max short-term
+        connect(statistics_phi_shortterm, 3, null_sink_stats_shortterm, 3);                // phi_std_dev short-term
+        connect(pulsed_power_power_calc_ff_0_0, 0, statistics_p_midterm, 0);
+        connect(pulsed_power_power_calc_ff_0_0, 1, statistics_q_midterm, 0);
+        connect(pulsed_power_power_calc_ff_0_0, 2, statistics_s_midterm, 0);
+        connect(pulsed_power_power_calc_ff_0_0, 3, statistics_phi_midterm, 0);
+        connect(statistics_p_midterm, 0, opencmw_time_sink_power_stats_midterm, 0);    // P_mean mid-term
+        connect(statistics_p_midterm, 1, opencmw_time_sink_power_stats_midterm, 1);    // P_min mid-term
+        connect(statistics_p_midterm, 2, opencmw_time_sink_power_stats_midterm, 2);    // P_max mid-term
+        connect(statistics_p_midterm, 3, null_sink_stats_midterm, 0);                  // P_std_dev mid-term
+        connect(statistics_q_midterm, 0, opencmw_time_sink_power_stats_midterm, 3);    // Q_mean mid-term
+        connect(statistics_q_midterm, 1, opencmw_time_sink_power_stats_midterm, 4);    // Q_min mid-term
+        connect(statistics_q_midterm, 2, opencmw_time_sink_power_stats_midterm, 5);    // Q_max mid-term
+        connect(statistics_q_midterm, 3, null_sink_stats_midterm, 1);                  // Q_std_dev mid-term
+        connect(statistics_s_midterm, 0, opencmw_time_sink_power_stats_midterm, 6);    // S_mean mid-term
+        connect(statistics_s_midterm, 1, opencmw_time_sink_power_stats_midterm, 7);    // S_min mid-term
+        connect(statistics_s_midterm, 2, opencmw_time_sink_power_stats_midterm, 8);    // S_max mid-term
+        connect(statistics_s_midterm, 3, null_sink_stats_midterm, 2);                  // S_std_dev mid-term
+        connect(statistics_phi_midterm, 0, opencmw_time_sink_power_stats_midterm, 9);  // phi_mean mid-term
+        connect(statistics_phi_midterm, 1, opencmw_time_sink_power_stats_midterm, 10); // phi_min mid-term
+        connect(statistics_phi_midterm, 2, opencmw_time_sink_power_stats_midterm, 11); // phi_max mid-term
+        connect(statistics_phi_midterm, 3, null_sink_stats_midterm, 3);                // phi_std_dev mid-term
+        connect(pulsed_power_power_calc_ff_0_0, 0, statistics_p_longterm, 0);
+        connect(pulsed_power_power_calc_ff_0_0, 1, statistics_q_longterm, 0);
+        connect(pulsed_power_power_calc_ff_0_0, 2, statistics_s_longterm, 0);
+        connect(pulsed_power_power_calc_ff_0_0, 3, statistics_phi_longterm, 0);
+        connect(statistics_p_longterm, 0, opencmw_time_sink_power_stats_longterm, 0);    // P_mean long-term
+        connect(statistics_p_longterm, 1, opencmw_time_sink_power_stats_longterm, 1);    // P_min long-term
+        connect(statistics_p_longterm, 2, opencmw_time_sink_power_stats_longterm, 2);    // P_max long-term
+        connect(statistics_p_longterm, 3, null_sink_stats_longterm, 0);                  // P_std_dev long-term
+        connect(statistics_q_longterm, 0, opencmw_time_sink_power_stats_longterm, 3);    // Q_mean long-term
+        connect(statistics_q_longterm, 1, opencmw_time_sink_power_stats_longterm, 4);    // Q_min long-term
+        connect(statistics_q_longterm, 2, opencmw_time_sink_power_stats_longterm, 5);    // Q_max long-term
+        connect(statistics_q_longterm, 3, null_sink_stats_longterm, 1);                  // Q_std_dev long-term
+        connect(statistics_s_longterm, 0, opencmw_time_sink_power_stats_longterm, 6);    // S_mean long-term
+        connect(statistics_s_longterm, 1, opencmw_time_sink_power_stats_longterm, 7);    // S_min long-term
+        connect(statistics_s_longterm, 2, opencmw_time_sink_power_stats_longterm, 8);    // S_max long-term
+        connect(statistics_s_longterm, 3, null_sink_stats_longterm, 2);                  // S_std_dev long-term
+        connect(statistics_phi_longterm, 0, opencmw_time_sink_power_stats_longterm, 9);  // phi_mean long-term
+        connect(statistics_phi_longterm, 1, opencmw_time_sink_power_stats_longterm, 10); // phi_min long-term
+        connect(statistics_phi_longterm, 2, opencmw_time_sink_power_stats_longterm, 11); // phi_max long-term
+        connect(statistics_phi_longterm, 3, null_sink_stats_longterm, 3);                // phi_std_dev long-term
         // Frequency spectras
-        top->hier_block2::connect(source_interface_voltage0, 0, stream_to_vector_U, 0);
-        top->hier_block2::connect(stream_to_vector_U, 0, fft_U, 0);
-        top->hier_block2::connect(fft_U, 0, complex_to_mag_U, 0);
-        top->hier_block2::connect(complex_to_mag_U, 0, opencmw_freq_sink_nilm_U, 0); // freq_spectra voltage
-        top->hier_block2::connect(source_interface_current0, 0, stream_to_vector_I, 0);
-        top->hier_block2::connect(stream_to_vector_I, 0, fft_I, 0);
-        top->hier_block2::connect(fft_I, 0, complex_to_mag_I, 0);
-        top->hier_block2::connect(complex_to_mag_I, 0, opencmw_freq_sink_nilm_I, 0); // freq_spectra current
-        top->hier_block2::connect(source_interface_current0, 0, multiply_voltage_current, 0);
-        top->hier_block2::connect(source_interface_voltage0, 0, multiply_voltage_current, 1);
-        top->hier_block2::connect(multiply_voltage_current, 0, stream_to_vector_S, 0);
-        top->hier_block2::connect(stream_to_vector_S, 0, fft_S, 0);
-        top->hier_block2::connect(fft_S, 0, complex_to_mag_S, 0);
-        top->hier_block2::connect(complex_to_mag_S, 0, opencmw_freq_sink_nilm_S, 0); // freq_spectra apparent power (nilm)
-        top->hier_block2::connect(multiply_voltage_current, 0, frequency_spec_one_in_n, 0);
-        top->hier_block2::connect(frequency_spec_one_in_n, 0, frequency_spec_low_pass, 0);
-        top->hier_block2::connect(frequency_spec_low_pass, 0, frequency_spec_stream_to_vec, 0);
-        top->hier_block2::connect(frequency_spec_stream_to_vec, 0, frequency_spec_fft, 0);
-        top->hier_block2::connect(frequency_spec_fft, 0, frequency_multiply_const, 0);
-        top->hier_block2::connect(frequency_multiply_const, 0, frequency_spec_complex_to_mag, 0);
-        top->hier_block2::connect(frequency_spec_complex_to_mag, 0, frequency_spec_pulsed_power_opencmw_freq_sink, 0); // freq_spectra apparent power
+        connect(source_interface_voltage0, 0, stream_to_vector_U, 0);
+        connect(stream_to_vector_U, 0, fft_U, 0);
+        connect(fft_U, 0, complex_to_mag_U, 0);
+        connect(complex_to_mag_U, 0, opencmw_freq_sink_nilm_U, 0); // freq_spectra voltage
+        connect(source_interface_current0, 0, stream_to_vector_I, 0);
+        connect(stream_to_vector_I, 0, fft_I, 0);
+        connect(fft_I, 0, complex_to_mag_I, 0);
+        connect(complex_to_mag_I, 0, opencmw_freq_sink_nilm_I, 0); // freq_spectra current
+        connect(source_interface_current0, 0, multiply_voltage_current, 0);
+        connect(source_interface_voltage0, 0, multiply_voltage_current, 1);
+        connect(multiply_voltage_current, 0, stream_to_vector_S, 0);
+        connect(stream_to_vector_S, 0, fft_S, 0);
+        connect(fft_S, 0, complex_to_mag_S, 0);
+        connect(complex_to_mag_S, 0, opencmw_freq_sink_nilm_S, 0); // freq_spectra apparent power (nilm)
+        connect(multiply_voltage_current, 0, frequency_spec_one_in_n, 0);
+        connect(frequency_spec_one_in_n, 0, frequency_spec_low_pass, 0);
+        connect(frequency_spec_low_pass, 0, frequency_spec_stream_to_vec, 0);
+        connect(frequency_spec_stream_to_vec, 0, frequency_spec_fft, 0);
+        connect(frequency_spec_fft, 0, frequency_multiply_const, 0);
+        connect(frequency_multiply_const, 0, frequency_spec_complex_to_mag, 0);
+        connect(frequency_spec_complex_to_mag, 0, frequency_spec_pulsed_power_opencmw_freq_sink, 0); // freq_spectra apparent power
     }
-    ~PulsedPowerFlowgraph() { top->stop(); }
-    // start gnuradio flowgraph
-    void start() { top->start(); }
 };
 
 #endif /* GR_FLOWGRAPHS_HPP */
@@ -8,7 +8,11 @@
 #include <iomanip>
 #include <thread>
 
+#include "NilmEnergyWorker.hpp"
 #include "NilmPredictWorker.hpp"
+#include "inference/BackendFactory.hpp"
+#include "inference/CaptureReplay.hpp"
+#include "inference/NilmCapture.hpp"
 
 using namespace opencmw::majordomo;
 
@@ -74,14 +78,129 @@ public:
     }
 };
 
+// runs a capture through the same switch detection, inference and integration as NilmPredictWorker,
+// a negative cadence replays at the recorded timestamps, zero at maximum speed
+int replayCapture(const std::string &captureFilename, size_t vectorSize, std::chrono::milliseconds cadence, std::unique_ptr<InferenceBackend> backend, bool allFrames, bool compare) {
+    // indexed capture or a raw one of back-to-back data points (without timestamps, vectorSize given on the command line)
+    std::unique_ptr<nilm_capture::Reader> indexedCapture;
+    std::unique_ptr<MappedCapture>        rawCapture;
+    if (nilm_capture::Reader::isCapture(captureFilename)) {
+        indexedCapture = std::make_unique<nilm_capture::Reader>(captureFilename);
+        fmt::print("Capture: vector size {}, sample rate {} Hz, recorded with {}\n", indexedCapture->header().vectorSize, indexedCapture->header().sampleRate, indexedCapture->header().modelVersion.data());
+    } else {
+        rawCapture = std::make_unique<MappedCapture>(captureFilename, NilmPipeline::featureCount(vectorSize));
+        if (cadence < 0ms) {
+            fmt::print("Raw capture without timestamps, replaying at maximum speed\n");
+            cadence = 0ms;
+        }
+    }
+    const size_t         records = indexedCapture ? indexedCapture->records() : rawCapture->records();
+    std::vector<uint8_t> scratch;
+    auto                 readRecord = [&](size_t i, std::vector<float> &dataPoint) {
+        if (indexedCapture) {
+            indexedCapture->read(i, dataPoint, scratch);
+        } else {
+            auto record = rawCapture->record(i);
+            dataPoint.assign(record.begin(), record.end());
+        }
+    };
+
+    NilmPipeline pipeline(std::move(backend));
+    pipeline.setSwitchDetection(!allFrames);
+    fmt::print("Replaying {} data points from {} with backend {}\n", records, captureFilename, pipeline.backend().name());
+
+    // reference backend for validating the native classifier, observes every data point as well
+    std::unique_ptr<InferenceBackend> reference;
+    if (compare) {
+        reference = createTensorflowBackend();
+    }
+    std::vector<float>          referenceValues;
+    float                       maxDeviation = 0.0f;
+
+    const std::filesystem::path integratorPath = std::filesystem::temp_directory_path() / fmt::format("nilm_replay_{}", getpid());
+    PowerIntegrator             integrator(NilmPredictData{}.names.size(), integratorPath.string() + "/", 100);
+
+    StageLatency                load("load", records);
+    StageLatency                observe("observe", records);
+    StageLatency                detect("detect", records);
+    StageLatency                predict("predict", records);
+    StageLatency                integrate("integrate", records);
+
+    std::vector<float>          dataPoint;
+    std::vector<float>          values;
+    const auto                  start     = std::chrono::steady_clock::now();
+    const int64_t               startTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    // raw captures are integrated at the nominal 60 ms spacing or the given cadence
+    const auto                  spacing   = cadence > 0ms ? cadence : 60ms;
+    for (size_t i = 0; i < records; i++) {
+        const int64_t timestamp = indexedCapture ? indexedCapture->timestamp(i) : startTime + static_cast<int64_t>(i) * std::chrono::duration_cast<std::chrono::nanoseconds>(spacing).count();
+        if (cadence > 0ms) {
+            std::this_thread::sleep_until(start + i * cadence);
+        } else if (cadence < 0ms) {
+            std::this_thread::sleep_until(start + std::chrono::nanoseconds(timestamp - indexedCapture->timestamp(0)));
+        }
+        auto t0 = std::chrono::steady_clock::now();
+        readRecord(i, dataPoint);
+        auto t1 = std::chrono::steady_clock::now();
+        pipeline.observe(dataPoint);
+        auto t2        = std::chrono::steady_clock::now();
+        bool switching = pipeline.switching(dataPoint) || values.empty();
+        auto t3        = std::chrono::steady_clock::now();
+        load.add(t1 - t0);
+        observe.add(t2 - t1);
+        detect.add(t3 - t2);
+        if (reference) {
+            reference->observe(dataPoint);
+        }
+        if (switching) {
+            auto t4 = std::chrono::steady_clock::now();
+            pipeline.classify(values);
+            predict.add(std::chrono::steady_clock::now() - t4);
+            if (reference) {
+                reference->classify(referenceValues);
+                for (size_t k = 0; k < std::min(values.size(), referenceValues.size()); k++) {
+                    maxDeviation = std::max(maxDeviation, std::abs(values[k] - referenceValues[k]));
+                }
+            }
+        } else {
+            NilmPipeline::hold(values, dataPoint[dataPoint.size() - 2]);
+        }
+        auto t5 = std::chrono::steady_clock::now();
+        integrator.update(timestamp, values);
+        integrate.add(std::chrono::steady_clock::now() - t5);
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::filesystem::remove_all(integratorPath);
+
+    fmt::print("{} data points in {:.3f} s: {:.1f} data points/s, {} classified ({:.1f} predictions/s of model time)\n", records, seconds, static_cast<double>(records) / seconds,
+            predict.count(), predict.total() > 0.0 ? static_cast<double>(predict.count()) / (predict.total() * 1e-6) : 0.0);
+    for (auto *stage : { &load, &observe, &detect, &predict, &integrate }) {
+        fmt::print("  {}\n", stage->summary());
+    }
+    if (reference) {
+        fmt::print("max deviation from {}: {}\n", reference->name(), maxDeviation);
+    }
+    return 0;
+}
+
 int main(int argc, char *argv[]) {
     int                  opt;
     std::string          captureFilename;
+    std::string          guptaParameterFile;
+    bool                 allFrames     = false;
+    bool                 compare       = false;
+    size_t               vectorSize    = 131072; // sink vector size, the model takes 2^16 bins
+    int                  cadenceMs     = 0;
     Mode                 mode          = Mode::Normal;
-    const char          *shortOptions  = "r:w:h";
+    const char          *shortOptions  = "r:w:g:an:t:ch";
     static struct option longOptions[] = {
         { "read-from-file", required_argument, 0, 'r' },
         { "write-to-file", required_argument, 0, 'w' },
+        { "gupta-params", required_argument, 0, 'g' },
+        { "all-frames", no_argument, 0, 'a' },
+        { "vector-size", required_argument, 0, 'n' },
+        { "cadence", required_argument, 0, 't' },
+        { "compare", no_argument, 0, 'c' },
         { "help", no_argument, 0, 'h' },
         { 0, 0, 0, 0 }
     };
@@ -97,18 +216,41 @@ int main(int argc, char *argv[]) {
                 fmt::print(std::cerr, "File {} does not exist\n", captureFilename);
                 return 1;
             }
-            fmt::print("Warning: Read mode is not currently supported, defaults to normal mode\n");
             break;
         case 'w':
             mode            = Mode::Write;
             captureFilename = optarg;
             break;
+        case 'g':
+            guptaParameterFile = optarg;
+            if (access(guptaParameterFile.c_str(), F_OK) == -1) {
+                fmt::print(std::cerr, "File {} does not exist\n", guptaParameterFile);
+                return 1;
+            }
+            break;
+        case 'a':
+            allFrames = true;
+            break;
+        case 'n':
+            vectorSize = std::stoul(optarg);
+            break;
+        case 't':
+            cadenceMs = std::string_view(optarg) == "recorded" ? -1 : std::stoi(optarg);
+            break;
+        case 'c':
+            compare = true;
+            break;
 
         case 'h':
-            fmt::print("Usage: {} [-r /path/to/file] [-w /path/to/file] [-h]\n", argv[0]);
+            fmt::print("Usage: {} [-r /path/to/file] [-w /path/to/file] [-g /path/to/params] [-a] [-n vector size] [-t ms] [-c] [-h]\n", argv[0]);
             fmt::print("Options:\n");
-            fmt::print("  -r, --read-from-file    Read from file\n");
+            fmt::print("  -r, --read-from-file    Replay a capture offline and report the throughput and per-stage latency\n");
             fmt::print("  -w, --write-to-file     Write to file\n");
+            fmt::print("  -g, --gupta-params      Run the native Gupta classifier with the exported parameters instead of TensorFlow (required without ENABLE_TENSORFLOW)\n");
+            fmt::print("  -a, --all-frames        Classify every frame, not only those around detected load changes\n");
+            fmt::print("  -n, --vector-size       Sink vector size of a raw (headerless) capture (default 131072)\n");
+            fmt::print("  -t, --cadence           Replay one data point every t ms or at the recorded timestamps (-t recorded) instead of at maximum speed\n");
+            fmt::print("  -c, --compare           Compare the replayed predictions with the TensorFlow model\n");
             fmt::print("  -h, --help              Display this help message\n");
             return 1;
             break;
@@ -119,6 +261,23 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    if (mode == Mode::Read) {
+        try {
+            return replayCapture(captureFilename, vectorSize, std::chrono::milliseconds(cadenceMs), createInferenceBackend(guptaParameterFile), allFrames, compare);
+        } catch (const std::exception &ex) {
+            fmt::print(std::cerr, "Replay failed: {}\n", ex.what());
+            return 1;
+        }
+    }
+
+    std::unique_ptr<InferenceBackend> backend;
+    try {
+        backend = createInferenceBackend(guptaParameterFile);
+    } catch (const std::exception &ex) {
+        fmt::print(std::cerr, "No inference backend: {}\n", ex.what());
+        return 1;
+    }
+
     Broker                                          broker("Inference-Tool");
     auto                                            fs          = cmrc::assets::get_filesystem();
     const std::string_view                          REST_SCHEME = "https";
@@ -137,13 +296,18 @@ int main(int argc, char *argv[]) {
     std::jthread brokerThread([&broker] { broker.run(); });
 
     // OpenCMW workers
-    NilmPredictWorker<"nilm_predict_values", description<"Nilm Predicted Data">> nilmPredictWorker(broker, std::chrono::milliseconds(60), mode, captureFilename);
+    NilmPredictWorker<"nilm_predict_values", description<"Nilm Predicted Data">> nilmPredictWorker(broker, std::chrono::milliseconds(20), mode, captureFilename, std::move(backend));
+    NilmEnergyWorker<"nilm_energy", description<"Nilm Energy per Interval">>     nilmEnergyWorker(broker, nilmPredictWorker.powerIntegrator(), nilmPredictWorker.deviceNames());
+
+    nilmPredictWorker.setSwitchDetection(!allFrames);
 
     // run workers in separate threads
     std::jthread nilmPredictWorkerThread([&nilmPredictWorker] { nilmPredictWorker.run(); });
+    std::jthread nilmEnergyWorkerThread([&nilmEnergyWorker] { nilmEnergyWorker.run(); });
 
     brokerThread.join();
 
     // workers terminate when broker shuts down
     nilmPredictWorkerThread.join();
+    nilmEnergyWorkerThread.join();
 }
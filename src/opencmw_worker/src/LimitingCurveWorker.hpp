@@ -61,10 +61,11 @@ public:
                 super_t::notify("limitingCurve", context, reply);
             }
         });*/
-        super_t::setCallback([this](RequestContext &rawCtx, const TestContext &,
-                                     const Empty &, TestContext &,
+        super_t::setCallback([this](RequestContext &rawCtx, const TestContext &requestContext,
+                                     const Empty &, TestContext &replyContext,
                                      LimitingCurve &out) {
             using namespace opencmw;
+            replyContext.contentType = requestContext.contentType;
             const auto topicPath = URI<RELAXED>(std::string(rawCtx.request.topic()))
                                            .path()
                                            .value_or("");
@@ -4,19 +4,31 @@
 #include <disruptor/RingBuffer.hpp>
 #include <majordomo/Worker.hpp>
 
+#include "NilmSharedMemory.hpp"
+
 #include <gnuradio/pulsed_power/opencmw_freq_sink.h>
 #include <gnuradio/pulsed_power/opencmw_time_sink.h>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
 using opencmw::Annotated;
 using opencmw::NoUnit;
 
 // context for InferenceTool
+// at most 8 consumer names have a cursor, one idle for 60 s is handed over to a new name, while all are in use new names get an error reply
 struct NilmAcquisitionContext {
     int64_t                 lastRefTrigger = 0;
-    opencmw::MIME::MimeType contentType    = opencmw::MIME::JSON;
+    std::string             consumer;        // server-side cursor, frames are delivered once per consumer, empty: shared cursor
+    int64_t                 waitMs      = 0; // long-poll: without pending frames the request is parked for waitMs, arriving frames are notified on its topic
+    opencmw::MIME::MimeType contentType = opencmw::MIME::JSON;
 };
 
-ENABLE_REFLECTION_FOR(NilmAcquisitionContext, lastRefTrigger, contentType)
+ENABLE_REFLECTION_FOR(NilmAcquisitionContext, lastRefTrigger, consumer, waitMs, contentType)
 
 // data for InferenceTool
 struct AcquisitionNilm {
@@ -58,48 +70,78 @@ class NilmDataWorker : public Worker<serviceName, NilmAcquisitionContext, Empty,
     };
     using ringbuffer_t = std::shared_ptr<RingBuffer<RingBufferData, RING_BUFFER_SIZE, BusySpinWaitStrategy, SingleThreadedStrategy>>;
     using sequence_t   = std::shared_ptr<Sequence>;
-    ringbuffer_t _nilmDataBuffer;
-    sequence_t   _nilmDataBufferTail;
+    ringbuffer_t                      _nilmDataBuffer;
+    sequence_t                        _nilmDataBufferTail;
+    std::vector<sequence_t>           _consumerSequences; // in-process consumers, e.g. NilmPredictWorker in PulsedPowerService
+    std::mutex                        _consumerSequencesMutex;
+    std::mutex                        _framesMutex;
+    std::condition_variable           _framesAvailable; // notified for every published frame
+    struct NamedConsumer {
+        std::string                           name;
+        sequence_t                            sequence;
+        std::chrono::steady_clock::time_point lastAccess;
+    };
+    struct ParkedRequest {
+        NilmAcquisitionContext                context; // topic of the wake-up notification
+        std::chrono::steady_clock::time_point deadline;
+    };
+    static const size_t               MAX_NAMED_CONSUMERS   = 8; // see NilmAcquisitionContext
+    static constexpr auto             CONSUMER_IDLE_TIMEOUT = std::chrono::seconds(60);
+    static constexpr int64_t          MAX_WAIT_MS           = 1000; // longest a long-poll stays parked
+    std::vector<NamedConsumer>        _namedConsumers; // REST consumers, only used by the worker thread
+    std::vector<ParkedRequest>        _parkedRequests; // long-polls waiting for frames, guarded by _framesMutex
+    const bool                        _exportSharedMemory;
+    const std::vector<std::string>    _powerSignals;    // P, Q, S, phi of the device the NILM follows
+    const std::vector<std::string>    _spectrumSignals; // apparent power spectrum of that device
+    std::unique_ptr<nilm_shm::Writer> _sharedMemory;    // frames for NilmPredictWorker on the same host
+    // destroyed first, the sink callbacks write into the members above
+    std::vector<gr::pulsed_power::subscription> _subscriptions;
 
 public:
     using super_t = Worker<serviceName, NilmAcquisitionContext, Empty, AcquisitionNilm, Meta...>;
 
+    // signalPrefix selects the device with several flowgraphs, see FlowgraphConfig::signalPrefix(), powerRate is its rates.shortTerm
     template<typename BrokerType>
-    explicit NilmDataWorker(const BrokerType &broker)
-        : super_t(broker, {}), _nilmDataBuffer(newRingBuffer<RingBufferData, RING_BUFFER_SIZE, BusySpinWaitStrategy, ProducerType::Single>()), _nilmDataBufferTail(std::make_shared<Sequence>()) {
+    explicit NilmDataWorker(const BrokerType &broker, bool exportSharedMemory = true, const std::string &signalPrefix = "", float powerRate = 100.0f)
+        : super_t(broker, {}), _nilmDataBuffer(newRingBuffer<RingBufferData, RING_BUFFER_SIZE, BusySpinWaitStrategy, ProducerType::Single>()), _nilmDataBufferTail(std::make_shared<Sequence>()), _exportSharedMemory(exportSharedMemory), _powerSignals{ signalPrefix + "P", signalPrefix + "Q", signalPrefix + "S", signalPrefix + "phi" }, _spectrumSignals{ signalPrefix + "ApparentPowerSpectrumNilm" } {
         _nilmDataBuffer->addGatingSequences({ _nilmDataBufferTail });
 
-        // register callback only for "P@100Hz,Q@100Hz,S@100Hz,phi@100Hz"
-        std::scoped_lock lock_time(gr::pulsed_power::globalTimeSinksRegistryMutex);
-        for (auto sink : gr::pulsed_power::globalTimeSinksRegistry) {
-            const auto               signal_names = sink->get_signal_names();
-            const auto               signal_units = sink->get_signal_units();
-            const auto               sample_rate  = sink->get_sample_rate();
-
-            std::vector<std::string> pqsphi_str{ "P", "Q", "S", "phi" };
-            if (signal_names == pqsphi_str && sample_rate == 100.0f) {
-                // fmt::print("NilmDataWorker: name {}, unit {}, rate {}\n", signal_names, signal_units, sample_rate);
-                sink->set_callback(std::bind(&NilmDataWorker::handleReceivedTimeDataCb, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4, std::placeholders::_5));
-            }
+        // subscribe only to "P@100Hz,Q@100Hz,S@100Hz,phi@100Hz" (at the configured short-term rate)
+        const auto powerSignal = gr::pulsed_power::qualified_signal_name(_powerSignals[0], powerRate);
+        if (auto sink = gr::pulsed_power::time_sink_registry().find(powerSignal); sink && sink->get_signal_names() == _powerSignals) {
+            _subscriptions.push_back(sink->subscribe([this](std::vector<const void *> &input_items, int &noutput_items, const std::vector<std::string> &signal_names, float sample_rate, int64_t timestamp_ns) {
+                handleReceivedTimeDataCb(input_items, noutput_items, signal_names, sample_rate, timestamp_ns);
+            }));
+        } else {
+            fmt::print("NilmDataWorker: no time sink publishes '{}', the NILM gets no P, Q, S, phi\n", powerSignal);
         }
 
-        // register callback only for Apparent Power Spectrum ("S")
-        std::scoped_lock lock_freq(gr::pulsed_power::globalFrequencySinksRegistryMutex);
-        for (auto sink : gr::pulsed_power::globalFrequencySinksRegistry) {
+        // subscribe only to the Apparent Power Spectrum ("S")
+        for (const auto &sink : gr::pulsed_power::freq_sink_registry().sinks()) {
             const auto               signal_names = sink->get_signal_names();
             const auto               signal_units = sink->get_signal_units();
             const auto               sample_rate  = sink->get_sample_rate();
 
-            std::vector<std::string> uis_str{ "ApparentPowerSpectrumNilm" };
-            if (signal_names == uis_str) {
+            if (signal_names == _spectrumSignals) {
                 // fmt::print("NilmDataWorker: name {}, unit {}, rate {}\n", signal_names, signal_units, sample_rate);
-                sink->set_callback(std::bind(&NilmDataWorker::handleReceivedFreqDataCb, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4, std::placeholders::_5, std::placeholders::_6));
+                // preallocate every slot at spectrum size, the callback only copies into them
+                for (int64_t sequence = 0; sequence < static_cast<int64_t>(RING_BUFFER_SIZE); sequence++) {
+                    (*_nilmDataBuffer)[sequence].freqData.apparentPowerSpectrum.resize(sink->get_vector_size());
+                }
+                if (_exportSharedMemory) {
+                    _sharedMemory = std::make_unique<nilm_shm::Writer>(static_cast<uint32_t>(sink->get_vector_size()));
+                    fmt::print("NilmDataWorker: shared memory '{}' {}\n", nilm_shm::DEFAULT_NAME, _sharedMemory->isOpen() ? "exported" : "could not be created, REST only");
+                }
+                _subscriptions.push_back(sink->subscribe([this](std::vector<const void *> &input_items, int &nitems, size_t vector_size, const std::vector<std::string> &signal_names, float sample_rate, int64_t timestamp) {
+                    handleReceivedFreqDataCb(input_items, nitems, vector_size, signal_names, sample_rate, timestamp);
+                }));
             }
         }
 
         super_t::setCallback([this](RequestContext &rawCtx, const NilmAcquisitionContext &requestContext,
-                                     const Empty &, NilmAcquisitionContext &,
+                                     const Empty &, NilmAcquisitionContext &replyContext,
                                      AcquisitionNilm &out) {
+            replyContext.contentType = requestContext.contentType;
             if (rawCtx.request.command() == Command::Get) {
                 handleGetRequest(requestContext, out);
             }
@@ -108,37 +150,127 @@ public:
 
     ~NilmDataWorker() {}
 
-private:
-    void handleGetRequest(const NilmAcquisitionContext & /* requestContext */, AcquisitionNilm &out) {
-        getAcquisitionNilm(out);
+    // registers an in-process consumer which reads the ring buffer directly, starting with the next frame
+    sequence_t addConsumer() {
+        auto consumer = std::make_shared<Sequence>(_nilmDataBuffer->cursor() + 1);
+        _nilmDataBuffer->addGatingSequences({ consumer });
+        std::scoped_lock lock(_consumerSequencesMutex);
+        _consumerSequences.push_back(consumer);
+        return consumer;
+    }
+
+    // blocks up to timeout until consumer has a frame to read, returns false on timeout
+    bool waitForFrames(const Sequence &consumer, std::chrono::milliseconds timeout) {
+        std::unique_lock lock(_framesMutex);
+        return _framesAvailable.wait_for(lock, timeout, [this, &consumer] { return _nilmDataBuffer->cursor() >= std::max<int64_t>(consumer.value(), 0); });
     }
 
-    void getAcquisitionNilm(AcquisitionNilm &out) {
-        int64_t tail     = _nilmDataBufferTail->value();
-        int64_t head     = _nilmDataBuffer->cursor();
+    // copies all frames not yet read by consumer into out and advances it, returns the number of frames
+    size_t readFrames(Sequence &consumer, AcquisitionNilm &out) {
+        // ignore first entry in RingBuffer (sequence -1), contains no data
+        const int64_t tail   = std::max<int64_t>(consumer.value(), 0);
+        const int64_t head   = _nilmDataBuffer->cursor();
+        const auto    frames = static_cast<size_t>(std::max<int64_t>(head - tail + 1, 0));
 
-        int64_t sequence = 0;
-        for (sequence = tail; sequence <= head; sequence++) {
-            RingBufferData &bufData = (*_nilmDataBuffer)[sequence];
-            if (sequence == -1) {
-                // ignore first entry in RingBuffer, contains no data
-                continue;
-            }
+        size_t spectrumValues = 0;
+        for (int64_t sequence = tail; sequence <= head; sequence++) {
+            spectrumValues += (*_nilmDataBuffer)[sequence].freqData.apparentPowerSpectrum.size();
+        }
+        if (spectrumValues == 0) {
+            return 0;
+        }
 
+        // size the reply once and copy the spectra straight from the slots
+        out.refTriggerStamp.reserve(frames);
+        out.realPower.reserve(frames);
+        out.reactivePower.reserve(frames);
+        out.apparentPower.reserve(frames);
+        out.phi.reserve(frames);
+        out.apparentPowerSpectrumStridedValues.resize(spectrumValues);
+        auto spectrumOut = out.apparentPowerSpectrumStridedValues.begin();
+        for (int64_t sequence = tail; sequence <= head; sequence++) {
+            const RingBufferData &bufData = (*_nilmDataBuffer)[sequence];
             out.refTriggerStamp.push_back(bufData.freqData.timestamp);
-            out.apparentPowerSpectrumStridedValues.insert(out.apparentPowerSpectrumStridedValues.end(), bufData.freqData.apparentPowerSpectrum.begin(), bufData.freqData.apparentPowerSpectrum.end());
+            spectrumOut = std::copy(bufData.freqData.apparentPowerSpectrum.begin(), bufData.freqData.apparentPowerSpectrum.end(), spectrumOut);
             out.realPower.push_back(bufData.timeData.realPower);
             out.reactivePower.push_back(bufData.timeData.reactivePower);
             out.apparentPower.push_back(bufData.timeData.apparentPower);
             out.phi.push_back(bufData.timeData.phi);
         }
+        consumer.setValue(head + 1);
+        return frames;
+    };
 
-        if (out.apparentPowerSpectrumStridedValues.empty()) {
-            throw std::invalid_argument(fmt::format("No new data"));
-        } else {
-            _nilmDataBufferTail->setValue(sequence);
+private:
+    // never blocks the worker thread: a long-poll without pending frames is answered empty and parked,
+    // the frame-arrival path notifies its topic once there are frames to fetch
+    void handleGetRequest(const NilmAcquisitionContext &requestContext, AcquisitionNilm &out) {
+        Sequence &consumer = requestContext.consumer.empty() ? *_nilmDataBufferTail : *namedConsumer(requestContext.consumer);
+        if (readFrames(consumer, out) == 0 && requestContext.waitMs > 0) {
+            park(requestContext, consumer);
         }
-    };
+    }
+
+    void park(const NilmAcquisitionContext &requestContext, const Sequence &consumer) {
+        NilmAcquisitionContext context = requestContext; // the client long-polls the same query without lastRefTrigger
+        context.lastRefTrigger         = 0;
+        const auto deadline            = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::min(requestContext.waitMs, MAX_WAIT_MS));
+        {
+            std::scoped_lock lock(_framesMutex);
+            // frames published since readFrames() have missed the wake-up, notify right away
+            if (_nilmDataBuffer->cursor() < std::max<int64_t>(consumer.value(), 0)) {
+                auto parked = std::find_if(_parkedRequests.begin(), _parkedRequests.end(), [&context](const ParkedRequest &r) { return r.context.consumer == context.consumer; });
+                if (parked == _parkedRequests.end()) {
+                    _parkedRequests.push_back({ context, deadline });
+                } else {
+                    parked->deadline = deadline;
+                }
+                return;
+            }
+        }
+        super_t::notify("/pulsed_power_nilm", context, AcquisitionNilm());
+    }
+
+    // wakes the parked long-polls up, their clients fetch the frames with the next GET, so none are lost in between
+    void completeParkedRequests(const std::vector<ParkedRequest> &parkedRequests) {
+        const auto now = std::chrono::steady_clock::now();
+        for (const auto &parked : parkedRequests) {
+            if (parked.deadline >= now) {
+                super_t::notify("/pulsed_power_nilm", parked.context, AcquisitionNilm());
+            }
+        }
+    }
+
+    // cursor of a REST consumer, once all are taken one idle for CONSUMER_IDLE_TIMEOUT is handed over
+    // (gating sequences are never removed from the ring buffer, only reused)
+    sequence_t namedConsumer(const std::string &name) {
+        const auto now      = std::chrono::steady_clock::now();
+        auto       consumer = std::find_if(_namedConsumers.begin(), _namedConsumers.end(), [&name](const NamedConsumer &c) { return c.name == name; });
+        if (consumer == _namedConsumers.end()) {
+            if (_namedConsumers.size() < MAX_NAMED_CONSUMERS) {
+                _namedConsumers.push_back({ name, addConsumer(), now });
+                return _namedConsumers.back().sequence;
+            }
+            consumer = std::min_element(_namedConsumers.begin(), _namedConsumers.end(), [](const NamedConsumer &a, const NamedConsumer &b) { return a.lastAccess < b.lastAccess; });
+            if (now - consumer->lastAccess < CONSUMER_IDLE_TIMEOUT) {
+                throw std::invalid_argument(fmt::format("NilmDataWorker: all {} consumer cursors are in use, '{}' rejected", MAX_NAMED_CONSUMERS, name));
+            }
+            consumer->name = name;
+            consumer->sequence->setValue(_nilmDataBuffer->cursor() + 1);
+        }
+        consumer->lastAccess = now;
+        return consumer->sequence;
+    }
+
+    // keeps the producer from blocking on slow consumers by dropping their oldest frames
+    void dropOldFrames(Sequence &consumer) {
+        const auto headValue       = _nilmDataBuffer->cursor();
+        const auto tailValue       = consumer.value();
+        const auto tailOffsetValue = static_cast<int64_t>(RING_BUFFER_SIZE) * 50 / 100; // 50 %
+        if (headValue > (tailValue + tailOffsetValue)) {
+            consumer.setValue(headValue - tailOffsetValue);
+        }
+    }
 
     // copy P Q S Phi data
     void handleReceivedTimeDataCb(std::vector<const void *> &input_items, int &noutput_items, const std::vector<std::string> &signal_names, float /* sample_rate */, int64_t timestamp_ns) {
@@ -147,10 +279,9 @@ private:
         const float             *apparentPower = static_cast<const float *>(input_items[2]); // S
         const float             *phi           = static_cast<const float *>(input_items[3]); // phi
 
-        std::vector<std::string> pqsphi_str{ "P", "Q", "S", "phi" };
-        if (signal_names == pqsphi_str) {
+        if (signal_names == _powerSignals) {
             int64_t timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-            // fmt::print("NilmDataWorker: Sink {}, {}ms\n", pqsphi_str, timestamp_ms);
+            // fmt::print("NilmDataWorker: Sink {}, {}ms\n", _powerSignals, timestamp_ms);
 
             std::scoped_lock lock(_timeDataMutex);
             // get last sample for each signal
@@ -167,19 +298,23 @@ private:
         const float *s = static_cast<const float *>(input_items[0]);
         // const float             *u = static_cast<const float *>(input_items[1]);
         // const float             *i = static_cast<const float *>(input_items[2]);
-        std::vector<std::string> sui_str{ "ApparentPowerSpectrumNilm" };
-        if (signal_names == sui_str) {
+        if (signal_names == _spectrumSignals) {
             using namespace std::chrono;
             int64_t timestamp_ms = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
-            // fmt::print("NilmDataWorker: Sink {}, {}ms, vector_size: {}\n", sui_str, timestamp_ms, vector_size);
+            // fmt::print("NilmDataWorker: Sink {}, {}ms, vector_size: {}\n", _spectrumSignals, timestamp_ms, vector_size);
 
             for (int64_t k = 0; k < nitems; k++) {
                 auto offset = k * static_cast<int64_t>(vector_size);
 
+                // claims the next slot, fills it in place and publishes it
                 bool result = _nilmDataBuffer->tryPublishEvent([&s, vector_size, offset, timestamp, this](RingBufferData &&bufferData, std::int64_t /*sequence*/) noexcept {
                     // bufferData.freqData.realPowerMagnitudeValues.assign(p + offset, s + offset + vector_size);
                     // bufferData.freqData.reactivePowerMagnitudeValues.assign(q + offset, s + offset + vector_size);
-                    bufferData.freqData.apparentPowerSpectrum.assign(s + offset, s + offset + vector_size);
+                    auto &spectrum = bufferData.freqData.apparentPowerSpectrum;
+                    if (spectrum.size() != vector_size) {
+                        spectrum.resize(vector_size); // slots are preallocated, only reached if the vector size changes
+                    }
+                    std::copy_n(s + offset, vector_size, spectrum.begin());
                     bufferData.freqData.timestamp = timestamp;
 
                     std::scoped_lock lock(_timeDataMutex);
@@ -187,15 +322,26 @@ private:
                 });
 
                 if (result) {
-                    auto       headValue       = _nilmDataBuffer->cursor();
-                    auto       tailValue       = _nilmDataBufferTail->value();
-
-                    const auto tailOffsetValue = static_cast<int64_t>(RING_BUFFER_SIZE) * 50 / 100; // 50 %
-
-                    if (headValue > (tailValue + tailOffsetValue)) {
-                        _nilmDataBufferTail->setValue(headValue - tailOffsetValue);
+                    if (_sharedMemory) {
+                        const RingBufferData &published = (*_nilmDataBuffer)[_nilmDataBuffer->cursor()];
+                        _sharedMemory->publish(s + offset, vector_size, timestamp, published.timeData.realPower, published.timeData.reactivePower, published.timeData.apparentPower, published.timeData.phi);
                     }
 
+                    dropOldFrames(*_nilmDataBufferTail);
+                    {
+                        std::scoped_lock lock(_consumerSequencesMutex);
+                        for (const auto &consumer : _consumerSequences) {
+                            dropOldFrames(*consumer);
+                        }
+                    }
+                    // the critical section orders the notification after a waiter's predicate check
+                    std::vector<ParkedRequest> parkedRequests;
+                    {
+                        std::scoped_lock lock(_framesMutex);
+                        std::swap(parkedRequests, _parkedRequests);
+                    }
+                    _framesAvailable.notify_all();
+                    completeParkedRequests(parkedRequests);
                 } else {
                     // error writing into RingBuffer
                     // nitems = 0;
@@ -0,0 +1,84 @@
+#ifndef NILM_ENERGY_WORKER_H
+#define NILM_ENERGY_WORKER_H
+
+#include <majordomo/Worker.hpp>
+
+#include "integrator/PowerIntegrator.hpp"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+
+using opencmw::Annotated;
+using opencmw::NoUnit;
+
+// timestamps in ns since the epoch, e.g. hourly bars of the last 30 days: from=<now - 30 d>&resolution=3600000000000
+struct NilmEnergyContext {
+    int64_t                 from        = 0; // 0: 24 hours before to
+    int64_t                 to          = 0; // 0: last integrated sample
+    int64_t                 resolution  = 0; // interval length, 0: a single interval [from, to)
+    opencmw::MIME::MimeType contentType = opencmw::MIME::JSON;
+};
+
+ENABLE_REFLECTION_FOR(NilmEnergyContext, from, to, resolution, contentType)
+
+struct NilmEnergyData {
+    int64_t                        from       = 0;
+    int64_t                        to         = 0;
+    int64_t                        resolution = 0;
+    std::vector<std::string>       names;
+    std::vector<int64_t>           intervalStarts;
+    opencmw::MultiArray<double, 2> energy; // intervals x devices in kWh
+};
+
+ENABLE_REFLECTION_FOR(NilmEnergyData, from, to, resolution, names, intervalStarts, energy)
+
+using namespace opencmw::majordomo;
+template<units::basic_fixed_string serviceName, typename... Meta>
+class NilmEnergyWorker : public Worker<serviceName, NilmEnergyContext, Empty, NilmEnergyData, Meta...> {
+    static constexpr int64_t         DAY_NS        = 24LL * 3600 * 1'000'000'000;
+    static constexpr int64_t         MAX_INTERVALS = 10'000; // per request, bounds the reply size
+    std::shared_ptr<PowerIntegrator> _powerIntegrator;
+    std::vector<std::string>         _names;
+
+public:
+    using super_t = Worker<serviceName, NilmEnergyContext, Empty, NilmEnergyData, Meta...>;
+
+    template<typename BrokerType>
+    explicit NilmEnergyWorker(const BrokerType &broker, std::shared_ptr<PowerIntegrator> powerIntegrator, std::vector<std::string> names)
+        : super_t(broker, {}), _powerIntegrator(std::move(powerIntegrator)), _names(std::move(names)) {
+        super_t::setCallback([this](RequestContext &rawCtx, const NilmEnergyContext &requestContext, const Empty &, NilmEnergyContext &replyContext, NilmEnergyData &out) {
+            if (rawCtx.request.command() != Command::Get) {
+                throw std::invalid_argument("nilm energy: only GET is supported");
+            }
+            replyContext = requestContext;
+
+            const int64_t to   = requestContext.to == 0 ? _powerIntegrator->get_last_timestamp() : requestContext.to;
+            const int64_t from = requestContext.from == 0 ? to - DAY_NS : requestContext.from;
+            if (to <= from || requestContext.resolution < 0) {
+                throw std::invalid_argument(fmt::format("nilm energy: invalid interval [{}, {}) with resolution {}", from, to, requestContext.resolution));
+            }
+            const int64_t resolution = requestContext.resolution == 0 ? to - from : requestContext.resolution;
+            const int64_t intervals  = (to - from + resolution - 1) / resolution;
+            if (intervals > MAX_INTERVALS) {
+                throw std::invalid_argument(fmt::format("nilm energy: {} intervals requested, at most {} allowed", intervals, MAX_INTERVALS));
+            }
+
+            const auto series = _powerIntegrator->get_energy_series(from, to, resolution);
+            out.from          = from;
+            out.to            = to;
+            out.resolution    = resolution;
+            out.names         = _names;
+            out.intervalStarts.resize(series.size());
+            std::vector<double> energy;
+            energy.reserve(series.size() * _names.size());
+            for (size_t interval = 0; interval < series.size(); interval++) {
+                out.intervalStarts[interval] = from + static_cast<int64_t>(interval) * resolution;
+                energy.insert(energy.end(), series[interval].begin(), series[interval].end());
+            }
+            out.energy = opencmw::MultiArray<double, 2>(std::move(energy), { static_cast<uint32_t>(series.size()), static_cast<uint32_t>(_names.size()) });
+        });
+    }
+};
+
+#endif /* NILM_ENERGY_WORKER_H */
@@ -1,16 +1,21 @@
 #ifndef NILM_PREDICT_WORKER_H
 #define NILM_PREDICT_WORKER_H
 
+#include <IoSerialiserJson.hpp>
+#include <IoSerialiserYaS.hpp>
 #include <majordomo/Worker.hpp>
 
+#include "inference/InferenceBackend.hpp"
+#include "inference/NilmCapture.hpp"
+#include "inference/NilmPipeline.hpp"
 #include "integrator/PowerIntegrator.hpp"
-#include <cppflow/cppflow.h>
-#include <cppflow/model.h>
-#include <cppflow/ops.h>
-#include <cppflow/tensor.h>
+#include <functional>
+#include <memory>
 
 #include "FrequencyDomainWorker.hpp"
 #include "NilmDataWorker.hpp"
+#include "NilmSharedMemory.hpp"
+#include "Snapshot.hpp"
 #include "TimeDomainWorker.hpp"
 // #include "TimeDomainWorker.hpp"
 
@@ -39,9 +44,10 @@ struct NilmPredictData {
     std::vector<double>      dayUsage;
     std::vector<double>      weekUsage;
     std::vector<double>      monthUsage;
+    double                   switchLatency = 0.0; // ms from the acquisition of the last detected load change to its published prediction
 };
 
-ENABLE_REFLECTION_FOR(NilmPredictData, timestamp, values, names, dayUsage, weekUsage, monthUsage)
+ENABLE_REFLECTION_FOR(NilmPredictData, timestamp, values, names, dayUsage, weekUsage, monthUsage, switchLatency)
 
 struct PQSPhiDataSink {
     int64_t timestamp;
@@ -60,28 +66,35 @@ struct SUIDataSink {
 
 template<typename Acq>
 class DataFetcher {
-    std::string     _endpoint;
-    std::string     _signalNames;
-    int64_t         _lastTimeStamp;
-    httplib::Client _http;
-    bool            _responseOk;
+    std::string             _endpoint;
+    std::string             _signalNames;
+    int64_t                 _lastTimeStamp;
+    httplib::Client         _http;
+    bool                    _responseOk;
+    opencmw::MIME::MimeType _contentType;
+    std::string             _extraParameters; // appended to the query, e.g. "&consumer=name&waitMs=100"
 
 public:
     DataFetcher() = delete;
-    DataFetcher(const std::string &endPoint, const std::string &signalNames = "")
-        : _endpoint(endPoint), _signalNames(signalNames), _lastTimeStamp(0), _http("localhost", DEFAULT_REST_PORT), _responseOk(false) {
+    DataFetcher(const std::string &endPoint, const std::string &signalNames = "", opencmw::MIME::MimeType contentType = opencmw::MIME::BINARY, const std::string &extraParameters = "")
+        : _endpoint(endPoint), _signalNames(signalNames), _lastTimeStamp(0), _http("localhost", DEFAULT_REST_PORT), _responseOk(false), _contentType(contentType), _extraParameters(extraParameters) {
         _http.set_keep_alive(true);
     }
     ~DataFetcher() {}
     httplib::Result get(Acq &data) {
-        std::string getPath = fmt::format("{}?channelNameFilter={}&lastRefTrigger={}", _endpoint, _signalNames, _lastTimeStamp);
+        std::string getPath = fmt::format("{}?channelNameFilter={}&lastRefTrigger={}&contentType={}{}", _endpoint, _signalNames, _lastTimeStamp, _contentType.typeName(), _extraParameters);
         // fmt::print("{}: path: {}\n", typeid(data).name(), getPath);
         auto response = _http.Get(getPath.data());
         if (response.error() == httplib::Error::Success && response->status == 200) {
             _responseOk = true;
             opencmw::IoBuffer buffer;
             buffer.put<opencmw::IoBuffer::MetaInfo::WITHOUT>(response->body);
-            auto result = opencmw::deserialise<opencmw::Json, opencmw::ProtocolCheck::LENIENT>(buffer, data);
+            if (_contentType == opencmw::MIME::JSON) {
+                auto result = opencmw::deserialise<opencmw::Json, opencmw::ProtocolCheck::LENIENT>(buffer, data);
+            } else {
+                // YaS binary: no float-to-text round trip for the 65k bin spectra
+                auto result = opencmw::deserialise<opencmw::YaS, opencmw::ProtocolCheck::LENIENT>(buffer, data);
+            }
         } else {
             _responseOk = false;
         }
@@ -93,6 +106,14 @@ public:
         return _responseOk;
     }
 
+    // REST long polling on the request topic, returns once the worker notifies it or after timeout
+    void waitForNotification(std::chrono::milliseconds timeout) {
+        std::string pollPath = fmt::format("{}?lastRefTrigger=0&contentType={}{}&LongPollingIdx=Next", _endpoint, _contentType.typeName(), _extraParameters);
+        _http.set_read_timeout(timeout);
+        _http.Get(pollPath.data());
+        _http.set_read_timeout(std::chrono::seconds(CPPHTTPLIB_READ_TIMEOUT_SECOND));
+    }
+
     void updateTimeStamp(Acquisition &data) {
         if (!data.channelTimeSinceRefTrigger.empty()) {
             _lastTimeStamp = data.refTriggerStamp + static_cast<int64_t>(data.channelTimeSinceRefTrigger.back() * 1e9f);
@@ -100,40 +121,55 @@ public:
     }
 };
 
+// in-process source of NILM frames, waits up to timeout for new frames, appends all pending frames and returns their number
+using NilmFrameSource = std::function<size_t(AcquisitionNilm &, std::chrono::milliseconds)>;
+
 using namespace opencmw::disruptor;
 using namespace opencmw::majordomo;
 template<units::basic_fixed_string serviceName, typename... Meta>
 class NilmPredictWorker : public Worker<serviceName, NilmContext, Empty, NilmPredictData, Meta...> {
-    const std::string                MODEL_PATH{ "src/model/nilm_model" };
-    cppflow::model                   _model{ MODEL_PATH };
-
-    DataFetcher<AcquisitionNilm>     _acquisitionNilmFetcher{ "pulsed_power_nilm" };
-    DataFetcher<Acquisition>         _dataFetcherAcq        = DataFetcher<Acquisition>("pulsed_power/Acquisition", "P@100Hz,Q@100Hz,S@100Hz,phi@100Hz");
-    DataFetcher<AcquisitionSpectra>  _dataFetcherAcqSpectra = DataFetcher<AcquisitionSpectra>("pulsed_power_freq/AcquisitionSpectra", "S@200000Hz");
-
-    std::atomic<bool>                _shutdownRequested;
-    std::jthread                     _predictThread;
-    std::jthread                     _fetchThread;
-    NilmPredictData                  _nilmData;
-    std::shared_ptr<PowerIntegrator> _powerIntegrator = std::make_shared<PowerIntegrator>(_nilmData.names.size(), "./src/data/", 1);
-
-    std::shared_ptr<SUIDataSink>     _suiDataSink     = std::make_shared<SUIDataSink>();
-    std::shared_ptr<PQSPhiDataSink>  _pqsphiDataSink  = std::make_shared<PQSPhiDataSink>();
-
-    Mode                             _mode            = Mode::Normal;
-    std::ofstream                    _dataPointFile;
-    std::string                      _dataPointCapturePath{ "./capturedDataPoint.bin" }; // default file name
+    static constexpr float                NILM_SAMPLE_RATE    = 2'000'000.0f; // digitizer rate of the NILM flowgraph, stored in captures
+    static constexpr auto                 WAIT_TIMEOUT        = std::chrono::milliseconds(100); // upper bound of a wait for new frames, keeps shutdown responsive
+    static constexpr auto                 REST_RETRY_INTERVAL = std::chrono::milliseconds(500); // after a failed request
+    static constexpr auto                 USAGE_INTERVAL      = std::chrono::seconds(1);          // day/week/month usage refresh for GET, other intervals are served by NilmEnergyWorker
+    NilmPipeline                          _pipeline;
+
+    // long-polls with its own server-side cursor
+    DataFetcher<AcquisitionNilm>          _acquisitionNilmFetcher{ "pulsed_power_nilm", "", opencmw::MIME::BINARY, fmt::format("&consumer=nilm_predict_{}&waitMs={}", getpid(), WAIT_TIMEOUT.count()) };
+    nilm_shm::Reader                      _sharedMemoryReader;
+    NilmFrameSource                       _frameSource;
+    DataFetcher<Acquisition>              _dataFetcherAcq        = DataFetcher<Acquisition>("pulsed_power/Acquisition", "P@100Hz,Q@100Hz,S@100Hz,phi@100Hz");
+    DataFetcher<AcquisitionSpectra>       _dataFetcherAcqSpectra = DataFetcher<AcquisitionSpectra>("pulsed_power_freq/AcquisitionSpectra", "S@200000Hz");
+
+    std::atomic<bool>                     _shutdownRequested;
+    std::jthread                          _predictThread;
+    std::jthread                          _fetchThread;
+    NilmPredictData                       _nilmData;  // built by the predict thread only
+    Snapshot<NilmPredictData>             _published;  // last published _nilmData for GET
+    NilmPredictData                       _notifyData; // current values only, reused for every notify
+    std::chrono::steady_clock::time_point _lastUsageRefresh;
+    std::shared_ptr<PowerIntegrator>      _powerIntegrator = std::make_shared<PowerIntegrator>(_nilmData.names.size(), "./src/data/", 16 * 3600); // checkpoint about once an hour
+
+    std::shared_ptr<SUIDataSink>          _suiDataSink     = std::make_shared<SUIDataSink>();
+    std::shared_ptr<PQSPhiDataSink>       _pqsphiDataSink  = std::make_shared<PQSPhiDataSink>();
+
+    // reused across predict cycles
+    AcquisitionNilm                       _acquisitionNilm;
+    std::vector<float>                    _frameInput;
+    std::vector<float>                    _frameValues;
+
+    Mode                                  _mode            = Mode::Normal;
+    std::unique_ptr<nilm_capture::Writer> _captureWriter; // created with the first frame, once the vector size is known
+    std::string                           _dataPointCapturePath{ "./capturedDataPoint.bin" }; // default file name
 
 public:
     using super_t = Worker<serviceName, NilmContext, Empty, NilmPredictData, Meta...>;
 
     template<typename BrokerType>
-    explicit NilmPredictWorker(const BrokerType &broker, std::chrono::milliseconds updateInterval, Mode mode, std::string fileName)
-        : super_t(broker, {}), _mode(mode), _dataPointCapturePath(fileName) {
-        if (_mode == Mode::Write) {
-            _dataPointFile.open(_dataPointCapturePath.c_str(), std::ios::binary);
-        }
-
+    explicit NilmPredictWorker(const BrokerType &broker, std::chrono::milliseconds minInterval, Mode mode, std::string fileName, std::unique_ptr<InferenceBackend> backend, NilmFrameSource frameSource = {})
+        : super_t(broker, {}), _pipeline(std::move(backend)), _frameSource(std::move(frameSource)), _mode(mode), _dataPointCapturePath(fileName) {
+        fmt::print("NILM inference backend: {}\n", _pipeline.backend().name());
+        _notifyData.names = _nilmData.names;
         /*_fetchThread     = std::jthread([this] {
             std::chrono::duration<double, std::milli> fetchDuration;
             while (!_shutdownRequested) {
@@ -174,118 +210,174 @@ public:
             }
             });*/
 
-        _predictThread = std::jthread([this, updateInterval, mode] {
+        _predictThread = std::jthread([this, minInterval, mode] {
             std::chrono::duration<double, std::milli> predictDuration;
             while (!_shutdownRequested) {
                 std::chrono::time_point timeStart = std::chrono::system_clock::now();
 
                 NilmContext             context;
-                std::vector<float>      dataPoint;
-
-                AcquisitionNilm         acquisitionNilm;
+                AcquisitionNilm        &acquisitionNilm = _acquisitionNilm;
+                clearAcquisition(acquisitionNilm);
 
                 try {
                     _nilmData.timestamp = std::time(nullptr);
 
-                    // fetch AcquisitionNilm from PulsedPowerService
-                    auto response = _acquisitionNilmFetcher.get(acquisitionNilm);
+                    const bool received = fetchFrames(acquisitionNilm);
 
-                    if (_acquisitionNilmFetcher.responseOk()) {
+                    if (received) {
                         assert(!acquisitionNilm.apparentPowerSpectrumStridedValues.empty());
                         size_t fftSize = acquisitionNilm.apparentPowerSpectrumStridedValues.size() / acquisitionNilm.apparentPower.size();
-                        fmt::print("acquisitionNilm received, chunks no: {},  fftsize: {}, size of data: {}\n", acquisitionNilm.apparentPower.size(), fftSize, response->body.size());
-                        for (size_t i = 0; i < acquisitionNilm.realPower.size(); i++) {
-                            mergeValues(acquisitionNilm, i, fftSize, dataPoint);
+                        fmt::print("acquisitionNilm received, chunks no: {},  fftsize: {}, shared memory: {}, switch events: {}, frames classified: {}/{}\n", acquisitionNilm.apparentPower.size(), fftSize, _sharedMemoryReader.connected(),
+                                _pipeline.switchDetector().events(), _pipeline.switchDetector().activeFrames(), _pipeline.switchDetector().frames());
+
+                        // the exported model takes a single rank-1 data point and keeps a rolling window of past frames,
+                        // so the pending frames are run in order, merged into a reused input buffer
+                        const size_t frames   = acquisitionNilm.realPower.size();
+                        const size_t features = NilmPipeline::featureCount(fftSize);
+                        _frameInput.resize(features);
+                        for (size_t i = 0; i < frames; i++) {
+                            mergeValues(acquisitionNilm, i, fftSize, _frameInput.data());
 
                             // write to a file
                             if (_mode == Mode::Write) {
-                                _dataPointFile.write(reinterpret_cast<char *>(dataPoint.data()), dataPoint.size() * sizeof(float));
+                                if (!_captureWriter) {
+                                    _captureWriter = std::make_unique<nilm_capture::Writer>(_dataPointCapturePath, static_cast<uint32_t>(fftSize), NILM_SAMPLE_RATE, _pipeline.backend().name(), true);
+                                }
+                                _captureWriter->write(acquisitionNilm.refTriggerStamp[i], _frameInput);
                             }
 
-                            int64_t         size = static_cast<int64_t>(dataPoint.size());
-                            cppflow::tensor input(dataPoint, { size });
-
-                            auto            output = _model({ { "serving_default_args_0:0", input } }, { "StatefulPartitionedCall:0" });
-
-                            auto            values = output[0].get_data<float>();
-
-                            // values print
-                            fmt::print("input:  {}\n", input);
-                            fmt::print("output: {}\n", output[0]);
-                            fmt::print("output data: {}\n", values);
+                            // classify only around load changes, in steady state the previous disaggregation is held
+                            const uint64_t events = _pipeline.switchDetector().events();
+                            _pipeline.process(_frameInput, _frameValues);
 
                             // fill data for REST
-                            _nilmData.values.clear();
-                            for (auto v : values) {
-                                _nilmData.values.push_back(static_cast<double>(v));
+                            _nilmData.values.assign(_frameValues.begin(), _frameValues.end());
+                            _powerIntegrator->update(acquisitionNilm.refTriggerStamp[i], _frameValues);
+
+                            // acquisition of the frame with a load change until its prediction is published, carried by that snapshot
+                            const bool switchEvent = _pipeline.switchDetector().events() != events;
+                            if (switchEvent) {
+                                const int64_t now       = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+                                _nilmData.switchLatency = static_cast<double>(now - acquisitionNilm.refTriggerStamp[i]) * 1e-6;
                             }
-                            _powerIntegrator->update(acquisitionNilm.refTriggerStamp[i], values);
 
-                            super_t::notify("/nilmPredictData", context, _nilmData);
+                            _published.publish(_nilmData);
+                            _notifyData.timestamp     = _nilmData.timestamp;
+                            _notifyData.switchLatency = _nilmData.switchLatency;
+                            _notifyData.values        = _nilmData.values;
+                            super_t::notify("/nilmPredictData", context, _notifyData);
+                            if (switchEvent) {
+                                fmt::print("switch event, acquisition to dashboard latency: {:.1f} ms\n", _nilmData.switchLatency);
+                            }
                         }
                     }
 
-                    fillDayUsage();
-                    fillWeekUsage();
-                    fillMonthUsage();
+                    if (std::chrono::steady_clock::now() - _lastUsageRefresh >= USAGE_INTERVAL) {
+                        _lastUsageRefresh = std::chrono::steady_clock::now();
+                        fillDayUsage();
+                        fillWeekUsage();
+                        fillMonthUsage();
+                        _published.publish(_nilmData);
+                    }
 
                 } catch (const std::exception &ex) {
                     fmt::print("caught exception '{}'\n", ex.what());
                 }
 
+                // caps the CPU use, frames arriving meanwhile are handled together in the next cycle
                 predictDuration   = std::chrono::system_clock::now() - timeStart;
-
-                auto willSleepFor = updateInterval - predictDuration;
-
+                auto willSleepFor = minInterval - predictDuration;
                 if (willSleepFor > 0ms) {
                     std::this_thread::sleep_for(willSleepFor);
-                } else {
-                    fmt::print("Data prediction too slow\n");
                 }
             }
         });
 
-        super_t::setCallback([this](RequestContext &rawCtx, const NilmContext &, const Empty &, NilmContext &, NilmPredictData &out) {
+        super_t::setCallback([this](RequestContext &rawCtx, const NilmContext &requestContext, const Empty &, NilmContext &replyContext, NilmPredictData &out) {
+            replyContext.contentType = requestContext.contentType;
             if (rawCtx.request.command() == Command::Get) {
-                out = _nilmData;
+                out = *_published.load(); // copied on the worker thread, the predict thread publishes the next snapshot meanwhile
             }
         });
     }
 
+    // integrated usage of the predictions, shared with NilmEnergyWorker
+    std::shared_ptr<PowerIntegrator> powerIntegrator() const {
+        return _powerIntegrator;
+    }
+
+    const std::vector<std::string> &deviceNames() const {
+        return _notifyData.names;
+    }
+
+    // classify every frame instead of only those around detected load changes
+    void setSwitchDetection(bool enabled) {
+        _pipeline.setSwitchDetection(enabled);
+    }
+
     ~NilmPredictWorker() {
-        if (_mode == Mode::Write) {
-            _dataPointFile.close();
-        }
         _shutdownRequested = true;
         _predictThread.join();
+        if (_captureWriter) {
+            _captureWriter->close();
+        }
         //_fetchThread.join();
     }
 
 private:
-    void mergeValues(const AcquisitionNilm &acqNilmData, size_t i, size_t vectorSize, std::vector<float> &output) {
+    // waits up to WAIT_TIMEOUT for new frames on any of the sources
+    bool fetchFrames(AcquisitionNilm &acquisitionNilm) {
+        if (_frameSource) {
+            return _frameSource(acquisitionNilm, WAIT_TIMEOUT) > 0;
+        }
+        if (_sharedMemoryReader.attach()) {
+            _sharedMemoryReader.waitForFrames(WAIT_TIMEOUT);
+            return _sharedMemoryReader.read(acquisitionNilm) > 0;
+        }
+        _acquisitionNilmFetcher.get(acquisitionNilm);
+        if (!_acquisitionNilmFetcher.responseOk()) {
+            std::this_thread::sleep_for(REST_RETRY_INTERVAL);
+            return false;
+        }
+        if (acquisitionNilm.refTriggerStamp.empty()) {
+            // the request has been parked, the worker notifies its topic when frames arrive
+            _acquisitionNilmFetcher.waitForNotification(WAIT_TIMEOUT);
+            return false;
+        }
+        return true;
+    }
+
+    static void clearAcquisition(AcquisitionNilm &acquisition) {
+        acquisition.refTriggerStamp.clear();
+        acquisition.apparentPowerSpectrumStridedValues.clear();
+        acquisition.realPower.clear();
+        acquisition.reactivePower.clear();
+        acquisition.apparentPower.clear();
+        acquisition.phi.clear();
+    }
+
+    // writes the NilmPipeline::featureCount(vectorSize) features of frame i to output
+    void mergeValues(const AcquisitionNilm &acqNilmData, size_t i, size_t vectorSize, float *output) {
         // model requires only first half of the spectrum (2^16)
         size_t fftNilmSize = vectorSize / 2;
-        output.clear();
-        output.reserve(3 * fftNilmSize + 4);
         // voltage spectrum
-        output.insert(output.end(), fftNilmSize, 0.0f);
+        output = std::fill_n(output, fftNilmSize, 0.0f);
 
         // current spectrum
-        output.insert(output.end(), fftNilmSize, 0.0f);
+        output = std::fill_n(output, fftNilmSize, 0.0f);
 
         // apparent power spectrum
         if (acqNilmData.apparentPowerSpectrumStridedValues.empty()) {
-            output.insert(output.end(), fftNilmSize, 0.0f);
+            output = std::fill_n(output, fftNilmSize, 0.0f);
         } else {
-            int64_t offset = static_cast<int64_t>(i * vectorSize);
-            output.insert(output.end(), acqNilmData.apparentPowerSpectrumStridedValues.begin() + offset, acqNilmData.apparentPowerSpectrumStridedValues.begin() + offset + static_cast<int64_t>(fftNilmSize));
+            output = std::copy_n(acqNilmData.apparentPowerSpectrumStridedValues.begin() + static_cast<int64_t>(i * vectorSize), fftNilmSize, output);
         }
 
         // P Q S phi
-        output.push_back(acqNilmData.realPower[i]);
-        output.push_back(acqNilmData.reactivePower[i]);
-        output.push_back(acqNilmData.apparentPower[i]);
-        output.push_back(acqNilmData.phi[i]);
+        *output++ = acqNilmData.realPower[i];
+        *output++ = acqNilmData.reactivePower[i];
+        *output++ = acqNilmData.apparentPower[i];
+        *output   = acqNilmData.phi[i];
     }
 
     void fillDayUsage() {
@@ -0,0 +1,284 @@
+#ifndef NILM_SHARED_MEMORY_H
+#define NILM_SHARED_MEMORY_H
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+
+/*
+ * POSIX shared-memory ring carrying the NILM feature frames from the
+ * NilmDataWorker (single producer) to NilmPredictWorker instances on the same
+ * host. Frames are copied once into a slot and once out of it.
+ *
+ * Layout: Header | slot 0 | slot 1 | ... where every slot is a SlotHeader
+ * followed by spectrumSize floats. The producer marks a slot as being written
+ * (sequence -1), fills it and stores its sequence before advancing the cursor.
+ * Readers re-check the slot sequence after copying to detect frames overwritten
+ * meanwhile, there is no back-pressure on the producer. Readers waiting for
+ * data sleep on a process-shared futex which the producer wakes per frame.
+ */
+namespace nilm_shm {
+
+constexpr uint32_t    MAGIC         = 0x4e494c4d; // "NILM"
+constexpr uint32_t    VERSION       = 2;
+constexpr const char *DEFAULT_NAME  = "/pulsed_power_nilm";
+constexpr uint32_t    DEFAULT_SLOTS = 32;
+
+struct Header {
+    uint32_t              magic;
+    uint32_t              version;
+    uint32_t              slots;
+    uint32_t              spectrumSize;
+    std::atomic<int64_t>  cursor;        // last published sequence, -1: none
+    std::atomic<bool>     producerAlive; // cleared when the producer shuts down
+    std::atomic<uint32_t> published;     // futex word, incremented with every frame and on shutdown
+};
+
+struct SlotHeader {
+    std::atomic<int64_t> sequence; // sequence of the frame held, -1 while being written
+    int64_t              timestamp;
+    float                realPower;     // P
+    float                reactivePower; // Q
+    float                apparentPower; // S
+    float                phi;
+};
+
+static_assert(std::atomic<int64_t>::is_always_lock_free, "shared-memory sequences need address-free atomics");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32 bit integer");
+
+// not FUTEX_PRIVATE_FLAG, waiter and waker are different processes
+inline void futexWake(std::atomic<uint32_t> &word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+inline void futexWait(const std::atomic<uint32_t> &word, uint32_t expected, std::chrono::nanoseconds timeout) {
+    const timespec relative{ static_cast<time_t>(timeout.count() / 1'000'000'000), static_cast<long>(timeout.count() % 1'000'000'000) };
+    syscall(SYS_futex, reinterpret_cast<const uint32_t *>(&word), FUTEX_WAIT, expected, &relative, nullptr, 0);
+}
+
+inline size_t slotBytes(uint32_t spectrumSize) {
+    return (sizeof(SlotHeader) + spectrumSize * sizeof(float) + alignof(SlotHeader) - 1) / alignof(SlotHeader) * alignof(SlotHeader);
+}
+
+inline size_t mappingBytes(uint32_t slots, uint32_t spectrumSize) {
+    return (sizeof(Header) + alignof(SlotHeader) - 1) / alignof(SlotHeader) * alignof(SlotHeader) + slots * slotBytes(spectrumSize);
+}
+
+inline SlotHeader *slotAt(void *mapping, uint32_t slot, uint32_t spectrumSize) {
+    auto *base = static_cast<char *>(mapping) + mappingBytes(0, spectrumSize);
+    return reinterpret_cast<SlotHeader *>(base + slot * slotBytes(spectrumSize));
+}
+
+inline const SlotHeader *slotAt(const void *mapping, uint32_t slot, uint32_t spectrumSize) {
+    const auto *base = static_cast<const char *>(mapping) + mappingBytes(0, spectrumSize);
+    return reinterpret_cast<const SlotHeader *>(base + slot * slotBytes(spectrumSize));
+}
+
+inline float *spectrumOf(SlotHeader *slot) {
+    return reinterpret_cast<float *>(slot + 1);
+}
+
+inline const float *spectrumOf(const SlotHeader *slot) {
+    return reinterpret_cast<const float *>(slot + 1);
+}
+
+class Writer {
+    std::string _name;
+    void       *_mapping  = MAP_FAILED;
+    size_t      _bytes    = 0;
+    Header     *_header   = nullptr;
+    int64_t     _sequence = -1;
+
+public:
+    Writer(uint32_t spectrumSize, std::string name = DEFAULT_NAME, uint32_t slots = DEFAULT_SLOTS)
+        : _name(std::move(name)), _bytes(mappingBytes(slots, spectrumSize)) {
+        // readers still attached to a previous object keep their mapping and see producerAlive == false
+        shm_unlink(_name.c_str());
+        const int fd = shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0) {
+            return;
+        }
+        if (ftruncate(fd, static_cast<off_t>(_bytes)) == 0) {
+            _mapping = mmap(nullptr, _bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (_mapping == MAP_FAILED) {
+            shm_unlink(_name.c_str());
+            return;
+        }
+        _header         = new (_mapping) Header{ MAGIC, VERSION, slots, spectrumSize, {}, {}, {} };
+        _header->cursor = -1;
+        for (uint32_t i = 0; i < slots; i++) {
+            new (slotAt(_mapping, i, spectrumSize)) SlotHeader{ {}, 0, 0.0f, 0.0f, 0.0f, 0.0f };
+            slotAt(_mapping, i, spectrumSize)->sequence = -1;
+        }
+        _header->producerAlive = true;
+    }
+
+    Writer(const Writer &)            = delete;
+    Writer &operator=(const Writer &) = delete;
+
+    ~Writer() {
+        if (_header != nullptr) {
+            _header->producerAlive = false;
+            _header->published.fetch_add(1, std::memory_order_release);
+            futexWake(_header->published);
+            munmap(_mapping, _bytes);
+            shm_unlink(_name.c_str());
+        }
+    }
+
+    bool isOpen() const {
+        return _header != nullptr;
+    }
+
+    void publish(const float *spectrum, size_t spectrumSize, int64_t timestamp, float realPower, float reactivePower, float apparentPower, float phi) {
+        if (_header == nullptr) {
+            return;
+        }
+        const int64_t sequence = ++_sequence;
+        SlotHeader   *slot     = slotAt(_mapping, static_cast<uint32_t>(sequence % _header->slots), _header->spectrumSize);
+        slot->sequence.store(-1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot->timestamp     = timestamp;
+        slot->realPower     = realPower;
+        slot->reactivePower = reactivePower;
+        slot->apparentPower = apparentPower;
+        slot->phi           = phi;
+        const size_t values = std::min<size_t>(spectrumSize, _header->spectrumSize);
+        std::memcpy(spectrumOf(slot), spectrum, values * sizeof(float));
+        std::fill(spectrumOf(slot) + values, spectrumOf(slot) + _header->spectrumSize, 0.0f);
+        slot->sequence.store(sequence, std::memory_order_release);
+        _header->cursor.store(sequence, std::memory_order_release);
+        _header->published.fetch_add(1, std::memory_order_release);
+        futexWake(_header->published);
+    }
+};
+
+class Reader {
+    std::string   _name;
+    void         *_mapping      = MAP_FAILED;
+    size_t        _bytes        = 0;
+    const Header *_header       = nullptr;
+    int64_t       _nextSequence = 0;
+
+public:
+    explicit Reader(std::string name = DEFAULT_NAME)
+        : _name(std::move(name)) {}
+
+    Reader(const Reader &)            = delete;
+    Reader &operator=(const Reader &) = delete;
+
+    ~Reader() {
+        detach();
+    }
+
+    // attaches to a live producer, returns false if there is none on this host
+    bool attach() {
+        if (connected()) {
+            return true;
+        }
+        detach();
+        const int fd = shm_open(_name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info {};
+        if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(Header)) {
+            _bytes   = static_cast<size_t>(info.st_size);
+            _mapping = mmap(nullptr, _bytes, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (_mapping == MAP_FAILED) {
+            return false;
+        }
+        const auto *header = static_cast<const Header *>(_mapping);
+        if (header->magic != MAGIC || header->version != VERSION || _bytes < mappingBytes(header->slots, header->spectrumSize)) {
+            detach();
+            return false;
+        }
+        _header       = header;
+        _nextSequence = _header->cursor.load(std::memory_order_acquire) + 1; // start with the next frame
+        return connected();
+    }
+
+    void detach() {
+        if (_mapping != MAP_FAILED) {
+            munmap(_mapping, _bytes);
+        }
+        _mapping = MAP_FAILED;
+        _header  = nullptr;
+    }
+
+    bool connected() const {
+        return _header != nullptr && _header->producerAlive.load(std::memory_order_acquire);
+    }
+
+    // blocks up to timeout until a frame not read yet is available, returns false on timeout or without producer
+    bool waitForFrames(std::chrono::nanoseconds timeout) const {
+        if (!connected()) {
+            return false;
+        }
+        const uint32_t published = _header->published.load(std::memory_order_acquire);
+        if (_header->cursor.load(std::memory_order_acquire) >= _nextSequence) {
+            return true;
+        }
+        futexWait(_header->published, published, timeout);
+        return connected() && _header->cursor.load(std::memory_order_acquire) >= _nextSequence;
+    }
+
+    // appends all frames published since the last call to out (fields as in AcquisitionNilm), returns the number of frames
+    template<typename Acq>
+    size_t read(Acq &out) {
+        if (!connected()) {
+            return 0;
+        }
+        const int64_t  cursor       = _header->cursor.load(std::memory_order_acquire);
+        const uint32_t spectrumSize = _header->spectrumSize;
+        // frames older than one ring length have been overwritten
+        _nextSequence               = std::max(_nextSequence, cursor - static_cast<int64_t>(_header->slots) + 1);
+        size_t frames               = 0;
+        for (; _nextSequence <= cursor; _nextSequence++) {
+            const SlotHeader *slot = slotAt(static_cast<const void *>(_mapping), static_cast<uint32_t>(_nextSequence % _header->slots), spectrumSize);
+            if (slot->sequence.load(std::memory_order_acquire) != _nextSequence) {
+                continue;
+            }
+            const size_t offset = out.apparentPowerSpectrumStridedValues.size();
+            out.apparentPowerSpectrumStridedValues.resize(offset + spectrumSize);
+            std::memcpy(out.apparentPowerSpectrumStridedValues.data() + offset, spectrumOf(slot), spectrumSize * sizeof(float));
+            const int64_t timestamp     = slot->timestamp;
+            const float   realPower     = slot->realPower;
+            const float   reactivePower = slot->reactivePower;
+            const float   apparentPower = slot->apparentPower;
+            const float   phi           = slot->phi;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot->sequence.load(std::memory_order_relaxed) != _nextSequence) {
+                out.apparentPowerSpectrumStridedValues.resize(offset); // overwritten while copying
+                continue;
+            }
+            out.refTriggerStamp.push_back(timestamp);
+            out.realPower.push_back(realPower);
+            out.reactivePower.push_back(reactivePower);
+            out.apparentPower.push_back(apparentPower);
+            out.phi.push_back(phi);
+            frames++;
+        }
+        return frames;
+    }
+};
+
+} // namespace nilm_shm
+
+#endif /* NILM_SHARED_MEMORY_H */
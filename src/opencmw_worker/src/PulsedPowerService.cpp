@@ -4,14 +4,22 @@
 
 #include <atomic>
 #include <fstream>
+#include <getopt.h>
 #include <iomanip>
+#include <memory>
+#include <optional>
 #include <thread>
 
+#include "FlowgraphPerformanceWorker.hpp"
 #include "FrequencyDomainWorker.hpp"
 #include "GRFlowGraphs.hpp"
 #include "LimitingCurveWorker.hpp"
 #include "NilmDataWorker.hpp"
+#include "NilmEnergyWorker.hpp"
+#include "NilmPredictWorker.hpp"
+#include "SpectrogramWorker.hpp"
 #include "TimeDomainWorker.hpp"
+#include "inference/BackendFactory.hpp"
 
 using namespace opencmw::majordomo;
 
@@ -76,7 +84,84 @@ public:
     }
 };
 
-int main() {
+int main(int argc, char *argv[]) {
+    int                      opt;
+    bool                     inProcessInference = false;
+    bool                     dryRun             = false;
+    std::vector<std::string> configFiles;        // one per device, none: built-in defaults, a picoscope at 2 MS/s
+    std::string              guptaParameterFile; // native NILM backend for -i, TensorFlow if empty
+    const char              *shortOptions  = "ic:g:dh";
+    static struct option     longOptions[] = {
+        { "in-process-inference", no_argument, 0, 'i' },
+        { "gupta-params", required_argument, 0, 'g' },
+        { "config", required_argument, 0, 'c' },
+        { "dry-run", no_argument, 0, 'd' },
+        { "help", no_argument, 0, 'h' },
+        { 0, 0, 0, 0 }
+    };
+
+    int optionIndex = 0;
+
+    while ((opt = getopt_long(argc, argv, shortOptions, longOptions, &optionIndex)) != -1) {
+        switch (opt) {
+        case 'i':
+            inProcessInference = true;
+            break;
+        case 'c':
+            configFiles.emplace_back(optarg);
+            break;
+        case 'g':
+            guptaParameterFile = optarg;
+            break;
+        case 'd':
+            dryRun = true;
+            break;
+        case 'h':
+            fmt::print("Usage: {} [-i [-g <file>]] [-c <file>]... [-d] [-h]\n", argv[0]);
+            fmt::print("Options:\n");
+            fmt::print("  -i, --in-process-inference    Run the NILM inference (nilm_predict_values) inside this service instead of InferenceTool\n");
+            fmt::print("  -g, --gupta-params <file>     Run the in-process inference with the native Gupta classifier instead of TensorFlow\n");
+            fmt::print("  -c, --config <file>           Flowgraph configuration (JSON), see FlowgraphConfig.hpp, repeated for several devices\n");
+            fmt::print("  -d, --dry-run                 Validate the configuration, print the sample rate of each block and exit\n");
+            fmt::print("  -h, --help                    Display this help message\n");
+            return 1;
+            break;
+        default:
+            fmt::print(std::cerr, "Invalid command line option\n");
+            return 1;
+            break;
+        }
+    }
+
+    std::vector<FlowgraphConfig> flowgraphConfigs;
+    try {
+        flowgraphConfigs = loadFlowgraphConfigs(configFiles);
+    } catch (const std::invalid_argument &e) {
+        fmt::print(std::cerr, "{}\n", e.what());
+        return 1;
+    }
+    if (dryRun) {
+        fmt::print("flowgraph configuration {} is valid\n", configFiles.empty() ? "(built-in defaults)" : fmt::format("{}", fmt::join(configFiles, ", ")));
+        for (const auto &flowgraphConfig : flowgraphConfigs) {
+            if (!flowgraphConfig.source.name.empty()) {
+                fmt::print("\ndevice '{}'\n", flowgraphConfig.source.name);
+            }
+            printFlowgraphRates(flowgraphConfig);
+        }
+        return 0;
+    }
+
+    // created up front, a build without TensorFlow needs the native backend (-g)
+    std::unique_ptr<InferenceBackend> inferenceBackend;
+    if (inProcessInference) {
+        try {
+            inferenceBackend = createInferenceBackend(guptaParameterFile);
+        } catch (const std::exception &e) {
+            fmt::print(std::cerr, "No inference backend: {}\n", e.what());
+            return 1;
+        }
+    }
+
     Broker                                          broker("Pulsed-Power-Broker");
     auto                                            fs          = cmrc::assets::get_filesystem();
     const std::string_view                          REST_SCHEME = "https";
@@ -94,24 +179,70 @@ int main() {
 
     std::jthread brokerThread([&broker] { broker.run(); });
 
-    // flowgraph setup
-    bool                 use_picoscope = true;
-    bool                 add_noise     = true; // adds noise on simulated data - has no effect on picoscope data
-
-    PulsedPowerFlowgraph flowgraph(256, use_picoscope, add_noise);
-    flowgraph.start();
+    // flowgraph setup, one per device, the sinks of a named device are published as <name>/<signal>
+    std::vector<std::unique_ptr<PulsedPowerFlowgraph>> flowgraphs;
+    for (const auto &flowgraphConfig : flowgraphConfigs) {
+        flowgraphs.push_back(std::make_unique<PulsedPowerFlowgraph>(flowgraphConfig));
+        flowgraphs.back()->print_placement(flowgraphConfig.placement);
+    }
+    for (const auto &flowgraph : flowgraphs) {
+        flowgraph->start();
+    }
 
     // OpenCMW workers
     TimeDomainWorker<"pulsed_power/Acquisition", description<"Time-Domain Worker">>                       timeDomainWorker(broker);
     FrequencyDomainWorker<"pulsed_power_freq/AcquisitionSpectra", description<"Frequency-Domain Worker">> freqDomainWorker(broker);
     LimitingCurveWorker<"limiting_curve", description<"Limiting curve worker">>                           limitingCurveWorker(broker);
-    NilmDataWorker<"pulsed_power_nilm", description<"Nilm Data Worker">>                                  nilmDataWorker(broker);
+    NilmDataWorker<"pulsed_power_nilm", description<"Nilm Data Worker">>                                  nilmDataWorker(broker, !inProcessInference, flowgraphConfigs.front().signalPrefix(), flowgraphConfigs.front().rates.shortTerm); // NILM of the first device
+    SpectrogramWorker<"pulsed_power_spectrogram/Spectrogram", description<"Spectrogram Worker">>          spectrogramWorker(broker);
 
     // run workers in separate threads
     std::jthread timeSinkWorkerThread([&timeDomainWorker] { timeDomainWorker.run(); });
     std::jthread freqSinkWorkerThread([&freqDomainWorker] { freqDomainWorker.run(); });
     std::jthread limitingCurveWorkerThread([&limitingCurveWorker] { limitingCurveWorker.run(); });
     std::jthread nilmDataWorkerThread([&nilmDataWorker] { nilmDataWorker.run(); });
+    std::jthread spectrogramWorkerThread([&spectrogramWorker] { spectrogramWorker.run(); });
+
+    // in-process inference: NilmPredictWorker reads NilmDataWorker's ring buffer through its own consumer sequence,
+    // its service is also served on the InferenceTool REST port so dashboards keep working unchanged
+    using NilmPredictWorkerType = NilmPredictWorker<"nilm_predict_values", description<"Nilm Predicted Data">>;
+    using NilmEnergyWorkerType  = NilmEnergyWorker<"nilm_energy", description<"Nilm Energy per Interval">>;
+    std::unique_ptr<NilmPredictWorkerType>                         nilmPredictWorker;
+    std::unique_ptr<NilmEnergyWorkerType>                          nilmEnergyWorker;
+    std::optional<FileServerRestBackend<PLAIN_HTTP, decltype(fs)>> inferenceRest;
+    std::jthread                                                   nilmPredictWorkerThread;
+    std::jthread                                                   nilmEnergyWorkerThread;
+    if (inProcessInference) {
+        inferenceRest.emplace(broker, fs, "./", opencmw::URI<>::factory().scheme(REST_SCHEME).hostName("0.0.0.0").port(8081).build());
+        auto frameSource = [&nilmDataWorker, consumer = nilmDataWorker.addConsumer()](AcquisitionNilm &out, std::chrono::milliseconds timeout) {
+            nilmDataWorker.waitForFrames(*consumer, timeout);
+            return nilmDataWorker.readFrames(*consumer, out);
+        };
+        nilmPredictWorker       = std::make_unique<NilmPredictWorkerType>(broker, std::chrono::milliseconds(20), Mode::Normal, "", std::move(inferenceBackend), frameSource);
+        nilmEnergyWorker        = std::make_unique<NilmEnergyWorkerType>(broker, nilmPredictWorker->powerIntegrator(), nilmPredictWorker->deviceNames());
+        nilmPredictWorkerThread = std::jthread([&nilmPredictWorker] { nilmPredictWorker->run(); });
+        nilmEnergyWorkerThread  = std::jthread([&nilmEnergyWorker] { nilmEnergyWorker->run(); });
+    }
+
+    // GNU Radio performance counters of every block, off with performance.publishRate = 0
+    using FlowgraphPerformanceWorkerType = FlowgraphPerformanceWorker<"flowgraph/Performance", description<"Flowgraph Performance Counters">>;
+    std::unique_ptr<FlowgraphPerformanceWorkerType> performanceWorker;
+    std::jthread                                    performanceWorkerThread;
+    if (const float publishRate = flowgraphConfigs.front().performance.publishRate; publishRate > 0.0f) {
+        const auto                                                     interval = std::chrono::milliseconds(static_cast<int64_t>(1000.0f / publishRate));
+        std::vector<gr::basic_block_sptr>                              blocks;
+        std::vector<std::shared_ptr<gr::pulsed_power::digitizer_base>> digitizers;
+        for (const auto &flowgraph : flowgraphs) {
+            blocks.insert(blocks.end(), flowgraph->get_blocks().begin(), flowgraph->get_blocks().end());
+            digitizers.insert(digitizers.end(), flowgraph->get_digitizers().begin(), flowgraph->get_digitizers().end());
+        }
+        auto replyCacheCounters = [&timeDomainWorker, &freqDomainWorker] {
+            return std::pair{ timeDomainWorker.replyCacheHits() + freqDomainWorker.replyCacheHits(), timeDomainWorker.replyCacheMisses() + freqDomainWorker.replyCacheMisses() };
+        };
+
+        performanceWorker       = std::make_unique<FlowgraphPerformanceWorkerType>(broker, blocks, std::move(digitizers), interval, replyCacheCounters);
+        performanceWorkerThread = std::jthread([&performanceWorker] { performanceWorker->run(); });
+    }
 
     brokerThread.join();
 
@@ -120,4 +251,14 @@ int main() {
     freqSinkWorkerThread.join();
     limitingCurveWorkerThread.join();
     nilmDataWorkerThread.join();
+    spectrogramWorkerThread.join();
+    if (nilmPredictWorkerThread.joinable()) {
+        nilmPredictWorkerThread.join();
+    }
+    if (nilmEnergyWorkerThread.joinable()) {
+        nilmEnergyWorkerThread.join();
+    }
+    if (performanceWorkerThread.joinable()) {
+        performanceWorkerThread.join();
+    }
 }
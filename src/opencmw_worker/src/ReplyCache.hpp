@@ -0,0 +1,137 @@
+#ifndef REPLY_CACHE_H
+#define REPLY_CACHE_H
+
+#include <IoSerialiserCmwLight.hpp>
+#include <IoSerialiserJson.hpp>
+#include <IoSerialiserYaS.hpp>
+#include <majordomo/Worker.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * Memoises encoded worker replies for identical concurrent requests.
+ *
+ * An entry is keyed by the channel filter, the ring buffer sequence range
+ * [firstSequence, endSequence) it was built from and the wire format. Requests
+ * with different but similar lastRefTrigger values resolve to the same range
+ * and share the entry. The payload is serialised once and shared read-only,
+ * a hit neither copies nor re-encodes it. As soon as the ring buffer advances,
+ * entries not ending at the current head are evicted.
+ */
+class ReplyCache {
+public:
+    using payload_t = std::shared_ptr<const std::string>;
+
+    struct Key {
+        std::string filter;
+        int64_t     firstSequence = 0;
+        int64_t     endSequence   = 0;
+        std::string contentType; // MIME type name of the payload
+
+        bool        operator==(const Key &) const = default;
+    };
+
+private:
+    struct Entry {
+        Key       key;
+        payload_t payload;
+    };
+
+    const size_t          _capacity;
+    std::vector<Entry>    _entries;
+    std::mutex            _mutex;
+    std::atomic<uint64_t> _hits   = 0;
+    std::atomic<uint64_t> _misses = 0;
+
+public:
+    explicit ReplyCache(size_t capacity = 8)
+        : _capacity(capacity) {
+        _entries.reserve(capacity);
+    }
+
+    payload_t get(const Key &key) {
+        std::scoped_lock lock(_mutex);
+        // drop replies superseded by newer ring buffer data
+        std::erase_if(_entries, [&key](const Entry &entry) { return entry.key.endSequence < key.endSequence; });
+
+        auto it = std::find_if(_entries.begin(), _entries.end(), [&key](const Entry &entry) { return entry.key == key; });
+        if (it == _entries.end()) {
+            _misses++;
+            return nullptr;
+        }
+        _hits++;
+        return it->payload;
+    }
+
+    void put(const Key &key, payload_t payload) {
+        std::scoped_lock lock(_mutex);
+        if (_entries.size() >= _capacity) {
+            _entries.erase(_entries.begin());
+        }
+        _entries.push_back({ key, std::move(payload) });
+    }
+
+    // encode() is only called on a miss and returns the serialised reply
+    template<typename Encode>
+    payload_t getOrEncode(const Key &key, Encode &&encode) {
+        if (auto payload = get(key)) {
+            return payload;
+        }
+        auto payload = std::make_shared<const std::string>(encode());
+        put(key, payload);
+        return payload;
+    }
+
+    uint64_t hits() const {
+        return _hits;
+    }
+
+    uint64_t misses() const {
+        return _misses;
+    }
+};
+
+// serialises a reply in the wire format the typed Worker would use for this content type
+template<typename Reply>
+std::string encodeReply(const opencmw::MIME::MimeType &contentType, const Reply &reply) {
+    opencmw::IoBuffer buffer;
+    if (contentType == opencmw::MIME::JSON) {
+        opencmw::serialise<opencmw::Json>(buffer, reply);
+    } else if (contentType == opencmw::MIME::CMWLIGHT) {
+        opencmw::serialise<opencmw::CmwLight>(buffer, reply);
+    } else {
+        opencmw::serialise<opencmw::YaS>(buffer, reply); // BINARY, also used without a given type
+    }
+    return std::string(buffer.asString());
+}
+
+/*
+ * Raw majordomo handler body for workers answering GETs from a ReplyCache.
+ *
+ * The typed Worker callback would serialise the reply object again for every
+ * client, here the payload returned by respond(requestContext) is written to
+ * the reply as is. Other commands get an empty Reply, as before.
+ */
+template<typename Context, typename Reply, typename Respond>
+void replyEncoded(opencmw::majordomo::RequestContext &rawCtx, Respond &&respond) {
+    using namespace opencmw;
+    const auto    topic          = URI<RELAXED>(std::string(rawCtx.request.topic()));
+    const Context requestContext = query::deserialise<Context>(topic.queryParamMap());
+
+    // the reply context equals the request context, the content type is echoed
+    rawCtx.reply.setTopic(rawCtx.request.topic(), majordomo::MessageFrame::dynamic_bytes_tag{});
+    if (rawCtx.request.command() != majordomo::Command::Get) {
+        rawCtx.reply.setBody(encodeReply(requestContext.contentType, Reply()), majordomo::MessageFrame::dynamic_bytes_tag{});
+        return;
+    }
+    const ReplyCache::payload_t payload = respond(requestContext);
+    rawCtx.reply.setBody(*payload, majordomo::MessageFrame::dynamic_bytes_tag{});
+}
+
+#endif /* REPLY_CACHE_H */
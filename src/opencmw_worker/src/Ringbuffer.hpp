@@ -4,6 +4,8 @@
 #include <boost/circular_buffer.hpp>
 #include <boost/interprocess/sync/scoped_lock.hpp>
 #include <boost/thread/mutex.hpp>
+#include <algorithm>
+#include <utility>
 #include <vector>
 
 template<typename T>
@@ -17,6 +19,7 @@ public:
     void push(T item) {
         boost::interprocess::scoped_lock<boost::mutex> lock(_mutex);
         _buffer.push_back(item);
+        _sequence++;
     }
 
     void push(std::vector<T> items) {
@@ -24,6 +27,7 @@ public:
         for (T item : items) {
             _buffer.push_back(item);
         }
+        _sequence += static_cast<int64_t>(items.size());
     }
 
     bool get_and_remove(T &item) {
@@ -64,6 +68,28 @@ public:
         }
     }
 
+    // sequence range [first, end) of the trailing items matching pred, items are assumed to be ordered
+    template<typename Predicate>
+    std::pair<int64_t, int64_t> sequence_range_if(Predicate pred) {
+        boost::interprocess::scoped_lock<boost::mutex> lock(_mutex);
+        auto                                           it = std::find_if(_buffer.begin(), _buffer.end(), pred);
+        return { _sequence - std::distance(it, _buffer.end()), _sequence };
+    }
+
+    // copies the items in the sequence range [first, end) which have not been overwritten yet
+    void get_range(int64_t first, int64_t end, std::vector<T> &result) {
+        boost::interprocess::scoped_lock<boost::mutex> lock(_mutex);
+        const int64_t                                  frontSequence = _sequence - static_cast<int64_t>(_buffer.size());
+        for (int64_t seq = std::max(first, frontSequence); seq < std::min(end, _sequence); seq++) {
+            result.push_back(_buffer[static_cast<size_t>(seq - frontSequence)]);
+        }
+    }
+
+    int64_t sequence() {
+        boost::interprocess::scoped_lock<boost::mutex> lock(_mutex);
+        return _sequence;
+    }
+
     size_t size() {
         boost::interprocess::scoped_lock<boost::mutex> lock(_mutex);
         size_t                                         size = _buffer.size();
@@ -73,6 +99,7 @@ public:
 private:
     buffer_type  _buffer;
     boost::mutex _mutex;
+    int64_t      _sequence = 0; // total number of items pushed
 };
 
 #endif /* RINGBUFFER_H */
@@ -0,0 +1,52 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <atomic>
+#include <memory>
+
+/*
+ * Single writer, many reader publication of immutable values.
+ *
+ * The writer builds a new value and swaps the pointer, readers keep the
+ * snapshot they loaded alive for as long as they use it. Readers never wait
+ * for the writer and never see a partially updated value.
+ */
+template<typename T>
+class Snapshot {
+#if defined(__cpp_lib_atomic_shared_ptr)
+    std::atomic<std::shared_ptr<const T>> _current;
+#else
+    std::shared_ptr<const T> _current; // libc++ has no std::atomic<std::shared_ptr>, accessed with std::atomic_load/store
+#endif
+
+public:
+    Snapshot()
+        : _current(std::make_shared<const T>()) {}
+
+    explicit Snapshot(T value)
+        : _current(std::make_shared<const T>(std::move(value))) {}
+
+    Snapshot(const Snapshot &)            = delete;
+    Snapshot &operator=(const Snapshot &) = delete;
+
+    // never null
+    std::shared_ptr<const T> load() const {
+#if defined(__cpp_lib_atomic_shared_ptr)
+        return _current.load(std::memory_order_acquire);
+#else
+        return std::atomic_load_explicit(&_current, std::memory_order_acquire);
+#endif
+    }
+
+    std::shared_ptr<const T> publish(T value) {
+        auto snapshot = std::make_shared<const T>(std::move(value));
+#if defined(__cpp_lib_atomic_shared_ptr)
+        _current.store(snapshot, std::memory_order_release);
+#else
+        std::atomic_store_explicit(&_current, snapshot, std::memory_order_release);
+#endif
+        return snapshot;
+    }
+};
+
+#endif /* SNAPSHOT_H */
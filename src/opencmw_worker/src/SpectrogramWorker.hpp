@@ -0,0 +1,152 @@
+#ifndef SPECTROGRAM_WORKER_H
+#define SPECTROGRAM_WORKER_H
+
+#define BOOST_BIND_NO_PLACEHOLDERS
+
+#include "SpectrumAggregator.hpp"
+#include <majordomo/Worker.hpp>
+
+#include <gnuradio/pulsed_power/opencmw_freq_sink.h>
+
+#include <unordered_map>
+
+using opencmw::Annotated;
+using opencmw::NoUnit;
+
+struct SpectrogramContext {
+    std::string             channelNameFilter;
+    std::string             mode          = "latest"; // latest, average, peakhold or waterfall
+    int32_t                 averageFrames = 1;        // frames averaged in mode 'average'
+    int32_t                 rows          = 1;        // most recent frames returned in mode 'waterfall'
+    int32_t                 bins          = 0;        // maximum number of frequency bins, 0: all stored bins
+    opencmw::MIME::MimeType contentType   = opencmw::MIME::JSON;
+};
+
+ENABLE_REFLECTION_FOR(SpectrogramContext, channelNameFilter, mode, averageFrames, rows, bins, contentType)
+
+struct Spectrogram {
+    std::string                   channelName;
+    std::string                   channelUnit;
+    std::string                   mode;
+    int64_t                       refTriggerStamp  = 0;
+    int32_t                       framesAggregated = 0;
+    opencmw::MultiArray<float, 2> values; // rows x bins
+    std::vector<int64_t>          rowTimeStamps;
+    std::vector<float>            frequencyValues;
+};
+
+ENABLE_REFLECTION_FOR(Spectrogram, channelName, channelUnit, mode, refTriggerStamp, framesAggregated, values, rowTimeStamps, frequencyValues)
+
+using namespace opencmw::majordomo;
+template<units::basic_fixed_string ServiceName, typename... Meta>
+class SpectrogramWorker
+    : public Worker<ServiceName, SpectrogramContext, Empty, Spectrogram, Meta...> {
+private:
+    const size_t HISTORY_SIZE = 256;  // frames kept for averages and waterfalls
+    const size_t MAX_BINS     = 1024; // bins stored per frame, larger spectra are decimated on arrival
+    using aggregator_t        = std::shared_ptr<SpectrumAggregator>;
+    struct SignalData {
+        aggregator_t       aggregator;
+        std::string        unit;
+        std::vector<float> frequencyValues; // frequency axis of the stored bins
+    };
+
+    std::unordered_map<std::string, SignalData> _signalsMap;    // <completeSignalName, signalData>
+    std::vector<gr::pulsed_power::subscription> _subscriptions; // the sinks stop calling into this worker when it is destroyed
+
+public:
+    using super_t = Worker<ServiceName, SpectrogramContext, Empty, Spectrogram, Meta...>;
+
+    template<typename BrokerType>
+    explicit SpectrogramWorker(const BrokerType &broker)
+        : super_t(broker, {}) {
+        for (const auto &sink : gr::pulsed_power::freq_sink_registry().sinks()) {
+            const auto   signalNames        = sink->get_signal_names();
+            const auto   sampleRate         = sink->get_sample_rate();
+            const size_t nativeBins         = sink->get_vector_size() / 2;
+            const auto   completeSignalName = gr::pulsed_power::qualified_signal_name(signalNames[0], sampleRate);
+            auto         aggregator         = std::make_shared<SpectrumAggregator>(nativeBins, MAX_BINS, HISTORY_SIZE);
+            // frequency axis of the native bins, reduced like the spectra themselves
+            std::vector<float> nativeFrequencies(nativeBins);
+            const float        freqStepValue = 0.5f * sampleRate / static_cast<float>(nativeBins);
+            for (size_t i = 0; i < nativeBins; i++) {
+                nativeFrequencies[i] = static_cast<float>(i) * freqStepValue;
+            }
+            std::vector<float> frequencyValues;
+            SpectrumAggregator::decimate(nativeFrequencies, aggregator->decimation(), false, frequencyValues);
+            _signalsMap.insert({ completeSignalName, SignalData(aggregator, sink->get_signal_units()[0], std::move(frequencyValues)) });
+            fmt::print("GR: OpenCMW Spectrogram '{}' added ({} bins stored)\n", completeSignalName, aggregator->bins());
+
+            // only the upper half of each vector is aggregated
+            _subscriptions.push_back(sink->subscribe([aggregator](std::vector<const void *> &input_items, int &nitems, size_t vector_size, const std::vector<std::string> &, float sample_rate, int64_t timestamp) {
+                const float *in = static_cast<const float *>(input_items[0]);
+                for (int i = 0; i < nitems; i++) {
+                    const int64_t frameTimestamp = timestamp + (static_cast<int64_t>((static_cast<float>(i) * 1e9f) / sample_rate));
+                    const size_t  offset         = static_cast<size_t>(i) * vector_size;
+                    aggregator->push(in + offset + vector_size - aggregator->nativeBins(), frameTimestamp);
+                }
+            }));
+        }
+
+        super_t::setCallback([this](RequestContext &rawCtx, const SpectrogramContext &requestContext, const Empty &,
+                                     SpectrogramContext &replyContext, Spectrogram &out) {
+            replyContext.contentType = requestContext.contentType;
+            if (!_signalsMap.contains(requestContext.channelNameFilter)) {
+                throw std::invalid_argument(fmt::format("Requested spectrogram for '{}' not found", requestContext.channelNameFilter));
+            }
+            const SignalData &signalData = _signalsMap.at(requestContext.channelNameFilter);
+            if (rawCtx.request.command() == Command::Set) {
+                // a SET request restarts the peak hold
+                signalData.aggregator->resetPeakHold();
+            }
+            handleGetRequest(requestContext, signalData, out);
+        });
+    }
+
+    ~SpectrogramWorker() = default;
+
+private:
+    void handleGetRequest(const SpectrogramContext &requestContext, const SignalData &signalData, Spectrogram &out) const {
+        const size_t       factor  = SpectrumAggregator::decimationFactor(signalData.aggregator->bins(), static_cast<size_t>(std::max(0, requestContext.bins)));
+        const bool         usePeak = requestContext.mode == "peakhold";
+        std::vector<float> stored;
+        std::vector<float> row;
+        std::vector<float> stridedValues;
+        uint32_t           rows    = 0;
+
+        out.channelName         = requestContext.channelNameFilter;
+        out.channelUnit         = signalData.unit;
+        out.mode                = requestContext.mode;
+
+        if (requestContext.mode == "latest" || requestContext.mode == "waterfall") {
+            const size_t frames = requestContext.mode == "latest" ? 1 : static_cast<size_t>(std::clamp(requestContext.rows, 1, static_cast<int32_t>(HISTORY_SIZE)));
+            signalData.aggregator->lastFrames(frames, [&](std::span<const float> spectrum, int64_t timestamp) {
+                SpectrumAggregator::decimate(spectrum, factor, false, row);
+                stridedValues.insert(stridedValues.end(), row.begin(), row.end());
+                out.rowTimeStamps.push_back(timestamp);
+                out.refTriggerStamp = timestamp;
+                rows++;
+            });
+            out.framesAggregated = static_cast<int32_t>(rows);
+        } else if (requestContext.mode == "average" || usePeak) {
+            if (usePeak) {
+                signalData.aggregator->peakHold(stored);
+            } else {
+                out.framesAggregated = static_cast<int32_t>(signalData.aggregator->average(static_cast<size_t>(std::max(1, requestContext.averageFrames)), stored));
+            }
+            SpectrumAggregator::decimate(stored, factor, usePeak, stridedValues);
+            rows = signalData.aggregator->sequence() > 0 ? 1 : 0;
+        } else {
+            throw std::invalid_argument(fmt::format("Unknown spectrogram mode '{}', expected latest, average, peakhold or waterfall", requestContext.mode));
+        }
+
+        SpectrumAggregator::decimate(signalData.frequencyValues, factor, false, out.frequencyValues);
+        const auto columns = static_cast<uint32_t>(out.frequencyValues.size());
+        if (rows == 0) {
+            stridedValues.clear(); // no frames received yet
+        }
+        out.values = opencmw::MultiArray<float, 2>(std::move(stridedValues), { rows, columns });
+    }
+};
+
+#endif /* SPECTROGRAM_WORKER_H */
@@ -0,0 +1,175 @@
+#ifndef SPECTRUM_AGGREGATOR_H
+#define SPECTRUM_AGGREGATOR_H
+
+#include "SpectrumArena.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <span>
+#include <vector>
+
+/*
+ * Incremental spectrogram state of one frequency sink.
+ *
+ * Incoming spectra are mean-decimated once to at most maxBins bins and
+ * appended to a history of the last historyFrames frames. Running prefix sums
+ * allow averages over any N <= historyFrames frames in O(bins), and the peak
+ * hold is updated per frame. Queries only reduce the already decimated state
+ * to the requested number of bins, so the payload stays bounded.
+ *
+ * Non-finite input bins (e.g. the -inf dB of an empty bin) are left out of the
+ * decimation, a stored bin without any finite input is set to FLOOR. The
+ * prefix sums are rebuilt from the stored history once per historyFrames
+ * frames, so they stay bounded and rounding errors do not accumulate.
+ */
+class SpectrumAggregator {
+private:
+    const size_t        _nativeBins;
+    const size_t        _decimation;
+    const size_t        _bins;
+    SpectrumArena       _history;       // decimated frames
+    std::vector<double> _prefixSums;    // (historyFrames + 1) * _bins, running sum including the frame in the same slot
+    std::vector<float>  _peakHold;      // _bins, max-decimated
+    std::vector<float>  _scratch;       // _bins, decimation buffer
+    int64_t             _sequence = 0;  // total number of frames pushed
+    mutable std::mutex  _mutex;
+
+public:
+    static constexpr float FLOOR = -200.0f; // dB, stored for bins without a finite value
+
+    SpectrumAggregator(size_t nativeBins, size_t maxBins, size_t historyFrames)
+        : _nativeBins(nativeBins)
+        , _decimation(decimationFactor(nativeBins, maxBins))
+        , _bins(nativeBins / _decimation)
+        , _history(historyFrames, _bins)
+        , _prefixSums((historyFrames + 1) * _bins, 0.0)
+        , _peakHold(_bins, std::numeric_limits<float>::lowest())
+        , _scratch(_bins) {}
+
+    size_t nativeBins() const {
+        return _nativeBins;
+    }
+
+    size_t bins() const {
+        return _bins;
+    }
+
+    size_t decimation() const {
+        return _decimation;
+    }
+
+    void push(const float *spectrum, int64_t timestamp) {
+        std::scoped_lock lock(_mutex);
+        const size_t     slots    = _history.frames() + 1;
+        const double    *previous = _prefixSums.data() + (static_cast<size_t>(_sequence + static_cast<int64_t>(slots) - 1) % slots) * _bins;
+        double          *current  = _prefixSums.data() + (static_cast<size_t>(_sequence) % slots) * _bins;
+        for (size_t bin = 0; bin < _bins; bin++) {
+            const float *group  = spectrum + bin * _decimation;
+            float        sum    = 0.0f;
+            float        peak   = std::numeric_limits<float>::lowest();
+            size_t       finite = 0;
+            for (size_t i = 0; i < _decimation; i++) {
+                if (!std::isfinite(group[i])) {
+                    continue;
+                }
+                sum += group[i];
+                peak = std::max(peak, group[i]);
+                finite++;
+            }
+            _scratch[bin]  = finite == 0 ? FLOOR : sum / static_cast<float>(finite);
+            _peakHold[bin] = std::max(_peakHold[bin], finite == 0 ? FLOOR : peak);
+            current[bin]   = (_sequence == 0 ? 0.0 : previous[bin]) + static_cast<double>(_scratch[bin]);
+        }
+        _history.push(_scratch.data(), timestamp);
+        _sequence++;
+        if (_sequence % static_cast<int64_t>(_history.frames()) == 0) {
+            rebase();
+        }
+    }
+
+    int64_t sequence() const {
+        std::scoped_lock lock(_mutex);
+        return _sequence;
+    }
+
+    void resetPeakHold() {
+        std::scoped_lock lock(_mutex);
+        std::fill(_peakHold.begin(), _peakHold.end(), std::numeric_limits<float>::lowest());
+    }
+
+    // mean of the last n frames (n is limited to the stored history), returns the number of frames averaged
+    size_t average(size_t n, std::vector<float> &out) const {
+        std::scoped_lock lock(_mutex);
+        n = std::min({ n, _history.frames(), static_cast<size_t>(_sequence) });
+        out.assign(_bins, 0.0f);
+        if (n == 0) {
+            return 0;
+        }
+        const size_t  slots  = _history.frames() + 1;
+        const double *newest = _prefixSums.data() + (static_cast<size_t>(_sequence - 1) % slots) * _bins;
+        const int64_t before = _sequence - 1 - static_cast<int64_t>(n);
+        const double *oldest = before < 0 ? nullptr : _prefixSums.data() + (static_cast<size_t>(before) % slots) * _bins;
+        for (size_t bin = 0; bin < _bins; bin++) {
+            out[bin] = static_cast<float>((newest[bin] - (oldest ? oldest[bin] : 0.0)) / static_cast<double>(n));
+        }
+        return n;
+    }
+
+    void peakHold(std::vector<float> &out) const {
+        std::scoped_lock lock(_mutex);
+        out = _peakHold;
+    }
+
+    // calls visitor(std::span<const float> spectrum, int64_t timestamp) for the last n decimated frames, oldest first
+    template<typename Visitor>
+    void lastFrames(size_t n, Visitor visitor) const {
+        std::scoped_lock lock(_mutex);
+        _history.visit(_sequence - static_cast<int64_t>(n), _sequence, visitor);
+    }
+
+private:
+    // recomputes the prefix sums of the stored frames, relative to the frame before the oldest one
+    void rebase() {
+        const size_t  slots = _history.frames() + 1;
+        const int64_t first = std::max(int64_t{ 0 }, _sequence - static_cast<int64_t>(_history.frames()));
+        double       *sums  = _prefixSums.data() + (static_cast<size_t>(first + static_cast<int64_t>(slots) - 1) % slots) * _bins;
+        std::fill(sums, sums + _bins, 0.0);
+        int64_t sequence = first;
+        _history.visit(first, _sequence, [&](std::span<const float> spectrum, int64_t) {
+            double *current = _prefixSums.data() + (static_cast<size_t>(sequence) % slots) * _bins;
+            for (size_t bin = 0; bin < _bins; bin++) {
+                current[bin] = sums[bin] + static_cast<double>(spectrum[bin]);
+            }
+            sums = current;
+            sequence++;
+        });
+    }
+
+public:
+    // smallest factor reducing bins to at most maxBins bins, maxBins == 0 keeps all bins
+    static size_t decimationFactor(size_t bins, size_t maxBins) {
+        return (maxBins == 0 || bins <= maxBins) ? 1 : (bins + maxBins - 1) / maxBins;
+    }
+
+    // reduces a spectrum by averaging (or taking the maximum of) groups of factor adjacent bins
+    static void decimate(std::span<const float> in, size_t factor, bool usePeak, std::vector<float> &out) {
+        out.resize(in.size() / factor);
+        for (size_t bin = 0; bin < out.size(); bin++) {
+            const auto group = in.subspan(bin * factor, factor);
+            if (usePeak) {
+                out[bin] = *std::max_element(group.begin(), group.end());
+            } else {
+                float sum = 0.0f;
+                for (const float value : group) {
+                    sum += value;
+                }
+                out[bin] = sum / static_cast<float>(factor);
+            }
+        }
+    }
+};
+
+#endif /* SPECTRUM_AGGREGATOR_H */
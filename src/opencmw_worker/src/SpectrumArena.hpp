@@ -0,0 +1,75 @@
+#ifndef SPECTRUM_ARENA_H
+#define SPECTRUM_ARENA_H
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+
+/*
+ * Fixed-size ring of spectra backed by one preallocated frames x bins arena.
+ *
+ * Frames are copied into their slot on push, so no heap allocation occurs
+ * while ingesting. Readers visit the stored frames as spans without copying
+ * them first.
+ */
+class SpectrumArena {
+private:
+    const size_t         _frames;
+    const size_t         _bins;
+    std::vector<float>   _values;       // _frames * _bins, row-major
+    std::vector<int64_t> _timestamps;   // _frames
+    int64_t              _sequence = 0; // total number of frames pushed
+    mutable std::mutex   _mutex;
+
+public:
+    SpectrumArena(size_t frames, size_t bins)
+        : _frames(frames), _bins(bins), _values(frames * bins), _timestamps(frames) {}
+
+    size_t bins() const {
+        return _bins;
+    }
+
+    size_t frames() const {
+        return _frames;
+    }
+
+    void push(const float *spectrum, int64_t timestamp) {
+        std::scoped_lock lock(_mutex);
+        const size_t     slot = static_cast<size_t>(_sequence) % _frames;
+        std::copy_n(spectrum, _bins, _values.begin() + static_cast<std::ptrdiff_t>(slot * _bins));
+        _timestamps[slot] = timestamp;
+        _sequence++;
+    }
+
+    // sequence range [first, end) of the frames newer than lastRefTrigger
+    std::pair<int64_t, int64_t> sequence_range_since(int64_t lastRefTrigger) const {
+        std::scoped_lock lock(_mutex);
+        int64_t          first = std::max<int64_t>(0, _sequence - static_cast<int64_t>(_frames));
+        while (first < _sequence && _timestamps[static_cast<size_t>(first) % _frames] <= lastRefTrigger) {
+            first++;
+        }
+        return { first, _sequence };
+    }
+
+    // calls visitor(std::span<const float> spectrum, int64_t timestamp) for each frame in [first, end) not yet overwritten
+    template<typename Visitor>
+    void visit(int64_t first, int64_t end, Visitor visitor) const {
+        std::scoped_lock lock(_mutex);
+        first = std::max({ first, int64_t{ 0 }, _sequence - static_cast<int64_t>(_frames) });
+        end   = std::min(end, _sequence);
+        for (int64_t seq = first; seq < end; seq++) {
+            const size_t slot = static_cast<size_t>(seq) % _frames;
+            visitor(std::span<const float>(_values.data() + slot * _bins, _bins), _timestamps[slot]);
+        }
+    }
+
+    int64_t sequence() const {
+        std::scoped_lock lock(_mutex);
+        return _sequence;
+    }
+};
+
+#endif /* SPECTRUM_ARENA_H */
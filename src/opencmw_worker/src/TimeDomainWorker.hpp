@@ -3,6 +3,7 @@
 
 #define BOOST_BIND_NO_PLACEHOLDERS
 
+#include "ReplyCache.hpp"
 #include "Ringbuffer.hpp"
 #include <majordomo/Worker.hpp>
 
@@ -59,12 +60,14 @@ private:
             int64_t                         timestamp = 0;
         };
         using ringbuffer_t = std::shared_ptr<Ringbuffer<RingBufferData>>;
+        using replycache_t = std::shared_ptr<ReplyCache>;
 
         std::vector<std::string> _channelNames;      // { signalName1, signalName2, ... }
         std::vector<std::string> _channelUnits;      // { signalUnit1, signalUnit2, ... }
         std::string              _channelNameFilter; // signalName1@sampleRate,signalName2@sampleRate...
         float                    _sampleRate = 0;
         ringbuffer_t             _ringBuffer;
+        replycache_t             _replyCache;
         const size_t             RING_BUFFER_SIZE = 512;
 
     public:
@@ -72,8 +75,9 @@ private:
         explicit GRSink(gr::pulsed_power::opencmw_time_sink *sink)
             : _channelNames(sink->get_signal_names()), _sampleRate(sink->get_sample_rate()) {
             _ringBuffer = std::make_shared<Ringbuffer<RingBufferData>>(RING_BUFFER_SIZE);
+            _replyCache = std::make_shared<ReplyCache>();
             for (size_t i = 0; i < _channelNames.size(); i++) {
-                _channelNameFilter.append(fmt::format("{}@{}Hz", _channelNames[i], _sampleRate));
+                _channelNameFilter.append(gr::pulsed_power::qualified_signal_name(_channelNames[i], _sampleRate));
                 _channelUnits = sink->get_signal_units();
                 if (i != (_channelNames.size() - 1)) {
                     _channelNameFilter.append(",");
@@ -89,18 +93,33 @@ private:
             return _ringBuffer;
         };
 
-        void fetchData(const int64_t lastRefTrigger, Acquisition &out) {
+        replycache_t getReplyCache() const {
+            return _replyCache;
+        };
+
+        ReplyCache::payload_t fetchData(const int64_t lastRefTrigger, const opencmw::MIME::MimeType &contentType) {
+            // clients polling with a similar lastRefTrigger resolve to the same sequence range and share one encoded reply
+            const auto [firstSequence, endSequence] = _ringBuffer->sequence_range_if([lastRefTrigger](const RingBufferData &bufData) { return bufData.timestamp > lastRefTrigger; });
+            const ReplyCache::Key key{ _channelNameFilter, firstSequence, endSequence, std::string(contentType.typeName()) };
+            return _replyCache->getOrEncode(key, [&, firstSequence = firstSequence, endSequence = endSequence] {
+                Acquisition out;
+                assemble(lastRefTrigger, firstSequence, endSequence, out);
+                return encodeReply(contentType, out);
+            });
+        };
+
+        void assemble(const int64_t lastRefTrigger, const int64_t firstSequence, const int64_t endSequence, Acquisition &out) {
             std::vector<float>          stridedValues;
 
             bool                        firstChunk = true;
             std::vector<RingBufferData> currentValues;
-            _ringBuffer->get_all(currentValues);
+            _ringBuffer->get_range(firstSequence, endSequence, currentValues);
             for (size_t i = 0; i < _channelNames.size(); i++) {
                 for (RingBufferData bufData : currentValues) {
                     if (bufData.timestamp > lastRefTrigger) {
                         if (firstChunk) {
                             for (const auto &channelName : _channelNames) {
-                                out.channelNames.push_back(fmt::format("{}@{}Hz", channelName, _sampleRate));
+                                out.channelNames.push_back(gr::pulsed_power::qualified_signal_name(channelName, _sampleRate));
                             }
                             out.channelUnits    = _channelUnits;
                             out.refTriggerStamp = bufData.timestamp;
@@ -139,7 +158,8 @@ private:
         }
     };
 
-    std::unordered_map<std::string, GRSink> _sinksMap; // <subscriptionName, GRSink>
+    std::unordered_map<std::string, GRSink>     _sinksMap;      // <subscriptionName, GRSink>
+    std::vector<gr::pulsed_power::subscription> _subscriptions; // destroyed first, the callbacks write into _sinksMap
 
 public:
     using super_t = Worker<serviceName, TimeDomainContext, Empty, Acquisition, Meta...>;
@@ -182,42 +202,61 @@ public:
                 }
             }
         });*/
-        // map signal names and ringbuffers, register callback
-        std::scoped_lock lock(gr::pulsed_power::globalTimeSinksRegistryMutex);
-        fmt::print("GR: OpenCMW: time-domain sinks found: {}\n", gr::pulsed_power::globalTimeSinksRegistry.size());
-
-        for (const auto timeSink : gr::pulsed_power::globalTimeSinksRegistry) {
-            GRSink grSink(timeSink);
-            auto   completeSubscriptionName = grSink.getChannelNameFilter();
-            _sinksMap.insert({ completeSubscriptionName, grSink });
+        // map signal names and ringbuffers, subscribe to the sinks
+        const auto timeSinks = gr::pulsed_power::time_sink_registry().sinks();
+        fmt::print("GR: OpenCMW: time-domain sinks found: {}\n", timeSinks.size());
+
+        for (const auto &timeSink : timeSinks) {
+            GRSink     grSink(timeSink.get());
+            const auto completeSubscriptionName = grSink.getChannelNameFilter();
+            const auto [entry, inserted]        = _sinksMap.emplace(completeSubscriptionName, std::move(grSink));
+            if (!inserted) {
+                fmt::print("GR: OpenCMW Time Sink subscription '{}' exists already, skipped\n", completeSubscriptionName);
+                continue;
+            }
             fmt::print("GR: OpenCMW Time Sink subscription '{}' added\n", completeSubscriptionName);
 
-            // register callback
-            timeSink->set_callback(std::bind(&GRSink::copySinkData, grSink, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4, std::placeholders::_5));
+            // the map entry is stable, the callback writes into it directly
+            GRSink *sink = &entry->second;
+            _subscriptions.push_back(timeSink->subscribe([sink](std::vector<const void *> &input_items, int &noutput_items, const std::vector<std::string> &signal_names, float sample_rate, int64_t timestamp_ns) {
+                sink->copySinkData(input_items, noutput_items, signal_names, sample_rate, timestamp_ns);
+            }));
         }
 
-        super_t::setCallback([this](RequestContext &rawCtx, const TimeDomainContext     &requestContext, const Empty &,
-                                     TimeDomainContext /* &replyContext */, Acquisition &out) {
-            if (rawCtx.request.command() == Command::Get) {
-                handleGetRequest(requestContext, out);
-            }
+        // reply in the requested wire format (JSON, YaS binary or CmwLight), encoded once per ring buffer range
+        super_t::setHandler([this](RequestContext &rawCtx) {
+            replyEncoded<TimeDomainContext, Acquisition>(rawCtx, [this](const TimeDomainContext &requestContext) { return handleGetRequest(requestContext); });
         });
     }
 
     ~TimeDomainWorker() = default;
+
+    uint64_t replyCacheHits() const {
+        uint64_t hits = 0;
+        for (const auto &[name, sink] : _sinksMap) {
+            hits += sink.getReplyCache()->hits();
+        }
+        return hits;
+    }
+
+    uint64_t replyCacheMisses() const {
+        uint64_t misses = 0;
+        for (const auto &[name, sink] : _sinksMap) {
+            misses += sink.getReplyCache()->misses();
+        }
+        return misses;
+    }
     /*{    _shutdownRequested = true;
         _pollingThread.join();
     }*/
 
 private:
-    bool handleGetRequest(const TimeDomainContext &requestContext, Acquisition &out) {
-        if (_sinksMap.contains(requestContext.channelNameFilter)) {
-            auto &sink = _sinksMap.at(requestContext.channelNameFilter);
-            sink.fetchData(requestContext.lastRefTrigger, out);
-        } else {
+    ReplyCache::payload_t handleGetRequest(const TimeDomainContext &requestContext) {
+        if (!_sinksMap.contains(requestContext.channelNameFilter)) {
             throw std::invalid_argument(fmt::format("Requested subscription for '{}' not found", requestContext.channelNameFilter));
         }
-        return true;
+        auto &sink = _sinksMap.at(requestContext.channelNameFilter);
+        return sink.fetchData(requestContext.lastRefTrigger, requestContext.contentType);
     }
 };
 
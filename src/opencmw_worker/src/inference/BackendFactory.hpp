@@ -0,0 +1,32 @@
+#ifndef BACKEND_FACTORY_H
+#define BACKEND_FACTORY_H
+
+#include "GuptaClassifier.hpp"
+#include "InferenceBackend.hpp"
+
+#ifdef ENABLE_TENSORFLOW
+#include "TensorflowBackend.hpp"
+#endif
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+// TensorFlow model, only in builds with ENABLE_TENSORFLOW (libtensorflow and cppflow)
+inline std::unique_ptr<InferenceBackend> createTensorflowBackend() {
+#ifdef ENABLE_TENSORFLOW
+    return std::make_unique<TensorflowBackend>();
+#else
+    throw std::invalid_argument("built without TensorFlow (cmake -DENABLE_TENSORFLOW=ON), run the native Gupta classifier with its exported parameters instead");
+#endif
+}
+
+// native Gupta classifier if its parameters are given, the TensorFlow model otherwise
+inline std::unique_ptr<InferenceBackend> createInferenceBackend(const std::string &guptaParameterFile) {
+    if (guptaParameterFile.empty()) {
+        return createTensorflowBackend();
+    }
+    return std::make_unique<GuptaClassifier>(guptaParameterFile);
+}
+
+#endif /* BACKEND_FACTORY_H */
@@ -0,0 +1,114 @@
+#ifndef CAPTURE_REPLAY_H
+#define CAPTURE_REPLAY_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+// read-only mapping of a NILM data point capture (back-to-back records of recordSize floats)
+class MappedCapture {
+    void  *_mapping    = nullptr;
+    size_t _bytes      = 0;
+    size_t _recordSize = 0;
+    size_t _records    = 0;
+
+public:
+    MappedCapture(const std::string &path, size_t recordSize)
+        : _recordSize(recordSize) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1) {
+            throw std::runtime_error("Could not open capture " + path);
+        }
+        struct stat fileStat {};
+        if (fstat(fd, &fileStat) == -1 || recordSize == 0) {
+            ::close(fd);
+            throw std::runtime_error("Could not stat capture " + path);
+        }
+        _bytes = static_cast<size_t>(fileStat.st_size);
+        if (_bytes % (recordSize * sizeof(float)) != 0) {
+            ::close(fd);
+            throw std::invalid_argument(fmt::format("Capture {} ({} bytes) does not hold records of {} floats", path, _bytes, recordSize));
+        }
+        _records = _bytes / (recordSize * sizeof(float));
+        if (_bytes > 0) {
+            _mapping = mmap(nullptr, _bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (_mapping == MAP_FAILED) {
+            _mapping = nullptr;
+            throw std::runtime_error("Could not map capture " + path);
+        }
+        if (_mapping != nullptr) {
+            madvise(_mapping, _bytes, MADV_SEQUENTIAL);
+        }
+    }
+
+    MappedCapture(const MappedCapture &)            = delete;
+    MappedCapture &operator=(const MappedCapture &) = delete;
+
+    ~MappedCapture() {
+        if (_mapping != nullptr) {
+            munmap(_mapping, _bytes);
+        }
+    }
+
+    size_t records() const {
+        return _records;
+    }
+
+    size_t recordSize() const {
+        return _recordSize;
+    }
+
+    std::span<const float> record(size_t i) const {
+        return { static_cast<const float *>(_mapping) + i * _recordSize, _recordSize };
+    }
+};
+
+// latency samples of one processing stage
+class StageLatency {
+    std::string         _name;
+    std::vector<double> _samples; // microseconds
+
+public:
+    explicit StageLatency(std::string name, size_t expectedSamples = 0)
+        : _name(std::move(name)) {
+        _samples.reserve(expectedSamples);
+    }
+
+    void add(std::chrono::steady_clock::duration duration) {
+        _samples.push_back(std::chrono::duration<double, std::micro>(duration).count());
+    }
+
+    size_t count() const {
+        return _samples.size();
+    }
+
+    double total() const {
+        return std::accumulate(_samples.begin(), _samples.end(), 0.0);
+    }
+
+    // mean, p50, p99 and max in microseconds
+    std::string summary() {
+        if (_samples.empty()) {
+            return fmt::format("{:<10} no samples", _name);
+        }
+        std::sort(_samples.begin(), _samples.end());
+        auto percentile = [this](double p) { return _samples[static_cast<size_t>(p * static_cast<double>(_samples.size() - 1))]; };
+        return fmt::format("{:<10} n={:<8} mean={:10.1f} us  p50={:10.1f} us  p99={:10.1f} us  max={:10.1f} us", _name, _samples.size(), total() / static_cast<double>(_samples.size()), percentile(0.5), percentile(0.99), _samples.back());
+    }
+};
+
+#endif /* CAPTURE_REPLAY_H */
@@ -0,0 +1,383 @@
+#ifndef GUPTA_CLASSIFIER_H
+#define GUPTA_CLASSIFIER_H
+
+#include "InferenceBackend.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// parameters of a trained Gupta model, written by models/gupta_model/export_gupta_params.py
+struct GuptaParameters {
+    static constexpr uint32_t N_PEAKS_MAX = 9;
+    static constexpr uint32_t N_FEATURES  = 3 * N_PEAKS_MAX; // [a_0, mu_0, sigma_0, a_1, ...]
+
+    uint32_t                  windowSize        = 10;
+    uint32_t                  stepSize          = 1;
+    uint32_t                  fftSizeReal       = 1U << 16;
+    uint32_t                  sampleRate        = 2'000'000;
+    uint32_t                  nKnownAppliances  = 10;
+    uint32_t                  spectrumType      = 2; // 0: voltage, 1: current, 2: apparent power
+    uint32_t                  nNeighbors        = 3;
+    uint32_t                  nLabels           = 21; // one-hot: on [0, N), off [N, 2N), other
+    float                     switchThreshold   = 55.0f;
+    float                     distanceThreshold = 10.0f;
+    std::vector<float>        apparentPowerList;     // nKnownAppliances
+    std::vector<float>        trainingFeatures;      // nTrainingPoints x N_FEATURES, unscaled
+    std::vector<float>        trainingLabels;        // nTrainingPoints x nLabels
+
+    /*
+     * Flat little-endian file: char[8] "GUPTAv1", uint32 windowSize, stepSize, fftSizeReal, sampleRate,
+     * nKnownAppliances, spectrumType, nNeighbors, nTrainingPoints, nFeatures, nLabels, float32 switchThreshold,
+     * distanceThreshold, apparentPowerList[nKnownAppliances], trainingFeatures[nTrainingPoints][nFeatures],
+     * trainingLabels[nTrainingPoints][nLabels]
+     */
+    static GuptaParameters load(const std::string &path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::invalid_argument("Could not open Gupta parameter file " + path);
+        }
+        auto read = [&file, &path](void *data, size_t bytes) {
+            if (!file.read(static_cast<char *>(data), static_cast<std::streamsize>(bytes))) {
+                throw std::invalid_argument("Truncated Gupta parameter file " + path);
+            }
+        };
+
+        std::array<char, 8> magic{};
+        read(magic.data(), magic.size());
+        if (std::strncmp(magic.data(), "GUPTAv1", magic.size()) != 0) {
+            throw std::invalid_argument("Not a Gupta parameter file " + path);
+        }
+
+        GuptaParameters params;
+        uint32_t        nTrainingPoints = 0;
+        uint32_t        nFeatures       = 0;
+        for (uint32_t *field : { &params.windowSize, &params.stepSize, &params.fftSizeReal, &params.sampleRate, &params.nKnownAppliances, &params.spectrumType, &params.nNeighbors, &nTrainingPoints, &nFeatures, &params.nLabels }) {
+            read(field, sizeof(uint32_t));
+        }
+        read(&params.switchThreshold, sizeof(float));
+        read(&params.distanceThreshold, sizeof(float));
+        if (nFeatures != N_FEATURES || params.nLabels == 0 || params.nNeighbors == 0 || nTrainingPoints < params.nNeighbors || params.windowSize == 0) {
+            throw std::invalid_argument("Inconsistent Gupta parameter file " + path);
+        }
+
+        params.apparentPowerList.resize(params.nKnownAppliances);
+        params.trainingFeatures.resize(size_t{ nTrainingPoints } * N_FEATURES);
+        params.trainingLabels.resize(size_t{ nTrainingPoints } * params.nLabels);
+        read(params.apparentPowerList.data(), params.apparentPowerList.size() * sizeof(float));
+        read(params.trainingFeatures.data(), params.trainingFeatures.size() * sizeof(float));
+        read(params.trainingLabels.data(), params.trainingLabels.size() * sizeof(float));
+        return params;
+    }
+};
+
+/*
+ * Native port of TFGuptaClassifier (tf_gupta_clf.py): rolling window switch
+ * detection, gaussian peak features, max-abs feature scaling and a distance
+ * weighted k-nearest-neighbour search over the known appliance signatures.
+ *
+ * The behaviour, including its corner cases, mirrors the TF graph so both
+ * backends produce the same state vectors. The window block sums are kept up
+ * to date incrementally (O(fftSizeReal) per frame), and the reference set is
+ * stored feature-major so the distance kernel vectorises.
+ *
+ * observe() maintains the window and detects the events, the feature
+ * extraction and the k-nearest-neighbour search of an event run in classify().
+ * Events are classified in order, an event still pending when the next one is
+ * detected is classified first, so the state vector does not depend on how
+ * often classify() is called.
+ */
+class GuptaClassifier : public InferenceBackend {
+    GuptaParameters     _params;
+    size_t              _nTrainingPoints;
+    std::vector<float>  _scale;          // N_FEATURES, max |feature| of the training data
+    std::vector<float>  _referenceSoA;   // N_FEATURES x nTrainingPoints, scaled
+
+    std::vector<float>  _window;         // 3 * windowSize rows of fftSizeReal, ring, row 0 is the newest frame
+    std::vector<double> _blockSums;      // 3 blocks of windowSize rows, fftSizeReal each
+    size_t              _newestRow       = 0;
+    uint32_t            _nFramesInWindow = 0;
+    std::vector<float>  _stateVector;    // nKnownAppliances + 1, last entry: unknown
+    std::vector<float>  _eventSpectrum;  // fftSizeReal, mean of the oldest block at the last detected event
+    bool                _eventPending    = false;
+    float               _apparentPower   = 0.0f; // of the data point observed last
+
+    std::vector<float>  _spectrum;       // scratch buffers, fftSizeReal
+    std::vector<float>  _difference;
+    std::vector<float>  _distances;      // nTrainingPoints
+
+public:
+    explicit GuptaClassifier(GuptaParameters params)
+        : _params(std::move(params))
+        , _nTrainingPoints(_params.trainingFeatures.size() / GuptaParameters::N_FEATURES)
+        , _scale(GuptaParameters::N_FEATURES, 0.0f)
+        , _referenceSoA(GuptaParameters::N_FEATURES * _nTrainingPoints)
+        , _window(size_t{ 3 } * _params.windowSize * _params.fftSizeReal, 0.0f)
+        , _blockSums(size_t{ 3 } * _params.fftSizeReal, 0.0)
+        , _stateVector(_params.nKnownAppliances + 1, 0.0f)
+        , _eventSpectrum(_params.fftSizeReal)
+        , _spectrum(_params.fftSizeReal)
+        , _difference(_params.fftSizeReal)
+        , _distances(_nTrainingPoints) {
+        for (size_t point = 0; point < _nTrainingPoints; point++) {
+            for (size_t f = 0; f < GuptaParameters::N_FEATURES; f++) {
+                _scale[f] = std::max(_scale[f], std::abs(_params.trainingFeatures[point * GuptaParameters::N_FEATURES + f]));
+            }
+        }
+        for (size_t point = 0; point < _nTrainingPoints; point++) {
+            for (size_t f = 0; f < GuptaParameters::N_FEATURES; f++) {
+                _referenceSoA[f * _nTrainingPoints + point] = divideNoNan(_params.trainingFeatures[point * GuptaParameters::N_FEATURES + f], _scale[f]);
+            }
+        }
+    }
+
+    explicit GuptaClassifier(const std::string &parameterFile)
+        : GuptaClassifier(GuptaParameters::load(parameterFile)) {}
+
+    std::string name() const override {
+        return "gupta-native";
+    }
+
+    void observe(const std::vector<float> &dataPoint) override {
+        const size_t fftSize = _params.fftSizeReal;
+        if (dataPoint.size() != 3 * fftSize + 4) {
+            throw std::invalid_argument("Gupta classifier: unexpected data point size " + std::to_string(dataPoint.size()));
+        }
+        // a data point of all -1 resets the internal state
+        if (std::all_of(dataPoint.begin(), dataPoint.end(), [](float v) { return v == -1.0f; })) {
+            reset();
+            return;
+        }
+
+        const float *rawSpectrum = dataPoint.data() + size_t{ _params.spectrumType } * fftSize;
+        _apparentPower           = dataPoint[dataPoint.size() - 2];
+        for (size_t i = 0; i < fftSize; i++) {
+            _spectrum[i] = 10.0f * std::log10(rawSpectrum[i]) + 30.0f; // dBm
+        }
+
+        pushToWindow(_spectrum.data());
+        if (_nFramesInWindow < 3 * _params.windowSize) {
+            return;
+        }
+
+        // difference of the mean "signal" (rows [W, 2W)) and the mean "background" (rows [0, W))
+        const double windowSize = static_cast<double>(_params.windowSize);
+        for (size_t i = 0; i < fftSize; i++) {
+            _difference[i] = static_cast<float>(_blockSums[fftSize + i] / windowSize) - static_cast<float>(_blockSums[i] / windowSize);
+        }
+        const auto [minIt, maxIt] = std::minmax_element(_difference.begin(), _difference.end());
+        // same condition as tf_switch_detected
+        const bool switchDetected = *maxIt >= _params.switchThreshold || *minIt <= _params.switchThreshold;
+        if (!switchDetected) {
+            _nFramesInWindow -= std::min(_nFramesInWindow, _params.stepSize);
+            return;
+        }
+
+        if (_eventPending) {
+            classifySwitchingEvent(_eventSpectrum);
+        }
+        // the event is classified on the mean of the oldest block (rows [2W, 3W))
+        for (size_t i = 0; i < fftSize; i++) {
+            _eventSpectrum[i] = static_cast<float>(_blockSums[2 * fftSize + i] / windowSize);
+        }
+        _eventPending = true;
+        clearWindow();
+    }
+
+    void classify(std::vector<float> &values) override {
+        if (_eventPending) {
+            classifySwitchingEvent(_eventSpectrum);
+            _eventPending = false;
+        }
+        updateUnknownPower(_apparentPower);
+        values = _stateVector;
+    }
+
+    void reset() {
+        clearWindow();
+        std::fill(_stateVector.begin(), _stateVector.end(), 0.0f);
+        _apparentPower = 0.0f;
+        _eventPending  = false;
+    }
+
+    const std::vector<float> &stateVector() const {
+        return _stateVector;
+    }
+
+    // [a_0, mu_0, sigma_0, ...] of the (up to) N_PEAKS_MAX highest peaks, see tf_calculate_feature_vector
+    static std::array<float, GuptaParameters::N_FEATURES> featureVector(const std::vector<float> &cleanedSpectrum, uint32_t fftSizeReal, uint32_t sampleRate) {
+        std::array<float, GuptaParameters::N_FEATURES> features{};
+        const auto [minIt, maxIt]    = std::minmax_element(cleanedSpectrum.begin(), cleanedSpectrum.end());
+        const float switchOffFactor  = std::abs(*minIt) < std::abs(*maxIt) ? 1.0f : -1.0f;
+
+        // local maxima above zero (window of three bins)
+        std::vector<size_t> peaks;
+        for (size_t i = 1; i + 1 < cleanedSpectrum.size(); i++) {
+            const float value = cleanedSpectrum[i] * switchOffFactor;
+            if (value > 0.0f && value == std::max({ cleanedSpectrum[i - 1] * switchOffFactor, value, cleanedSpectrum[i + 1] * switchOffFactor })) {
+                peaks.push_back(i);
+            }
+        }
+        // keep the highest peaks, ordered by frequency (ties keep the lower frequency, as top_k)
+        const size_t nPeaks = std::min<size_t>(peaks.size(), GuptaParameters::N_PEAKS_MAX);
+        std::stable_sort(peaks.begin(), peaks.end(), [&](size_t a, size_t b) { return cleanedSpectrum[a] * switchOffFactor > cleanedSpectrum[b] * switchOffFactor; });
+        peaks.resize(nPeaks);
+        std::sort(peaks.begin(), peaks.end());
+
+        const float freqPerBin = static_cast<float>(static_cast<double>(sampleRate) / static_cast<double>(fftSizeReal));
+        for (size_t p = 0; p < nPeaks; p++) {
+            std::array<double, 3> x{};
+            std::array<double, 3> y{};
+            for (size_t k = 0; k < 3; k++) {
+                const size_t bin = peaks[p] - 1 + k;
+                x[k]             = static_cast<double>(static_cast<float>(bin) * freqPerBin + freqPerBin / 2.0f);
+                y[k]             = static_cast<double>(cleanedSpectrum[bin] * switchOffFactor);
+            }
+            const auto [a, mu, sigma] = gaussianParameters(x, y);
+            features[3 * p]           = static_cast<float>(a) * switchOffFactor;
+            features[3 * p + 1]       = static_cast<float>(mu);
+            features[3 * p + 2]       = static_cast<float>(sigma);
+        }
+        return features;
+    }
+
+    // squared euclidean distances of the scaled query to every reference point, feature-major so the inner loop vectorises
+    static void squaredDistances(const float *query, const float *referenceSoA, size_t nPoints, float *distances) {
+        std::fill(distances, distances + nPoints, 0.0f);
+        for (size_t f = 0; f < GuptaParameters::N_FEATURES; f++) {
+            const float  q         = query[f];
+            const float *reference = referenceSoA + f * nPoints;
+            for (size_t point = 0; point < nPoints; point++) {
+                const float d = reference[point] - q;
+                distances[point] += d * d;
+            }
+        }
+    }
+
+private:
+    static float divideNoNan(float numerator, float denominator) {
+        return denominator == 0.0f ? 0.0f : numerator / denominator;
+    }
+
+    // exact gaussian a * exp(-(x - mu)^2 / (2 sigma^2)) through three points, see tf_calculate_gaussian_params_for_peak
+    static std::array<double, 3> gaussianParameters(const std::array<double, 3> &x, const std::array<double, 3> &y) {
+        const double z0    = std::log(y[0]);
+        const double z1    = std::log(y[1]);
+        const double z2    = std::log(y[2]);
+        const double e     = x[1] * x[1] - x[2] * x[2];
+        const double f     = z1 - z2;
+        const double g     = x[1] - x[2];
+        const double h     = z0 - z1;
+        const double i     = x[0] * x[0] - x[1] * x[1];
+        const double j     = x[0] - x[1];
+        const double alpha = (f * j - g * h) / (e * j - g * i);
+        const double beta  = (h - alpha * i) / j;
+        const double gamma = z0 - alpha * x[0] * x[0] - beta * x[0];
+        const double c     = std::sqrt(-1.0 / (2.0 * alpha));
+        const double b     = beta * c * c;
+        const double a     = std::exp(gamma + (b * b / (2.0 * c * c)));
+        return { a, b, c };
+    }
+
+    float *windowRow(size_t row) {
+        const size_t rows = 3 * size_t{ _params.windowSize };
+        return _window.data() + ((_newestRow + rows - row) % rows) * _params.fftSizeReal;
+    }
+
+    // shifts every row by one (the oldest is evicted) and inserts spectrum as row 0, block sums follow incrementally
+    void pushToWindow(const float *spectrum) {
+        const size_t fftSize  = _params.fftSizeReal;
+        const size_t W        = _params.windowSize;
+        const float *lastRow0 = windowRow(W - 1);     // moves from block 0 to block 1
+        const float *lastRow1 = windowRow(2 * W - 1); // moves from block 1 to block 2
+        float       *evicted  = windowRow(3 * W - 1); // leaves block 2, its slot becomes the new row 0
+        for (size_t i = 0; i < fftSize; i++) {
+            _blockSums[i] += static_cast<double>(spectrum[i]) - static_cast<double>(lastRow0[i]);
+            _blockSums[fftSize + i] += static_cast<double>(lastRow0[i]) - static_cast<double>(lastRow1[i]);
+            _blockSums[2 * fftSize + i] += static_cast<double>(lastRow1[i]) - static_cast<double>(evicted[i]);
+        }
+        std::copy_n(spectrum, fftSize, evicted);
+        _newestRow = (_newestRow + 1) % (3 * W);
+        if (_nFramesInWindow < 3 * W) {
+            _nFramesInWindow++;
+        }
+    }
+
+    void clearWindow() {
+        std::fill(_window.begin(), _window.end(), 0.0f);
+        std::fill(_blockSums.begin(), _blockSums.end(), 0.0);
+        _nFramesInWindow = 0;
+    }
+
+    void updateUnknownPower(float apparentPower) {
+        const float knownPower = std::accumulate(_stateVector.begin(), _stateVector.end() - 1, 0.0f);
+        _stateVector.back()    = std::max(apparentPower - knownPower, 0.0f);
+    }
+
+    void classifySwitchingEvent(const std::vector<float> &cleanedSpectrum) {
+        const auto                                     features = featureVector(cleanedSpectrum, _params.fftSizeReal, _params.sampleRate);
+        std::array<float, GuptaParameters::N_FEATURES> scaled{};
+        for (size_t f = 0; f < GuptaParameters::N_FEATURES; f++) {
+            scaled[f] = divideNoNan(features[f], _scale[f]);
+        }
+        squaredDistances(scaled.data(), _referenceSoA.data(), _nTrainingPoints, _distances.data());
+
+        // k nearest neighbours, ascending distance (ties keep the lower index)
+        std::vector<size_t> indices(_nTrainingPoints);
+        std::iota(indices.begin(), indices.end(), 0);
+        const size_t k = std::min<size_t>(_params.nNeighbors, _nTrainingPoints);
+        std::partial_sort(indices.begin(), indices.begin() + static_cast<std::ptrdiff_t>(k), indices.end(), [this](size_t a, size_t b) {
+            return _distances[a] < _distances[b] || (_distances[a] == _distances[b] && a < b);
+        });
+
+        std::vector<float> labelWeights(_params.nLabels, 0.0f);
+        bool               anyNan = false;
+        for (size_t n = 0; n < k; n++) {
+            anyNan = anyNan || std::isnan(_distances[indices[n]]);
+        }
+        if (anyNan) {
+            return; // keep the current state vector
+        }
+        const float minDistance = std::sqrt(_distances[indices[0]]);
+
+        size_t      eventIndex  = 0;
+        if (minDistance > _params.distanceThreshold) {
+            // "other" is one-hot(N) in the TF graph, which the case distinction below treats as switching off appliance 0
+            eventIndex = _params.nKnownAppliances;
+        } else if (minDistance == 0.0f) {
+            eventIndex = argmax(_params.trainingLabels.data() + indices[0] * _params.nLabels, _params.nLabels);
+        } else {
+            // weight the labels of the neighbours with their inverse distance
+            for (size_t n = 0; n < k; n++) {
+                const float *label    = _params.trainingLabels.data() + indices[n] * _params.nLabels;
+                const float  distance = std::sqrt(_distances[indices[n]]);
+                for (size_t l = 0; l < _params.nLabels; l++) {
+                    labelWeights[l] += label[l] / distance;
+                }
+            }
+            eventIndex = argmax(labelWeights.data(), labelWeights.size());
+        }
+
+        // same case distinction as calculate_state_vector: [0, N) switched on, [N, 2N) switched off
+        const size_t nKnown = _params.nKnownAppliances;
+        if (eventIndex < nKnown) {
+            _stateVector[eventIndex] = _params.apparentPowerList[eventIndex];
+        } else if (eventIndex < 2 * nKnown) {
+            _stateVector[eventIndex - nKnown] = 0.0f;
+        }
+    }
+
+    static size_t argmax(const float *values, size_t size) {
+        return static_cast<size_t>(std::max_element(values, values + size) - values);
+    }
+};
+
+#endif /* GUPTA_CLASSIFIER_H */
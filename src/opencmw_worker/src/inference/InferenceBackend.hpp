@@ -0,0 +1,33 @@
+#ifndef INFERENCE_BACKEND_H
+#define INFERENCE_BACKEND_H
+
+#include <string>
+#include <vector>
+
+/*
+ * Backend running the NILM disaggregation on one data point at a time.
+ *
+ * A data point holds the voltage, current and apparent power spectra (first
+ * half of the FFT each) followed by P, Q, S and phi. The result holds the
+ * estimated apparent power per known appliance plus "unknown".
+ *
+ * The models are stateful (rolling window of the last 3 * windowSize data
+ * points), so every data point has to be observed, even if its result is not
+ * needed. classify() produces the result for the data point observed last and
+ * is the part that may be skipped in steady state.
+ */
+class InferenceBackend {
+public:
+    virtual ~InferenceBackend() = default;
+
+    virtual void        observe(const std::vector<float> &dataPoint) = 0;
+    virtual void        classify(std::vector<float> &values)        = 0;
+    virtual std::string name() const                                = 0;
+
+    void predict(const std::vector<float> &dataPoint, std::vector<float> &values) {
+        observe(dataPoint);
+        classify(values);
+    }
+};
+
+#endif /* INFERENCE_BACKEND_H */
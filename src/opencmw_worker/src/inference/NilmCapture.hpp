@@ -0,0 +1,345 @@
+#ifndef NILM_CAPTURE_H
+#define NILM_CAPTURE_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * Self-describing capture of NILM data points (model input frames).
+ *
+ * Layout: FileHeader | record 0 | record 1 | ... | IndexEntry[records] | Footer
+ * where every record is a RecordHeader followed by its payload, either the raw
+ * floats or, with FLAG_COMPRESSED, the floats delta coded on their bit
+ * patterns, byte shuffled into four planes and zero-run-length encoded.
+ *
+ * The trailing index gives O(1) access to any record. Readers map the file
+ * read-only and decode into caller-owned buffers, so any number of threads
+ * can read the same capture concurrently. A capture without index (writer
+ * did not shut down cleanly) is indexed by scanning the records once.
+ */
+namespace nilm_capture {
+
+constexpr std::array<char, 8> MAGIC           = { 'N', 'I', 'L', 'M', 'C', 'A', 'P', '\0' };
+constexpr std::array<char, 8> INDEX_MAGIC     = { 'N', 'I', 'L', 'M', 'I', 'D', 'X', '\0' };
+constexpr uint32_t            VERSION         = 1;
+constexpr uint32_t            FLAG_COMPRESSED = 1U << 0;
+
+// data point layout: spectraCount spectra of spectrumSize bins (voltage, current, apparent power), then scalarCount values (P, Q, S, phi)
+struct FileHeader {
+    std::array<char, 8>  magic = MAGIC;
+    uint32_t             version       = VERSION;
+    uint32_t             flags         = 0;
+    uint32_t             vectorSize    = 0; // sink vector size (FFT size)
+    uint32_t             spectrumSize  = 0; // bins per spectrum in the data point
+    uint32_t             spectraCount  = 3;
+    uint32_t             scalarCount   = 4;
+    float                sampleRate    = 0.0f; // of the digitizer, 0: unknown
+    uint32_t             reserved      = 0;
+    std::array<char, 32> modelVersion{};      // backend the capture was taken with
+
+    uint32_t             recordSize() const {
+        return spectraCount * spectrumSize + scalarCount;
+    }
+};
+
+struct RecordHeader {
+    int64_t  timestamp;    // ns
+    uint32_t payloadBytes; // stored size of the payload
+    uint32_t reserved;
+};
+
+struct IndexEntry {
+    int64_t  timestamp;
+    uint64_t offset; // of the RecordHeader
+};
+
+struct Footer {
+    uint64_t            indexOffset;
+    uint64_t            records;
+    std::array<char, 8> magic = INDEX_MAGIC;
+};
+
+static_assert(sizeof(FileHeader) == 72 && sizeof(RecordHeader) == 16 && sizeof(IndexEntry) == 16 && sizeof(Footer) == 24, "capture layout must not depend on padding");
+
+// delta on the bit patterns, byte shuffle and zero run-length encoding, appended to out
+inline void compress(std::span<const float> values, std::vector<uint8_t> &out, std::vector<uint8_t> &scratch) {
+    const size_t n = values.size();
+    scratch.resize(4 * n);
+    uint32_t previous = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t bits;
+        std::memcpy(&bits, &values[i], sizeof(bits));
+        const uint32_t delta = bits - previous;
+        previous             = bits;
+        for (size_t b = 0; b < 4; b++) {
+            scratch[b * n + i] = static_cast<uint8_t>(delta >> (8 * b));
+        }
+    }
+    // control byte 0x80 | (k - 1): k zero bytes, control byte k - 1: k literal bytes follow
+    size_t i = 0;
+    while (i < scratch.size()) {
+        size_t run = 0;
+        while (i + run < scratch.size() && scratch[i + run] == 0 && run < 128) {
+            run++;
+        }
+        if (run > 0) {
+            out.push_back(static_cast<uint8_t>(0x80 | (run - 1)));
+            i += run;
+            continue;
+        }
+        const size_t start = i;
+        while (i < scratch.size() && i - start < 128 && !(scratch[i] == 0 && i + 1 < scratch.size() && scratch[i + 1] == 0)) {
+            i++;
+        }
+        out.push_back(static_cast<uint8_t>(i - start - 1));
+        out.insert(out.end(), scratch.begin() + static_cast<std::ptrdiff_t>(start), scratch.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+}
+
+inline void decompress(std::span<const uint8_t> in, std::span<float> values, std::vector<uint8_t> &scratch) {
+    const size_t n = values.size();
+    scratch.resize(4 * n);
+    size_t o = 0;
+    for (size_t i = 0; i < in.size();) {
+        const uint8_t control = in[i++];
+        const size_t  run     = (control & 0x7f) + 1U;
+        if (o + run > scratch.size() || (!(control & 0x80) && i + run > in.size())) {
+            throw std::runtime_error("Corrupt compressed capture record");
+        }
+        if (control & 0x80) {
+            std::fill_n(scratch.begin() + static_cast<std::ptrdiff_t>(o), run, uint8_t{ 0 });
+        } else {
+            std::copy_n(in.begin() + static_cast<std::ptrdiff_t>(i), run, scratch.begin() + static_cast<std::ptrdiff_t>(o));
+            i += run;
+        }
+        o += run;
+    }
+    if (o != scratch.size()) {
+        throw std::runtime_error("Corrupt compressed capture record");
+    }
+    uint32_t previous = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t delta = 0;
+        for (size_t b = 0; b < 4; b++) {
+            delta |= static_cast<uint32_t>(scratch[b * n + i]) << (8 * b);
+        }
+        previous += delta;
+        std::memcpy(&values[i], &previous, sizeof(previous));
+    }
+}
+
+class Writer {
+    std::ofstream           _file;
+    FileHeader              _header;
+    std::vector<IndexEntry> _index;
+    uint64_t                _offset = 0;
+    std::vector<uint8_t>    _payload;
+    std::vector<uint8_t>    _scratch;
+
+public:
+    Writer(const std::string &path, uint32_t vectorSize, float sampleRate, const std::string &modelVersion, bool compressed = false)
+        : _file(path, std::ios::binary | std::ios::trunc) {
+        if (!_file) {
+            throw std::runtime_error("Could not create capture " + path);
+        }
+        _header.flags        = compressed ? FLAG_COMPRESSED : 0;
+        _header.vectorSize   = vectorSize;
+        _header.spectrumSize = vectorSize / 2;
+        _header.sampleRate   = sampleRate;
+        std::copy_n(modelVersion.begin(), std::min(modelVersion.size(), _header.modelVersion.size() - 1), _header.modelVersion.begin());
+        _file.write(reinterpret_cast<const char *>(&_header), sizeof(_header));
+        _offset = sizeof(_header);
+    }
+
+    Writer(const Writer &)            = delete;
+    Writer &operator=(const Writer &) = delete;
+
+    ~Writer() {
+        close();
+    }
+
+    const FileHeader &header() const {
+        return _header;
+    }
+
+    void write(int64_t timestamp, std::span<const float> dataPoint) {
+        if (dataPoint.size() != _header.recordSize()) {
+            throw std::invalid_argument("Capture record of " + std::to_string(dataPoint.size()) + " values, expected " + std::to_string(_header.recordSize()));
+        }
+        const char *payload = reinterpret_cast<const char *>(dataPoint.data());
+        size_t      bytes   = dataPoint.size_bytes();
+        if (_header.flags & FLAG_COMPRESSED) {
+            _payload.clear();
+            compress(dataPoint, _payload, _scratch);
+            payload = reinterpret_cast<const char *>(_payload.data());
+            bytes   = _payload.size();
+        }
+        const RecordHeader record{ timestamp, static_cast<uint32_t>(bytes), 0 };
+        _file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+        _file.write(payload, static_cast<std::streamsize>(bytes));
+        _index.push_back({ timestamp, _offset });
+        _offset += sizeof(record) + bytes;
+    }
+
+    size_t records() const {
+        return _index.size();
+    }
+
+    // appends the index, the capture is complete afterwards
+    void close() {
+        if (!_file.is_open()) {
+            return;
+        }
+        const Footer footer{ _offset, _index.size() };
+        _file.write(reinterpret_cast<const char *>(_index.data()), static_cast<std::streamsize>(_index.size() * sizeof(IndexEntry)));
+        _file.write(reinterpret_cast<const char *>(&footer), sizeof(footer));
+        _file.close();
+    }
+};
+
+class Reader {
+    const uint8_t          *_mapping    = nullptr;
+    size_t                  _bytes      = 0;
+    uint64_t                _recordsEnd = 0; // the index offset, or the file size without index
+    FileHeader              _header;
+    std::vector<IndexEntry> _index;
+
+public:
+    explicit Reader(const std::string &path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1) {
+            throw std::runtime_error("Could not open capture " + path);
+        }
+        struct stat fileStat {};
+        if (fstat(fd, &fileStat) == -1) {
+            ::close(fd);
+            throw std::runtime_error("Could not stat capture " + path);
+        }
+        _bytes      = static_cast<size_t>(fileStat.st_size);
+        _recordsEnd = _bytes;
+        if (_bytes < sizeof(FileHeader)) {
+            ::close(fd);
+            throw std::invalid_argument("Not a NILM capture " + path);
+        }
+        void *mapping = mmap(nullptr, _bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("Could not map capture " + path);
+        }
+        _mapping = static_cast<const uint8_t *>(mapping);
+
+        std::memcpy(&_header, _mapping, sizeof(_header));
+        if (_header.magic != MAGIC || _header.version != VERSION) {
+            munmap(mapping, _bytes);
+            throw std::invalid_argument("Not a NILM capture " + path);
+        }
+        if (!readIndex()) {
+            scanRecords();
+        }
+    }
+
+    Reader(const Reader &)            = delete;
+    Reader &operator=(const Reader &) = delete;
+
+    ~Reader() {
+        munmap(const_cast<uint8_t *>(_mapping), _bytes);
+    }
+
+    // true if the file starts with the capture magic (raw captures do not)
+    static bool isCapture(const std::string &path) {
+        std::ifstream       file(path, std::ios::binary);
+        std::array<char, 8> magic{};
+        return file.read(magic.data(), magic.size()) && magic == MAGIC;
+    }
+
+    const FileHeader &header() const {
+        return _header;
+    }
+
+    size_t records() const {
+        return _index.size();
+    }
+
+    int64_t timestamp(size_t i) const {
+        return _index[i].timestamp;
+    }
+
+    // decodes record i into dataPoint, thread-safe as long as every thread has its own buffers
+    void read(size_t i, std::vector<float> &dataPoint, std::vector<uint8_t> &scratch) const {
+        RecordHeader record{};
+        if (!readRecordHeader(_index[i].offset, record)) {
+            throw std::runtime_error("Corrupt capture record " + std::to_string(i));
+        }
+        const uint8_t *payload = _mapping + _index[i].offset + sizeof(record);
+        dataPoint.resize(_header.recordSize());
+        if (_header.flags & FLAG_COMPRESSED) {
+            decompress({ payload, record.payloadBytes }, dataPoint, scratch);
+        } else {
+            std::memcpy(dataPoint.data(), payload, dataPoint.size() * sizeof(float));
+        }
+    }
+
+    void read(size_t i, std::vector<float> &dataPoint) const {
+        std::vector<uint8_t> scratch;
+        read(i, dataPoint, scratch);
+    }
+
+private:
+    bool readIndex() {
+        if (_bytes < sizeof(FileHeader) + sizeof(Footer)) {
+            return false;
+        }
+        Footer footer{};
+        std::memcpy(&footer, _mapping + _bytes - sizeof(footer), sizeof(footer));
+        const uint64_t indexBytes = _bytes - sizeof(FileHeader) - sizeof(Footer);
+        if (footer.magic != INDEX_MAGIC || footer.records > indexBytes / sizeof(IndexEntry) || footer.indexOffset != _bytes - sizeof(Footer) - footer.records * sizeof(IndexEntry)) {
+            return false;
+        }
+        _recordsEnd = footer.indexOffset;
+        _index.resize(footer.records);
+        std::memcpy(_index.data(), _mapping + footer.indexOffset, _index.size() * sizeof(IndexEntry));
+        // an entry pointing outside the records means a damaged index, the records themselves may still be fine
+        RecordHeader record{};
+        const bool   valid = std::ranges::all_of(_index, [&](const IndexEntry &entry) { return readRecordHeader(entry.offset, record); });
+        if (!valid) {
+            _index.clear();
+        }
+        return valid;
+    }
+
+    // false unless a record with a plausible payload size starts at offset and ends before the index
+    bool readRecordHeader(uint64_t offset, RecordHeader &record) const {
+        if (offset < sizeof(FileHeader) || offset > _recordsEnd || _recordsEnd - offset < sizeof(RecordHeader)) {
+            return false;
+        }
+        std::memcpy(&record, _mapping + offset, sizeof(record));
+        const bool plausible = (_header.flags & FLAG_COMPRESSED) ? record.payloadBytes > 0 : record.payloadBytes == _header.recordSize() * sizeof(float);
+        return plausible && record.payloadBytes <= _recordsEnd - offset - sizeof(record);
+    }
+
+    // recovers the records of a capture without index, a truncated last record is dropped
+    void scanRecords() {
+        uint64_t     offset = sizeof(FileHeader);
+        RecordHeader record{};
+        while (readRecordHeader(offset, record)) {
+            _index.push_back({ record.timestamp, offset });
+            offset += sizeof(record) + record.payloadBytes;
+        }
+    }
+};
+
+} // namespace nilm_capture
+
+#endif /* NILM_CAPTURE_H */
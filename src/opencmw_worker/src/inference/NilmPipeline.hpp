@@ -0,0 +1,88 @@
+#ifndef NILM_PIPELINE_H
+#define NILM_PIPELINE_H
+
+#include "InferenceBackend.hpp"
+#include "SwitchDetector.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * Per data point part of the NILM inference shared by NilmPredictWorker and
+ * the offline replay: switch detection, classification by the backend and
+ * holding the last disaggregation in between.
+ *
+ * The backend observes every data point, so its window is current when the
+ * switch detector opens the gate, only its classification is gated.
+ */
+class NilmPipeline {
+    std::unique_ptr<InferenceBackend> _backend;
+    SwitchDetector                    _switchDetector;
+    std::atomic<bool>                 _switchDetection{ true };
+
+public:
+    explicit NilmPipeline(std::unique_ptr<InferenceBackend> backend, SwitchDetector::Settings settings = {})
+        : _backend(std::move(backend)), _switchDetector(settings) {
+        if (!_backend) {
+            throw std::invalid_argument("NilmPipeline: no inference backend");
+        }
+    }
+
+    // data point features for a sink vector size: voltage, current and apparent power spectrum (first half each) and P Q S phi
+    static constexpr size_t featureCount(size_t vectorSize) {
+        return 3 * (vectorSize / 2) + 4;
+    }
+
+    // feeds the switch detector, returns true if the data point has to be classified
+    bool switching(const std::vector<float> &dataPoint) {
+        const size_t                 spectrumSize = (dataPoint.size() - 4) / 3;
+        const std::span<const float> apparentPowerSpectrum(dataPoint.data() + 2 * spectrumSize, spectrumSize);
+        const float                 *pqsPhi = dataPoint.data() + 3 * spectrumSize;
+        return _switchDetector.update(apparentPowerSpectrum, pqsPhi[0], pqsPhi[1], pqsPhi[2]) || !_switchDetection;
+    }
+
+    void observe(const std::vector<float> &dataPoint) {
+        _backend->observe(dataPoint);
+    }
+
+    // result for the data point observed last
+    void classify(std::vector<float> &values) {
+        _backend->classify(values);
+    }
+
+    // same as the model for frames without a switching event: "unknown" is the apparent power not assigned to known appliances
+    static void hold(std::vector<float> &values, float apparentPower) {
+        const float knownPower = std::accumulate(values.begin(), values.end() - 1, 0.0f);
+        values.back()          = std::max(apparentPower - knownPower, 0.0f);
+    }
+
+    // classifies only around load changes, in steady state the previous disaggregation is held, returns true if the model ran
+    bool process(const std::vector<float> &dataPoint, std::vector<float> &values) {
+        observe(dataPoint);
+        if (switching(dataPoint) || values.empty()) {
+            classify(values);
+            return true;
+        }
+        hold(values, dataPoint[dataPoint.size() - 2]);
+        return false;
+    }
+
+    void setSwitchDetection(bool enabled) {
+        _switchDetection = enabled;
+    }
+
+    const InferenceBackend &backend() const {
+        return *_backend;
+    }
+
+    const SwitchDetector &switchDetector() const {
+        return _switchDetector;
+    }
+};
+
+#endif /* NILM_PIPELINE_H */
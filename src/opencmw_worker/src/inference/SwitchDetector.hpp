@@ -0,0 +1,146 @@
+#ifndef SWITCH_DETECTOR_H
+#define SWITCH_DETECTOR_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/*
+ * Streaming detector for load changes, gating the NILM inference.
+ *
+ * P, Q and S each run a two-sided CUSUM of their deviation from a slowly
+ * tracked baseline, relative to the baseline level. The apparent power
+ * spectrum is compared to a reference spectrum (mean absolute difference in
+ * dB). Either of them firing opens the gate for holdFrames frames, long
+ * enough for the model's rolling window to see the whole transition.
+ */
+class SwitchDetector {
+public:
+    struct Settings {
+        float    drift            = 0.01f;  // relative deviation tolerated without accumulating
+        float    threshold        = 0.15f;  // relative accumulated deviation triggering an event
+        float    minPower         = 1.0f;   // lower limit of the baseline used for normalisation
+        float    baselineWeight   = 0.01f;  // EWMA weight of the baselines while no event is detected
+        float    spectralDistance = 3.0f;   // mean |difference| in dB triggering an event, 0 disables the spectral check
+        uint32_t holdFrames       = 32;     // frames passed to the model after an event (3x the Gupta window + margin)
+    };
+
+private:
+    static constexpr size_t N_POWERS = 3; // P Q S
+
+    Settings                    _settings;
+    std::array<float, N_POWERS> _baseline{};
+    std::array<float, N_POWERS> _cusumHigh{};
+    std::array<float, N_POWERS> _cusumLow{};
+    std::vector<float>          _referenceSpectrum; // dB
+    std::vector<float>          _spectrumDb;        // current frame
+    bool                        _initialised     = false;
+    uint32_t                    _remainingFrames = 0;
+    uint64_t                    _events          = 0;
+    uint64_t                    _frames          = 0;
+    uint64_t                    _activeFrames    = 0;
+
+public:
+    SwitchDetector() = default;
+    explicit SwitchDetector(Settings settings)
+        : _settings(settings) {}
+
+    // feeds one frame, returns true if the frame should go through the model
+    bool update(std::span<const float> spectrum, float realPower, float reactivePower, float apparentPower) {
+        _frames++;
+        const std::array<float, N_POWERS> powers{ realPower, reactivePower, apparentPower };
+        _spectrumDb.resize(spectrum.size());
+        std::transform(spectrum.begin(), spectrum.end(), _spectrumDb.begin(), toDb);
+        if (!_initialised || _referenceSpectrum.size() != spectrum.size()) {
+            rebase(powers);
+            _initialised = true;
+            return open();
+        }
+
+        bool event = false;
+        for (size_t k = 0; k < N_POWERS; k++) {
+            const float deviation = (powers[k] - _baseline[k]) / std::max(std::abs(_baseline[k]), _settings.minPower);
+            _cusumHigh[k]         = std::max(0.0f, _cusumHigh[k] + deviation - _settings.drift);
+            _cusumLow[k]          = std::max(0.0f, _cusumLow[k] - deviation - _settings.drift);
+            event                 = event || _cusumHigh[k] > _settings.threshold || _cusumLow[k] > _settings.threshold;
+        }
+        if (!event && _settings.spectralDistance > 0.0f) {
+            event = spectralDistance() > _settings.spectralDistance;
+        }
+
+        if (event) {
+            _events++;
+            rebase(powers);
+            return open();
+        }
+
+        // follow slow drifts of the steady state
+        const float weight = _settings.baselineWeight;
+        for (size_t k = 0; k < N_POWERS; k++) {
+            _baseline[k] += weight * (powers[k] - _baseline[k]);
+        }
+        if (_settings.spectralDistance > 0.0f) {
+            for (size_t i = 0; i < _spectrumDb.size(); i++) {
+                _referenceSpectrum[i] += weight * (_spectrumDb[i] - _referenceSpectrum[i]);
+            }
+        }
+
+        if (_remainingFrames > 0) {
+            _remainingFrames--;
+            _activeFrames++;
+            return true;
+        }
+        return false;
+    }
+
+    void reset() {
+        _initialised     = false;
+        _remainingFrames = 0;
+    }
+
+    // number of detected events, frames seen and frames passed to the model
+    uint64_t events() const {
+        return _events;
+    }
+    uint64_t frames() const {
+        return _frames;
+    }
+    uint64_t activeFrames() const {
+        return _activeFrames;
+    }
+
+private:
+    // mean |current - reference| in dB
+    float spectralDistance() const {
+        if (_spectrumDb.empty()) {
+            return 0.0f;
+        }
+        float sum = 0.0f;
+        for (size_t i = 0; i < _spectrumDb.size(); i++) {
+            sum += std::abs(_spectrumDb[i] - _referenceSpectrum[i]);
+        }
+        return sum / static_cast<float>(_spectrumDb.size());
+    }
+
+    static float toDb(float value) {
+        return 10.0f * std::log10(std::max(value, 1e-12f));
+    }
+
+    bool open() {
+        _remainingFrames = _settings.holdFrames;
+        _activeFrames++;
+        return true;
+    }
+
+    void rebase(const std::array<float, N_POWERS> &powers) {
+        _baseline = powers;
+        _cusumHigh.fill(0.0f);
+        _cusumLow.fill(0.0f);
+        _referenceSpectrum = _spectrumDb;
+    }
+};
+
+#endif /* SWITCH_DETECTOR_H */
@@ -0,0 +1,41 @@
+#ifndef TENSORFLOW_BACKEND_H
+#define TENSORFLOW_BACKEND_H
+
+#include "InferenceBackend.hpp"
+
+#include <cppflow/cppflow.h>
+#include <cppflow/model.h>
+#include <cppflow/ops.h>
+#include <cppflow/tensor.h>
+
+#include <string>
+#include <vector>
+
+// exported TF graph (tf_gupta_clf.py) loaded through cppflow
+class TensorflowBackend : public InferenceBackend {
+    cppflow::model     _model;
+    std::vector<float> _values; // output for the data point observed last
+
+public:
+    static constexpr const char *DEFAULT_MODEL_PATH = "src/model/nilm_model";
+
+    explicit TensorflowBackend(const std::string &modelPath = DEFAULT_MODEL_PATH)
+        : _model(modelPath) {}
+
+    // the window lives inside the graph, which cannot be split, so every data point runs the whole model
+    void observe(const std::vector<float> &dataPoint) override {
+        cppflow::tensor input(dataPoint, { static_cast<int64_t>(dataPoint.size()) });
+        auto            output = _model({ { "serving_default_args_0:0", input } }, { "StatefulPartitionedCall:0" });
+        _values                = output[0].get_data<float>();
+    }
+
+    void classify(std::vector<float> &values) override {
+        values = _values;
+    }
+
+    std::string name() const override {
+        return "tensorflow";
+    }
+};
+
+#endif /* TENSORFLOW_BACKEND_H */
@@ -0,0 +1,185 @@
+#ifndef ENERGY_HISTORY_H
+#define ENERGY_HISTORY_H
+
+#include <boost/circular_buffer.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/*
+ * Energy usage per device in fixed-width time buckets at several resolutions.
+ *
+ * Every tier is updated with every integrated segment, fine tiers keep a short
+ * history and coarse tiers a long one. The memory is bounded by the tier
+ * capacities no matter how long the system runs. Each tier also keeps running
+ * prefix sums, so the energy of any interval costs two binary searches.
+ */
+class EnergyHistory {
+public:
+    static constexpr int64_t SECOND_NS = 1'000'000'000;
+    static constexpr int64_t MINUTE_NS = 60 * SECOND_NS;
+    static constexpr int64_t HOUR_NS   = 60 * MINUTE_NS;
+
+    struct Tier {
+        int64_t                         width; // bucket width in ns
+        boost::circular_buffer<int64_t> starts; // ascending, buckets without usage are not stored
+        boost::circular_buffer<double>  energy;     // devices per bucket
+        boost::circular_buffer<double>  cumulative; // devices per bucket, energy of all buckets up to and including this one
+
+        // oldest instant the tier can hold once it is full
+        int64_t horizon() const {
+            return starts.empty() ? 0 : starts.back() + width - width * static_cast<int64_t>(starts.capacity());
+        }
+    };
+
+    // an hour of seconds, eight days of minutes (the week window) and two years of hours
+    static std::vector<std::pair<int64_t, size_t>> defaultTiers() {
+        return { { SECOND_NS, 3600 }, { MINUTE_NS, 8 * 24 * 60 }, { HOUR_NS, 2 * 366 * 24 } };
+    }
+
+private:
+    size_t            _devices;
+    std::vector<Tier> _tiers;   // fine to coarse
+    int64_t           _end = 0; // end of the newest segment, the newest buckets are only filled up to here
+
+    // appends an empty bucket, a full tier drops its oldest bucket
+    void appendBucket(Tier &tier, int64_t start) {
+        const bool first = tier.starts.empty();
+        tier.starts.push_back(start);
+        for (size_t i = 0; i < _devices; i++) {
+            tier.cumulative.push_back(first ? 0.0 : tier.cumulative[tier.cumulative.size() - _devices]);
+            tier.energy.push_back(0.0);
+        }
+    }
+
+    // adds fraction of energy to the bucket starting at start, appending it if it is newer than all others
+    void addToBucket(Tier &tier, int64_t start, const std::vector<float> &energy, double fraction) {
+        size_t index;
+        if (tier.starts.empty() || start > tier.starts.back()) {
+            appendBucket(tier, start);
+            index = tier.starts.size() - 1;
+        } else {
+            auto it = std::lower_bound(tier.starts.begin(), tier.starts.end(), start);
+            if (it == tier.starts.end() || *it != start) {
+                return; // older than the retained buckets
+            }
+            index = static_cast<size_t>(it - tier.starts.begin());
+        }
+        for (size_t i = 0; i < _devices; i++) {
+            const double added = fraction * static_cast<double>(energy[i]);
+            tier.energy[index * _devices + i] += added;
+            // only late samples change a bucket before the newest one
+            for (size_t later = index; later < tier.starts.size(); later++) {
+                tier.cumulative[later * _devices + i] += added;
+            }
+        }
+    }
+
+    // energy before bucket index
+    double prefix(const Tier &tier, size_t index, size_t device) const {
+        return index == 0 ? tier.cumulative[device] - tier.energy[device] : tier.cumulative[(index - 1) * _devices + device];
+    }
+
+    // fraction of the bucket inside [from, to), the newest buckets only span up to the end of the newest segment
+    double overlap(const Tier &tier, size_t index, int64_t from, int64_t to) const {
+        const int64_t start     = tier.starts[index];
+        const int64_t bucketEnd = std::max(std::min(start + tier.width, _end), start + 1);
+        const int64_t inside    = std::min(bucketEnd, to) - std::max(start, from);
+        return inside <= 0 ? 0.0 : static_cast<double>(inside) / static_cast<double>(bucketEnd - start);
+    }
+
+public:
+    explicit EnergyHistory(size_t devices, const std::vector<std::pair<int64_t, size_t>> &tiers = defaultTiers())
+        : _devices(devices) {
+        for (const auto &[width, capacity] : tiers) {
+            if (width <= 0 || capacity == 0) {
+                throw std::invalid_argument("EnergyHistory: invalid tier");
+            }
+            _tiers.push_back(Tier{ width, boost::circular_buffer<int64_t>(capacity), boost::circular_buffer<double>(capacity * devices), boost::circular_buffer<double>(capacity * devices) });
+        }
+    }
+
+    // adds the energy of each device used in [t0, t1), split over the buckets in proportion to their overlap
+    void add(int64_t t0, int64_t t1, const std::vector<float> &energy) {
+        _end = std::max(_end, t1);
+        for (auto &tier : _tiers) {
+            if (t1 <= t0) {
+                addToBucket(tier, t1 - t1 % tier.width, energy, 1.0);
+                continue;
+            }
+            const double duration = static_cast<double>(t1 - t0);
+            int64_t      from     = std::max(t0, t1 - tier.width * static_cast<int64_t>(tier.starts.capacity()));
+            while (from < t1) {
+                const int64_t start = from - from % tier.width;
+                const int64_t to    = std::min(start + tier.width, t1);
+                addToBucket(tier, start, energy, static_cast<double>(to - from) / duration);
+                from = to;
+            }
+        }
+    }
+
+    // energy per device in [from, to) from the finest tier reaching back to from, O(log buckets),
+    // buckets partially in the interval count in proportion to their overlap
+    std::vector<double> energy(int64_t from, int64_t to) const {
+        std::vector<double> result(_devices, 0.0);
+        if (to <= from || _tiers.empty()) {
+            return result;
+        }
+        auto tier = std::find_if(_tiers.begin(), _tiers.end(), [from](const Tier &t) { return t.horizon() <= from; });
+        if (tier == _tiers.end()) {
+            tier = std::prev(_tiers.end());
+        }
+        // buckets [first, last) overlap the interval
+        const auto   begin = tier->starts.begin();
+        const size_t first = static_cast<size_t>(std::lower_bound(begin, tier->starts.end(), from - tier->width + 1) - begin);
+        const size_t last  = static_cast<size_t>(std::lower_bound(begin, tier->starts.end(), to) - begin);
+        if (first >= last) {
+            return result;
+        }
+        const double firstOutside = 1.0 - overlap(*tier, first, from, to);
+        const double lastOutside  = last - 1 == first ? 0.0 : 1.0 - overlap(*tier, last - 1, from, to);
+        for (size_t i = 0; i < _devices; i++) {
+            result[i] = prefix(*tier, last, i) - prefix(*tier, first, i) - firstOutside * tier->energy[first * _devices + i] - lastOutside * tier->energy[(last - 1) * _devices + i];
+        }
+        return result;
+    }
+
+    // energy per device in consecutive intervals of resolution starting at from, the last one ends at to
+    std::vector<std::vector<double>> series(int64_t from, int64_t to, int64_t resolution) const {
+        std::vector<std::vector<double>> result;
+        if (resolution <= 0) {
+            resolution = to - from;
+        }
+        for (int64_t start = from; start < to; start += resolution) {
+            result.push_back(energy(start, std::min(start + resolution, to)));
+        }
+        return result;
+    }
+
+    // appends a bucket read back from a checkpoint, buckets have to be restored in ascending order
+    // followed by restoreEnd() with the end of the newest segment
+    void restore(size_t tier, int64_t start, const double *energy) {
+        appendBucket(_tiers.at(tier), start);
+        for (size_t i = 0; i < _devices; i++) {
+            _tiers[tier].energy[_tiers[tier].energy.size() - _devices + i] = energy[i];
+            _tiers[tier].cumulative[_tiers[tier].cumulative.size() - _devices + i] += energy[i];
+        }
+    }
+
+    void restoreEnd(int64_t end) {
+        _end = std::max(_end, end);
+    }
+
+    const std::vector<Tier> &tiers() const {
+        return _tiers;
+    }
+
+    size_t devices() const {
+        return _devices;
+    }
+};
+
+#endif /* ENERGY_HISTORY_H */
@@ -1,15 +1,27 @@
 #ifndef POWER_INTEGRATOR_H
 #define POWER_INTEGRATOR_H
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <boost/circular_buffer.hpp>
+#include <cerrno>
 #include <chrono>
 #include <cmath>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <time.h>
 #include <vector>
 
+#include "EnergyHistory.hpp"
+
 class PowerIntegrator {
 private:
     size_t                          _amount_of_devices;
@@ -20,43 +32,113 @@ private:
     int64_t                         last_timestamp;
     int64_t                         start_timestamp;
 
-    std::vector<int64_t>            _timestamps;
-    std::vector<int64_t>            _timestamps_week;
-
-    std::vector<std::vector<float>> _devices_values;
-    std::vector<std::vector<float>> _devices_values_last_week;
+    // raw samples of the last minutes, older usage is kept in the buckets of _history
+    boost::circular_buffer<int64_t> _timestamps;
+    boost::circular_buffer<float>   _values; // _amount_of_devices per sample
+    EnergyHistory                   _history;
+    std::vector<float>              _segment; // usage of the last segment per device
 
     int                             _month[2]; // 0 - month, 1 year
+    int64_t                         _month_start      = 0;
+    int64_t                         _next_month_start = 0;
+
+    // current cumulate power usage of devices in this month, last 24 hours and week are summed from _history
+    std::vector<double> power_usages_month;
+
+    std::mutex          _mutex; // update() runs in the prediction thread, queries come from the workers
+
+    bool                init         = false;
+    bool                _init_usage  = false;
+    bool                _init_day    = false;
+    bool                _init_month  = false;
+    int                 _counter     = 0;
+
+    const float         _unit_faktor = 0.000000000000001f / 3.6f;
+
+    int                 _journal_fd = -1;
+    std::vector<char>   _journal_record; // reused per update
+
+    const std::string   file_checkpoint = "integrator_checkpoint.bin";
+    const std::string   file_journal    = "integrator_journal.bin";
+
+    bool                check_same_day(int64_t t_0, int64_t t_1);
+    bool                check_same_week(int64_t t_0, int64_t t_1);
+    bool                check_same_month(int64_t t_0, int64_t t_1);
+    bool                check_same_calendar_day(int64_t t_0, int64_t t_1);
+    bool                check_month(int64_t timestamp);
+
+    void                reset_month(int64_t timestamp);
+    void                set_month(int month, int year);
+
+    // sample ring
+    static constexpr int64_t        DAY_NS       = 86'400'000'000'000;
+    static constexpr int64_t        WEEK_NS      = 7 * DAY_NS;
+    static constexpr int64_t        RAW_NS       = 10 * 60'000'000'000LL;
+    static constexpr size_t         MIN_CAPACITY = 1024; // samples, the ring doubles when full
+
+    void                            push_sample(int64_t timestamp, const std::vector<float> &values, bool accumulate);
+    void                            slide_windows(int64_t timestamp);
+    float                           segment_usage(size_t device, size_t sample);
+
+    /*
+     * Persistence: every update appends its sample to the journal, every save_interval updates the raw
+     * samples, the energy history and the month usage are written to a checkpoint and the journal restarts.
+     * Startup maps the checkpoint and replays the journal, both are bounded in size.
+     */
+    static constexpr char           JOURNAL_MAGIC[8]    = { 'P', 'I', 'J', 'O', 'U', 'R', '1', '\0' };
+    static constexpr char           CHECKPOINT_MAGIC[8] = { 'P', 'I', 'C', 'K', 'P', 'T', '2', '\0' };
+
+    struct JournalHeader {
+        char     magic[8];
+        uint32_t devices;
+        uint32_t reserved;
+    }; // followed by records of int64_t timestamp and float values[devices]
+
+    struct CheckpointHeader {
+        char     magic[8];
+        uint32_t devices;
+        int32_t  month;
+        int32_t  year;
+        uint32_t tiers;
+        int64_t  samples;
+    }; // followed by double month_usage[devices], int64_t timestamps[samples], float values[samples][devices]
+       // and per tier int64_t width, int64_t buckets, int64_t starts[buckets] and double energy[buckets][devices]
+
+    // read-only mapping of a persistence file, empty if it does not exist
+    struct MappedFile {
+        const char *data  = nullptr;
+        size_t      bytes = 0;
+
+        explicit MappedFile(const std::string &path) {
+            const int   fd        = ::open(path.c_str(), O_RDONLY);
+            struct stat fileStat {};
+            if (fd == -1) {
+                return;
+            }
+            if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0) {
+                void *mapping = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapping != MAP_FAILED) {
+                    data  = static_cast<const char *>(mapping);
+                    bytes = static_cast<size_t>(fileStat.st_size);
+                }
+            }
+            ::close(fd);
+        }
+        MappedFile(const MappedFile &)            = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        ~MappedFile() {
+            if (data != nullptr) {
+                munmap(const_cast<char *>(data), bytes);
+            }
+        }
+    };
 
-    // current cumulate power usage of devices
-    std::vector<float> power_usages_month;
-    std::vector<float> power_usages_week;
-    std::vector<float> power_usages_day;
-
-    bool               init         = false;
-    bool               _init_usage  = false;
-    bool               _init_day    = false;
-    bool               _init_week   = false;
-    bool               _init_month  = false;
-    int                _counter     = 0;
-
-    const float        _unit_faktor = 0.000000000000001f / 3.6f;
-
-    void               save_values_to_file();
-    bool               read_values_from_file();
-    void               save_month_usage();
-    bool               read_month_usage();
-
-    const std::string  file_month  = "month_usage.txt";
-    const std::string  file_values = "time_values.txt";
-
-    bool               check_same_day(int64_t t_0, int64_t t_1);
-    bool               check_same_week(int64_t t_0, int64_t t_1);
-    bool               check_same_month(int64_t t_0, int64_t t_1);
-    bool               check_same_calendar_day(int64_t t_0, int64_t t_1);
-    bool               check_month(int64_t timestamp);
-
-    void               reset_month(int64_t timestamp);
+    size_t                          sample_bytes() const;
+    bool                            read_checkpoint();
+    void                            save_checkpoint();
+    void                            replay_journal();
+    void                            open_journal();
+    void                            append_journal(int64_t timestamp, const std::vector<float> &values);
 
 public:
     void                                  update(int64_t timestamp, std::vector<float> &values);
@@ -65,10 +147,12 @@ public:
     const std::vector<float>              get_power_usages_day();
     bool                                  get_init();
     const std::vector<std::vector<float>> get_devices_values();
-    const std::vector<std::vector<float>> get_devices_values_last_week();
-
     const std::vector<int64_t>            get_timestamps();
-    const std::vector<int64_t>            get_timestamps_week();
+    // copy of the bucket history taken under the lock, update() keeps rolling up buckets in the meantime
+    EnergyHistory                         get_history();
+    int64_t                               get_last_timestamp();
+    // energy per device in kWh for consecutive intervals of resolution in [from, to), safe to call while another thread updates
+    std::vector<std::vector<double>>      get_energy_series(int64_t from, int64_t to, int64_t resolution);
 
     float                                 calculate_usage(int64_t t_0, float last_value,
                                             int64_t t_1, float current_value);
@@ -83,7 +167,7 @@ PowerIntegrator::PowerIntegrator(std::vector<std::string> &devices, const std::s
     : PowerIntegrator(devices.size(), data_path, save_interval) {}
 
 PowerIntegrator::PowerIntegrator(const size_t amount_of_devices, const std::string data_path, const int save_interval)
-    : _amount_of_devices(amount_of_devices), _data_path(data_path), _save_interval(save_interval) {
+    : _amount_of_devices(amount_of_devices), _data_path(data_path), _save_interval(save_interval), _history(amount_of_devices), _segment(amount_of_devices, 0.0f) {
     start_timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
 
     fmt::print("\tcurrent path {0}\n", std::filesystem::current_path());
@@ -92,25 +176,22 @@ PowerIntegrator::PowerIntegrator(const size_t amount_of_devices, const std::stri
         fmt::print("Cannot create or open {}\n", data_path);
     }
 
-    // init usage day, week, month
-    for (size_t i = 0; i < _amount_of_devices; i++) {
-        power_usages_day.push_back(0.0f);
-        power_usages_week.push_back(0.0f);
-        power_usages_month.push_back(0.0f);
-    }
+    // init usage month
+    power_usages_month.assign(_amount_of_devices, 0.0);
 
-    // initialization of vectors with values
-    for (size_t i = 0; i < _amount_of_devices; i++) {
-        std::vector<float> values;
-        _devices_values.push_back(values);
-        std::vector<float> values_week;
-        _devices_values_last_week.push_back(values_week);
-    }
+    _timestamps.set_capacity(MIN_CAPACITY);
+    _values.set_capacity(MIN_CAPACITY * _amount_of_devices);
 
-    fmt::print("Read month values\n");
-    read_month_usage();
-    fmt::print("Read week and day values\n");
-    read_values_from_file();
+    fmt::print("Read checkpoint and journal\n");
+    read_checkpoint();
+    replay_journal();
+    if (!_timestamps.empty()) {
+        _init_day = check_same_day(_timestamps.back(), start_timestamp);
+        if (_init_day) {
+            last_timestamp = _timestamps.back();
+        }
+    }
+    open_journal();
 
     if (!_init_month) {
         reset_month(start_timestamp);
@@ -118,37 +199,31 @@ PowerIntegrator::PowerIntegrator(const size_t amount_of_devices, const std::stri
     }
 
     if (!_init_day) {
-        // add to time stamp to week and update value
-        if (_init_week) {
-            auto last_week_timestamp = _timestamps_week.back();
-            for (size_t i = 0; i < _amount_of_devices; i++) {
-                auto  last_week_value = _devices_values_last_week.at(i).back();
-
-                float value           = calculate_usage(last_week_timestamp, last_week_value,
-                                  last_week_timestamp + 100, 0.0f);
-                _devices_values_last_week.at(i).push_back(0.0f);
-                power_usages_week.at(i) += value;
-            }
-            _timestamps_week.push_back(last_week_timestamp + 100);
-        }
-
-        _timestamps.push_back(start_timestamp);
-        for (size_t i = 0; i < _amount_of_devices; i++) {
-            _devices_values.at(i).push_back(0.0f);
+        std::vector<float> zeros(_amount_of_devices, 0.0f);
+        // end the saved samples with zero power, so the time without data does not count
+        if (!_timestamps.empty()) {
+            push_sample(_timestamps.back() + 100, zeros, true);
+            append_journal(_timestamps.back(), zeros);
         }
+        push_sample(start_timestamp, zeros, true);
+        append_journal(start_timestamp, zeros);
+        slide_windows(start_timestamp);
         last_timestamp = start_timestamp;
     }
     init = _init_day;
 
     fmt::print("Size of timestamps: {}\n", _timestamps.size());
-    fmt::print("Size of values: {}\n", _devices_values[0].size());
+    fmt::print("Size of values: {}\n", _values.size() / std::max<size_t>(_amount_of_devices, 1));
 
     fmt::print("---usages-------Usage in month: {}\n", power_usages_month);
-    fmt::print("---usages-------Usage in week: {}\n", power_usages_week);
-    fmt::print("---usages-------Usage in day: {}\n", power_usages_day);
+    fmt::print("---usages-------Usage in week: {}\n", get_power_usages_week());
+    fmt::print("---usages-------Usage in day: {}\n", get_power_usages_day());
 }
 
 PowerIntegrator::~PowerIntegrator() {
+    if (_journal_fd != -1) {
+        ::close(_journal_fd);
+    }
 }
 
 bool PowerIntegrator::create_directory(std::string directory_path) {
@@ -177,6 +252,8 @@ bool PowerIntegrator::create_directory(std::string directory_path) {
 void PowerIntegrator::update(int64_t timestamp, std::vector<float> &values) {
     if (timestamp == 0) return;
 
+    std::scoped_lock lock(_mutex);
+
     if (last_timestamp == timestamp) return;
 
     if (!check_month(timestamp)) {
@@ -186,75 +263,21 @@ void PowerIntegrator::update(int64_t timestamp, std::vector<float> &values) {
         reset_month(timestamp);
     }
 
-    for (size_t i = 0; i < _amount_of_devices; i++) {
-        auto  last_power         = _devices_values.at(i).back();
-
-        float last_segment_usage = calculate_usage(last_timestamp, last_power,
-                timestamp, values[i]);
-
-        power_usages_day.at(i) += last_segment_usage;
-        power_usages_week.at(i) += last_segment_usage;
-        power_usages_month.at(i) += last_segment_usage;
-    }
-
-    for (size_t i = 0; i < values.size(); i++) {
-        _devices_values.at(i).push_back(values[i]);
-    }
-
-    size_t timestamps_size = _timestamps.size();
-    while (timestamps_size > 0 && !check_same_day(_timestamps.front(), timestamp)) {
-        auto headTimestamp = _timestamps.front();
-        _timestamps.erase(_timestamps.begin());
-        for (size_t i = 0; i < _amount_of_devices; i++) {
-            auto value = _devices_values.at(i).front();
-            _devices_values.at(i).erase(_devices_values.at(i).begin());
-
-            if (_init_week) {
-                _devices_values_last_week.at(i).push_back(value);
-            } else {
-                std::vector<float> week_values;
-                week_values.push_back(value);
-                _devices_values_last_week.push_back(week_values);
-            }
-
-            float old_usage = calculate_usage(headTimestamp, value, _timestamps.front(), _devices_values.at(i).front());
-            power_usages_day.at(i) -= old_usage;
-        }
-
-        _init_week = true;
-        _timestamps_week.push_back(headTimestamp);
-    }
-
-    while (_init_week && !check_same_week(_timestamps_week.front(), timestamp)) {
-        auto headWeekTimestamp = _timestamps_week.front();
-        _timestamps_week.erase(_timestamps_week.begin());
-        auto firstValues = _devices_values_last_week.front();
-        for (size_t i = 0; i < _amount_of_devices; i++) {
-            auto removedValue = _devices_values_last_week.at(i).front();
-            _devices_values_last_week.at(i).erase(_devices_values_last_week.at(i).begin());
-
-            auto powerValue = calculate_usage(headWeekTimestamp, removedValue,
-                    _timestamps_week.front(), _devices_values_last_week.at(i).front());
-
-            power_usages_week.at(i) -= powerValue;
-        }
-    }
+    push_sample(timestamp, values, true);
+    append_journal(timestamp, values);
+    slide_windows(timestamp);
 
     last_timestamp = timestamp;
-    _timestamps.push_back(timestamp);
 
     _counter++;
 
     if (_counter == _save_interval) {
-        fmt::print("Save data from integrator\n");
-        fmt::print("Save month data\n");
-        save_month_usage();
-        fmt::print("Save week and day data\n");
-        save_values_to_file();
+        fmt::print("Save checkpoint of integrator\n");
+        save_checkpoint();
         _counter = 0;
         fmt::print("---usages-------Usage in month: {}\n", power_usages_month);
-        fmt::print("---usages-------Usage in week: {}\n", power_usages_week);
-        fmt::print("---usages-------Usage in day: {}\n", power_usages_day);
+        fmt::print("---usages-------Usage in week: {}\n", _history.energy(last_timestamp - WEEK_NS, last_timestamp));
+        fmt::print("---usages-------Usage in day: {}\n", _history.energy(last_timestamp - DAY_NS, last_timestamp));
     }
 }
 
@@ -274,178 +297,256 @@ float PowerIntegrator::calculate_usage(int64_t t_0, float last_value, int64_t t_
     }
 }
 
-bool PowerIntegrator::read_values_from_file() {
-    std::string        file_path = _data_path + file_values;
-    std::ifstream      values_file(file_path.c_str(), std::ios_base::in);
-
-    std::vector<float> previous_values    = {};
-    int64_t            previous_timestamp = 0;
-
-    if (values_file.good()) {
-        int64_t     time_saved;
-        std::string line;
-
-        // read save time
-        if (std::getline(values_file, line)) {
-            if (line.length() > 0) {
-                std::istringstream iss(line);
-                iss >> time_saved;
-            } else {
-                values_file.close();
-                return false;
-            }
-        } else {
-            values_file.close();
-            return false;
-        }
+// appends a sample, the segment from the previous sample is added to the month usage and the history if accumulate is set
+void PowerIntegrator::push_sample(int64_t timestamp, const std::vector<float> &values, bool accumulate) {
+    if (_timestamps.full()) {
+        _timestamps.set_capacity(2 * _timestamps.capacity());
+        _values.set_capacity(2 * _values.capacity());
+    }
+    const bool first = _timestamps.empty();
+    _timestamps.push_back(timestamp);
+    for (size_t i = 0; i < _amount_of_devices; i++) {
+        _values.push_back(i < values.size() ? values[i] : 0.0f);
+    }
+    if (first || !accumulate) {
+        return;
+    }
+    const size_t sample = _timestamps.size() - 2;
+    for (size_t i = 0; i < _amount_of_devices; i++) {
+        _segment[i] = segment_usage(i, sample);
+        power_usages_month[i] += _segment[i];
+    }
+    _history.add(_timestamps[sample], timestamp, _segment);
+}
 
-        // the data is too old
-        if (!check_same_week(time_saved, start_timestamp)) {
-            values_file.close();
-            return false;
-        }
+// keeps the raw samples of the last RAW_NS, the newest sample always stays
+void PowerIntegrator::slide_windows(int64_t timestamp) {
+    while (_timestamps.size() > 1 && _timestamps.front() < timestamp - RAW_NS) {
+        _timestamps.pop_front();
+        _values.erase_begin(_amount_of_devices);
+    }
+}
 
-        while (std::getline(values_file, line)) {
-            if (line.length() > 0) {
-                int64_t            timestamp;
-                std::istringstream iss(line);
-                iss >> timestamp;
-                // same week
-                if (check_same_week(timestamp, start_timestamp)) {
-                    if (check_same_day(timestamp, start_timestamp)) {
-                        _timestamps.push_back(timestamp);
-                        for (size_t i = 0; i < _amount_of_devices; i++) {
-                            float value;
-                            iss >> value;
-                            _devices_values.at(i).push_back(value);
-
-                            if (previous_values.size() == _amount_of_devices) {
-                                float usage = calculate_usage(previous_timestamp, previous_values.at(i),
-                                        timestamp, value);
-                                power_usages_day.at(i) += usage;
-                                power_usages_week.at(i) += usage;
-                                previous_values.at(i) = value;
-                            } else {
-                                previous_values.push_back(value);
-                            }
-                        }
-                        previous_timestamp = timestamp;
-                        _init_day          = true;
-                        // _init_week         = true;
-                        last_timestamp = timestamp;
-                    } else {
-                        _timestamps_week.push_back(timestamp);
-                        for (size_t i = 0; i < _amount_of_devices; i++) {
-                            float value;
-                            iss >> value;
-                            _devices_values_last_week.at(i).push_back(value);
-
-                            if (previous_values.size() == _amount_of_devices) {
-                                float usage = calculate_usage(previous_timestamp, previous_values.at(i),
-                                        timestamp, value);
-                                power_usages_week.at(i) += usage;
-                                previous_values.at(i) = value;
-                            } else {
-                                previous_values.push_back(value);
-                            }
-                        }
-                        previous_timestamp = timestamp;
-                        _init_week         = true;
-                    }
-                }
-            }
-        }
+// usage between sample and the following one
+float PowerIntegrator::segment_usage(size_t device, size_t sample) {
+    const size_t offset = sample * _amount_of_devices + device;
+    return calculate_usage(_timestamps[sample], _values[offset], _timestamps[sample + 1], _values[offset + _amount_of_devices]);
+}
 
-        values_file.close();
-        return true;
-    } else {
+size_t PowerIntegrator::sample_bytes() const {
+    return sizeof(int64_t) + _amount_of_devices * sizeof(float);
+}
+
+bool PowerIntegrator::read_checkpoint() {
+    MappedFile       checkpoint(_data_path + file_checkpoint);
+    CheckpointHeader header{};
+    if (checkpoint.bytes < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, checkpoint.data, sizeof(header));
+    const size_t month_bytes = _amount_of_devices * sizeof(double);
+    if (std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0 || header.devices != _amount_of_devices || header.samples < 0
+            || checkpoint.bytes < sizeof(header) + month_bytes + static_cast<size_t>(header.samples) * sample_bytes()) {
+        fmt::print("Ignore invalid checkpoint {}\n", _data_path + file_checkpoint);
         return false;
     }
-    return false;
-}
 
-bool PowerIntegrator::read_month_usage() {
-    std::string   file_path = _data_path + file_month;
-    std::ifstream month_file(file_path.c_str(), std::ios_base::in);
-
-    if (month_file.good()) {
-        std::string line;
-        if (std::getline(month_file, line)) {
-            if (line.length() > 0) {
-                std::istringstream iss(line);
-                iss >> _month[0] >> _month[1];
-            } else {
-                month_file.close();
-                return false;
-            }
+    set_month(header.month, header.year);
+    std::memcpy(power_usages_month.data(), checkpoint.data + sizeof(header), month_bytes);
+    _init_month = true;
 
-        } else {
-            month_file.close();
-            return false;
+    const size_t       samples    = static_cast<size_t>(header.samples);
+    const char        *timestamps = checkpoint.data + sizeof(header) + month_bytes;
+    const char        *sample     = timestamps + samples * sizeof(int64_t);
+    std::vector<float> values(_amount_of_devices);
+    for (size_t j = 0; j < samples; j++, sample += values.size() * sizeof(float)) {
+        int64_t timestamp;
+        std::memcpy(&timestamp, timestamps + j * sizeof(int64_t), sizeof(timestamp));
+        std::memcpy(values.data(), sample, values.size() * sizeof(float));
+        push_sample(timestamp, values, false);
+    }
+
+    // history tiers, skipped if the tier layout changed
+    const size_t        bucket_bytes = _amount_of_devices * sizeof(double);
+    size_t              offset       = static_cast<size_t>(sample - checkpoint.data);
+    std::vector<double> energy(_amount_of_devices);
+    for (size_t t = 0; t < header.tiers && t < _history.tiers().size() && offset + 2 * sizeof(int64_t) <= checkpoint.bytes; t++) {
+        int64_t width;
+        int64_t buckets;
+        std::memcpy(&width, checkpoint.data + offset, sizeof(width));
+        std::memcpy(&buckets, checkpoint.data + offset + sizeof(width), sizeof(buckets));
+        offset += 2 * sizeof(int64_t);
+        if (buckets < 0 || static_cast<size_t>(buckets) > (checkpoint.bytes - offset) / (sizeof(int64_t) + bucket_bytes) || width != _history.tiers()[t].width) {
+            fmt::print("Ignore history tier {} of checkpoint {}\n", t, _data_path + file_checkpoint);
+            break;
         }
+        const char *starts = checkpoint.data + offset;
+        const char *bucket = starts + static_cast<size_t>(buckets) * sizeof(int64_t);
+        offset += static_cast<size_t>(buckets) * (sizeof(int64_t) + bucket_bytes);
+        for (size_t j = 0; j < static_cast<size_t>(buckets); j++, bucket += bucket_bytes) {
+            int64_t start;
+            std::memcpy(&start, starts + j * sizeof(int64_t), sizeof(start));
+            std::memcpy(energy.data(), bucket, bucket_bytes);
+            _history.restore(t, start, energy.data());
+        }
+    }
+    if (!_timestamps.empty()) {
+        _history.restoreEnd(_timestamps.back());
+    }
+    return true;
+}
 
-        float  value;
+// samples appended after the last checkpoint, a partially written last record is ignored
+void PowerIntegrator::replay_journal() {
+    MappedFile    journal(_data_path + file_journal);
+    JournalHeader header{};
+    if (journal.bytes < sizeof(header)) {
+        return;
+    }
+    std::memcpy(&header, journal.data, sizeof(header));
+    if (std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) != 0 || header.devices != _amount_of_devices) {
+        fmt::print("Ignore invalid journal {}\n", _data_path + file_journal);
+        return;
+    }
 
-        size_t index = 0;
-        while (std::getline(month_file, line) && index < _amount_of_devices) {
-            if (line.length() > 0) {
-                std::istringstream iss(line);
-                iss >> value;
-                power_usages_month.at(index) = value;
-                index++;
-            }
+    const size_t       records = (journal.bytes - sizeof(header)) / sample_bytes();
+    const char        *record  = journal.data + sizeof(header);
+    std::vector<float> values(_amount_of_devices);
+    for (size_t j = 0; j < records; j++, record += sample_bytes()) {
+        int64_t timestamp;
+        std::memcpy(&timestamp, record, sizeof(timestamp));
+        // already in the checkpoint if the journal was not restarted after it
+        if (!_timestamps.empty() && timestamp <= _timestamps.back()) {
+            continue;
+        }
+        std::memcpy(values.data(), record + sizeof(timestamp), _amount_of_devices * sizeof(float));
+        if (!check_month(timestamp)) {
+            reset_month(timestamp);
         }
+        push_sample(timestamp, values, true);
+        slide_windows(timestamp);
+    }
+}
 
-        month_file.close();
-        _init_month = true;
-        return true;
+// continues a valid journal, a missing or incompatible one is started anew
+void PowerIntegrator::open_journal() {
+    const std::string path = _data_path + file_journal;
+    JournalHeader     header{};
+    bool              valid = false;
+    {
+        std::ifstream journal(path, std::ios::binary);
+        valid = journal.read(reinterpret_cast<char *>(&header), sizeof(header)) && std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) == 0 && header.devices == _amount_of_devices;
+    }
+    _journal_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | (valid ? 0 : O_TRUNC), 0644);
+    if (_journal_fd == -1) {
+        fmt::print("Cannot open journal {}\n", path);
+        return;
+    }
+    if (!valid) {
+        header = JournalHeader{};
+        std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(header.magic));
+        header.devices = static_cast<uint32_t>(_amount_of_devices);
+        if (::write(_journal_fd, &header, sizeof(header)) != sizeof(header)) {
+            fmt::print("Cannot write journal {}\n", path);
+        }
     } else {
-        return false;
+        // drop a partially written last record, later records would be misaligned
+        struct stat fileStat {};
+        if (fstat(_journal_fd, &fileStat) == 0) {
+            const auto records = (static_cast<size_t>(fileStat.st_size) - sizeof(header)) / sample_bytes();
+            if (ftruncate(_journal_fd, static_cast<off_t>(sizeof(header) + records * sample_bytes())) != 0) {
+                fmt::print("Cannot truncate journal {}\n", path);
+            }
+        }
     }
-    return false;
 }
 
-void PowerIntegrator::save_values_to_file() {
-    std::string   file_path = _data_path + file_values;
-
-    std::ofstream output_file;
-
-    output_file.open(file_path);
-    output_file << last_timestamp << std::endl;
-
-    // optimization possibility -> table with iterators
+// one record of sample_bytes() per update
+void PowerIntegrator::append_journal(int64_t timestamp, const std::vector<float> &values) {
+    if (_journal_fd == -1) {
+        return;
+    }
+    _journal_record.assign(sample_bytes(), 0);
+    std::memcpy(_journal_record.data(), &timestamp, sizeof(timestamp));
+    std::memcpy(_journal_record.data() + sizeof(timestamp), values.data(), std::min(values.size(), _amount_of_devices) * sizeof(float));
+    if (::write(_journal_fd, _journal_record.data(), _journal_record.size()) != static_cast<ssize_t>(_journal_record.size())) {
+        fmt::print("Cannot append to journal {}\n", _data_path + file_journal);
+    }
+}
 
-    // save values from last week
-    for (size_t j = 0; j < _timestamps_week.size(); j++) {
-        output_file << _timestamps_week.at(j) << " ";
-        for (size_t i = 0; i < _amount_of_devices; i++) {
-            output_file << _devices_values_last_week.at(i).at(j) << " ";
+// writes the raw samples of the last RAW_NS, the energy history tiers and the month usage to a new checkpoint,
+// the journal is only restarted once the checkpoint is durable (file and directory entry synced)
+void PowerIntegrator::save_checkpoint() {
+    const std::string path = _data_path + file_checkpoint;
+    CheckpointHeader  header{};
+    std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.devices = static_cast<uint32_t>(_amount_of_devices);
+    header.month   = _month[0];
+    header.year    = _month[1];
+    header.tiers   = static_cast<uint32_t>(_history.tiers().size());
+    header.samples = static_cast<int64_t>(_timestamps.size());
+
+    const int fd = ::open((path + ".tmp").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        fmt::print("Cannot write checkpoint {}\n", path);
+        return;
+    }
+    bool ok    = true;
+    auto write = [fd, &ok](const void *data, size_t bytes) {
+        const char *begin = static_cast<const char *>(data);
+        while (ok && bytes > 0) {
+            const ssize_t written = ::write(fd, begin, bytes);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            ok = written > 0;
+            if (ok) {
+                begin += written;
+                bytes -= static_cast<size_t>(written);
+            }
         }
-        output_file << std::endl;
+    };
+    write(&header, sizeof(header));
+    write(power_usages_month.data(), _amount_of_devices * sizeof(double));
+    // the rings are stored in at most two contiguous parts each
+    for (auto part : { _timestamps.array_one(), _timestamps.array_two() }) {
+        write(part.first, part.second * sizeof(int64_t));
     }
-
-    // save values from last 24 hours
-    for (size_t j = 0; j < _timestamps.size(); j++) {
-        output_file << _timestamps.at(j) << " ";
-        for (size_t i = 0; i < _amount_of_devices; i++) {
-            output_file << _devices_values.at(i).at(j) << " ";
+    for (auto part : { _values.array_one(), _values.array_two() }) {
+        write(part.first, part.second * sizeof(float));
+    }
+    for (const auto &tier : _history.tiers()) {
+        const auto buckets = static_cast<int64_t>(tier.starts.size());
+        write(&tier.width, sizeof(int64_t));
+        write(&buckets, sizeof(int64_t));
+        for (auto part : { tier.starts.array_one(), tier.starts.array_two() }) {
+            write(part.first, part.second * sizeof(int64_t));
+        }
+        for (auto part : { tier.energy.array_one(), tier.energy.array_two() }) {
+            write(part.first, part.second * sizeof(double));
         }
-        output_file << std::endl;
+    }
+    ok = ok && ::fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || std::rename((path + ".tmp").c_str(), path.c_str()) != 0) {
+        fmt::print("Cannot write checkpoint {}\n", path);
+        return;
     }
 
-    output_file.close();
-}
-
-void PowerIntegrator::save_month_usage() {
-    std::string   file_path = _data_path + file_month;
+    // the rename itself has to reach the disk before the journal may be dropped
+    const int  directory_fd = ::open(_data_path.empty() ? "." : _data_path.c_str(), O_RDONLY | O_DIRECTORY);
+    const bool synced       = directory_fd != -1 && ::fsync(directory_fd) == 0;
+    if (directory_fd != -1) {
+        ::close(directory_fd);
+    }
+    if (!synced) {
+        fmt::print("Cannot sync directory of checkpoint {}, keeping the journal\n", path);
+        return;
+    }
 
-    std::ofstream output_file;
-    output_file.open(file_path);
-    output_file << _month[0] << " " << _month[1] << std::endl;
-    for (auto v : power_usages_month) {
-        output_file << v << std::endl;
+    if (_journal_fd != -1 && ftruncate(_journal_fd, sizeof(JournalHeader)) != 0) {
+        fmt::print("Cannot restart journal {}\n", _data_path + file_journal);
     }
-    output_file.close();
 }
 
 bool PowerIntegrator::get_init() {
@@ -453,38 +554,60 @@ bool PowerIntegrator::get_init() {
 }
 
 const std::vector<float> PowerIntegrator::get_power_usages_month() {
-    return power_usages_month;
+    std::scoped_lock lock(_mutex);
+    return { power_usages_month.begin(), power_usages_month.end() };
 }
 
 const std::vector<float> PowerIntegrator::get_power_usages_week() {
-    return power_usages_week;
+    std::scoped_lock lock(_mutex);
+    const auto       usage = _history.energy(last_timestamp - WEEK_NS, last_timestamp);
+    return { usage.begin(), usage.end() };
 }
 
 const std::vector<float> PowerIntegrator::get_power_usages_day() {
-    return power_usages_day;
+    std::scoped_lock lock(_mutex);
+    const auto       usage = _history.energy(last_timestamp - DAY_NS, last_timestamp);
+    return { usage.begin(), usage.end() };
 }
 
 const std::vector<std::vector<float>> PowerIntegrator::get_devices_values() {
-    return _devices_values;
+    std::scoped_lock                lock(_mutex);
+    std::vector<std::vector<float>> result(_amount_of_devices);
+    for (size_t i = 0; i < _amount_of_devices; i++) {
+        result[i].reserve(_timestamps.size());
+        for (size_t sample = 0; sample < _timestamps.size(); sample++) {
+            result[i].push_back(_values[sample * _amount_of_devices + i]);
+        }
+    }
+    return result;
 }
 
-const std::vector<std::vector<float>> PowerIntegrator::get_devices_values_last_week() {
-    return _devices_values_last_week;
+const std::vector<int64_t> PowerIntegrator::get_timestamps() {
+    std::scoped_lock lock(_mutex);
+    return { _timestamps.begin(), _timestamps.end() };
 }
 
-const std::vector<int64_t> PowerIntegrator::get_timestamps() {
-    return _timestamps;
+EnergyHistory PowerIntegrator::get_history() {
+    std::scoped_lock lock(_mutex);
+    return _history;
+}
+
+int64_t PowerIntegrator::get_last_timestamp() {
+    std::scoped_lock lock(_mutex);
+    return last_timestamp;
 }
-const std::vector<int64_t> PowerIntegrator::get_timestamps_week() {
-    return _timestamps_week;
+
+std::vector<std::vector<double>> PowerIntegrator::get_energy_series(int64_t from, int64_t to, int64_t resolution) {
+    std::scoped_lock lock(_mutex);
+    return _history.series(from, to, resolution);
 }
 
 bool PowerIntegrator::check_same_day(int64_t t_0, int64_t t_1) {
-    int64_t temp = t_1 - 86400000000000;
+    int64_t temp = t_1 - DAY_NS;
     return temp <= t_0;
 }
 bool PowerIntegrator::check_same_week(int64_t t_0, int64_t t_1) {
-    int64_t temp = t_1 - 604800000000000;
+    int64_t temp = t_1 - WEEK_NS;
     return temp <= t_0;
 }
 
@@ -534,24 +657,31 @@ void PowerIntegrator::reset_month(int64_t timestamp) {
 
     std::tm                              *tm      = std::localtime(&time);
 
-    _month[0]                                     = tm->tm_mon + 1;
-    _month[1]                                     = tm->tm_year + 1900;
+    set_month(tm->tm_mon + 1, tm->tm_year + 1900);
 
-    power_usages_month.clear();
-    for (size_t i = 0; i < _amount_of_devices; i++) {
-        power_usages_month.push_back(0.0f);
-    }
+    std::fill(power_usages_month.begin(), power_usages_month.end(), 0.0);
     _init_month = true;
 }
 
-bool PowerIntegrator::check_month(int64_t timestamp) {
-    std::chrono::system_clock::time_point t_point = std::chrono::system_clock::time_point(std::chrono::nanoseconds(timestamp));
-
-    std::time_t                           time    = std::chrono::system_clock::to_time_t(t_point);
-
-    std::tm                              *tm      = std::localtime(&time);
+// local time instants of the month boundaries, updates compare against these instead of converting every timestamp
+void PowerIntegrator::set_month(int month, int year) {
+    _month[0]             = month;
+    _month[1]             = year;
+
+    std::tm month_tm      = {};
+    month_tm.tm_mday      = 1;
+    month_tm.tm_mon       = month - 1;
+    month_tm.tm_year      = year - 1900;
+    month_tm.tm_isdst     = -1;
+    std::tm next_month_tm = month_tm;
+    next_month_tm.tm_mon++; // normalised by mktime
+
+    _month_start          = static_cast<int64_t>(std::mktime(&month_tm)) * 1'000'000'000;
+    _next_month_start     = static_cast<int64_t>(std::mktime(&next_month_tm)) * 1'000'000'000;
+}
 
-    return (tm->tm_mon + 1 == _month[0]) && (tm->tm_year + 1900 == _month[1]);
+bool PowerIntegrator::check_month(int64_t timestamp) {
+    return timestamp >= _month_start && timestamp < _next_month_start;
 }
 
 #endif /* POWER_INTEGRATOR_H */
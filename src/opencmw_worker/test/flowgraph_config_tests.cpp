@@ -0,0 +1,128 @@
+#include <catch2/catch.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "FlowgraphConfig.hpp"
+
+namespace {
+std::string writeConfig(const std::string &name, const std::string &json) {
+    const std::string path = "./" + name;
+    std::ofstream(path) << json;
+    return path;
+}
+
+bool mentions(const std::vector<std::string> &errors, const std::string &text) {
+    return std::any_of(errors.begin(), errors.end(), [&text](const auto &error) { return error.find(text) != std::string::npos; });
+}
+} // namespace
+
+TEST_CASE("flowgraph-config-defaults", "[FlowgraphConfig]") {
+    const FlowgraphConfig config;
+    REQUIRE(config.validate().empty());
+
+    REQUIRE(FlowgraphConfig::decimation(2'000'000.0, 1'000.0) == 2000);
+    REQUIRE(FlowgraphConfig::decimation(1'000.0, 1.0 / 60.0) == 60000);
+    REQUIRE(FlowgraphConfig::decimation(1'000.0, 300.0) == 0);
+    REQUIRE(FlowgraphConfig::decimation(100.0, 1'000.0) == 0);
+
+    // the rates of the former hard-coded flowgraph
+    const auto rates = flowgraphRates(config);
+    auto       find  = [&rates](const std::string &block) { return *std::find_if(rates.begin(), rates.end(), [&block](const BlockRate &rate) { return rate.block == block; }); };
+    REQUIRE(find("band pass filter U, I").decimation == 2000);
+    REQUIRE(find("decimation power long-term").decimation == 60000);
+    REQUIRE(find("integration day, week, month").decimation == 1000);
+    REQUIRE(find("low pass filter PPEM spectrum").outputRate == Approx(50.0));
+    REQUIRE(find("low pass filter PPEM spectrum").decimation == 10);
+    REQUIRE(find("fft NILM U, I, S (131072 points)").outputRate == Approx(2'000'000.0 / 131072.0));
+
+    FlowgraphConfig threePhase;
+    threePhase.source.phases = 3;
+    REQUIRE(threePhase.validate().empty());
+    const auto perPhase = flowgraphRates(threePhase);
+    REQUIRE(std::any_of(perPhase.begin(), perPhase.end(), [](const BlockRate &rate) { return rate.block == "power calculation P, Q, S, phi per phase"; }));
+}
+
+TEST_CASE("flowgraph-config-validation", "[FlowgraphConfig]") {
+    FlowgraphConfig config;
+    config.source.type               = "scope";
+    config.source.phases             = 2;
+    config.rates.signals             = 300.0f; // 2 MS/s is no multiple of 300 Hz
+    config.processing.lowPassCutoff  = 600.0f;
+    config.spectra.nilmFftSize       = 100'000;
+    config.spectra.ppemWindow        = "kaiser";
+    config.sinks.maxNoutputItems     = 0;
+    config.placement.power.cores     = { -1 };
+    config.placement.source.priority = 120;
+    config.performance.publishRate   = -1.0f;
+
+    const auto errors = config.validate();
+    REQUIRE(mentions(errors, "source.type 'scope'"));
+    REQUIRE(mentions(errors, "source.phases 2"));
+    REQUIRE(mentions(errors, "rates.signals (300 Hz)"));
+    REQUIRE(mentions(errors, "processing.lowPassCutoff"));
+    REQUIRE(mentions(errors, "spectra.nilmFftSize 100000"));
+    REQUIRE(mentions(errors, "unknown window 'kaiser'"));
+    REQUIRE(mentions(errors, "sink output item limits"));
+    REQUIRE(mentions(errors, "placement.power.cores: core -1"));
+    REQUIRE(mentions(errors, "placement.source.priority 120"));
+    REQUIRE(mentions(errors, "performance.publishRate (-1 Hz)"));
+}
+
+TEST_CASE("flowgraph-config-devices", "[FlowgraphConfig]") {
+    // a single device keeps the un-prefixed sink names
+    REQUIRE(validateDevices({ FlowgraphConfig() }).empty());
+    REQUIRE(FlowgraphConfig().signalPrefix().empty());
+
+    FlowgraphConfig circuit1;
+    circuit1.source.name            = "circuit1";
+    circuit1.source.serial          = "JO123/0001";
+    circuit1.placement.source.cores = { 0 };
+    circuit1.placement.power.cores  = { 1 };
+    FlowgraphConfig circuit2        = circuit1;
+    circuit2.source.name            = "circuit2";
+    circuit2.source.serial          = "JO123/0002";
+    circuit2.placement.source.cores = { 2 };
+    circuit2.placement.power.cores  = { 3 };
+    REQUIRE(circuit2.signalPrefix() == "circuit2/");
+    REQUIRE(validateDevices({ circuit1, circuit2 }).empty());
+
+    FlowgraphConfig unnamed;
+    unnamed.placement.spectra.cores = { 1, 4 };
+    circuit2.source.serial          = circuit1.source.serial;
+    const auto errors               = validateDevices({ circuit1, circuit2, unnamed });
+    REQUIRE(mentions(errors, "device 3: source.name is required"));
+    REQUIRE(mentions(errors, "device 'circuit2': source.serial 'JO123/0001' is used twice"));
+    REQUIRE(mentions(errors, "devices 'circuit1' and '' share the cores 1"));
+
+    FlowgraphConfig slash;
+    slash.source.name = "circuit/2";
+    REQUIRE(mentions(slash.validate(), "source.name 'circuit/2'"));
+}
+
+TEST_CASE("flowgraph-config-load", "[FlowgraphConfig]") {
+    // only the listed values differ from the defaults
+    const auto path   = writeConfig("flowgraph_config_test.json", R"({ "source": { "type": "simulated", "sampleRate": 1000000.0 }, "spectra": { "nilmFftSize": 65536 } })");
+    const auto config = loadFlowgraphConfig(path);
+    REQUIRE(config.source.type == "simulated");
+    REQUIRE(config.source.sampleRate == Approx(1'000'000.0f));
+    REQUIRE(config.spectra.nilmFftSize == 65536);
+    REQUIRE(config.spectra.ppemFftSize == 512);
+    REQUIRE(config.rates.shortTerm == Approx(100.0f));
+
+    // invalid values and unknown keys are rejected with all problems listed
+    const auto invalid = writeConfig("flowgraph_config_invalid.json", R"({ "rates": { "signals": 300.0 }, "sinks": { "maxNoutputitems": 128 } })");
+    try {
+        loadFlowgraphConfig(invalid);
+        FAIL("invalid configuration accepted");
+    } catch (const std::invalid_argument &e) {
+        const std::string message = e.what();
+        REQUIRE(message.find("rates.signals") != std::string::npos);
+        REQUIRE(message.find("maxNoutputitems") != std::string::npos);
+    }
+    REQUIRE_THROWS_AS(loadFlowgraphConfig("./does_not_exist.json"), std::invalid_argument);
+
+    std::remove(path.c_str());
+    std::remove(invalid.c_str());
+}
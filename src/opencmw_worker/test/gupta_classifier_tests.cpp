@@ -0,0 +1,196 @@
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "inference/GuptaClassifier.hpp"
+
+namespace {
+
+constexpr uint32_t FFT_SIZE = 16;
+constexpr size_t   PEAK_BIN = 5;
+
+// raw apparent power spectrum with a single, symmetric peak (flat regions would count as peaks as well)
+std::vector<float> peakedSpectrum() {
+    std::vector<float> spectrum(FFT_SIZE);
+    for (size_t i = 0; i < FFT_SIZE; i++) {
+        spectrum[i] = 10.0f / static_cast<float>(1 + (i > PEAK_BIN ? i - PEAK_BIN : PEAK_BIN - i));
+    }
+    spectrum[PEAK_BIN] = 100.0f;
+    return spectrum;
+}
+
+std::vector<float> toDbm(const std::vector<float> &spectrum) {
+    std::vector<float> dbm(spectrum.size());
+    for (size_t i = 0; i < spectrum.size(); i++) {
+        dbm[i] = 10.0f * std::log10(spectrum[i]) + 30.0f;
+    }
+    return dbm;
+}
+
+// voltage and current spectra are not used (spectrum type 2)
+std::vector<float> dataPoint(const std::vector<float> &apparentPowerSpectrum, float apparentPower) {
+    std::vector<float> point(3 * FFT_SIZE + 4, 1.0f);
+    std::copy(apparentPowerSpectrum.begin(), apparentPowerSpectrum.end(), point.begin() + 2 * FFT_SIZE);
+    point[3 * FFT_SIZE + 2] = apparentPower;
+    return point;
+}
+
+std::vector<float> readFloats(const std::filesystem::path &path) {
+    std::vector<float> values(std::filesystem::file_size(path) / sizeof(float));
+    std::ifstream      file(path, std::ios::binary);
+    file.read(reinterpret_cast<char *>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(float)));
+    return values;
+}
+
+GuptaParameters testParameters() {
+    GuptaParameters params;
+    params.windowSize        = 2;
+    params.stepSize          = 1;
+    params.fftSizeReal       = FFT_SIZE;
+    params.sampleRate        = FFT_SIZE; // 1 Hz per bin
+    params.nKnownAppliances  = 2;
+    params.spectrumType      = 2;
+    params.nNeighbors        = 2;
+    params.nLabels           = 5;
+    params.apparentPowerList = { 100.0f, 40.0f };
+
+    // appliance 0 switched on has exactly the signature of the peaked spectrum, the second point is far away
+    const auto features = GuptaClassifier::featureVector(toDbm(peakedSpectrum()), params.fftSizeReal, params.sampleRate);
+    params.trainingFeatures.assign(features.begin(), features.end());
+    for (float feature : features) {
+        params.trainingFeatures.push_back(-feature);
+    }
+    params.trainingLabels = { 1, 0, 0, 0, 0, /**/ 0, 0, 0, 1, 0 };
+    return params;
+}
+
+} // namespace
+
+TEST_CASE("gupta-feature-vector", "[GuptaClassifier]") {
+    const auto features = GuptaClassifier::featureVector(toDbm(peakedSpectrum()), FFT_SIZE, FFT_SIZE);
+    // one symmetric peak: amplitude 50 dBm at the centre of the peak bin
+    REQUIRE(features[0] == Approx(50.0f));
+    REQUIRE(features[1] == Approx(static_cast<float>(PEAK_BIN) + 0.5f));
+    REQUIRE(features[2] > 0.0f);
+    for (size_t f = 3; f < features.size(); f++) {
+        REQUIRE(features[f] == 0.0f);
+    }
+}
+
+TEST_CASE("gupta-squared-distances", "[GuptaClassifier]") {
+    constexpr size_t   nPoints = 5;
+    std::vector<float> referenceSoA(GuptaParameters::N_FEATURES * nPoints);
+    std::vector<float> query(GuptaParameters::N_FEATURES);
+    for (size_t f = 0; f < GuptaParameters::N_FEATURES; f++) {
+        query[f] = static_cast<float>(f) * 0.5f;
+        for (size_t p = 0; p < nPoints; p++) {
+            referenceSoA[f * nPoints + p] = static_cast<float>(f + p);
+        }
+    }
+    std::vector<float> distances(nPoints);
+    GuptaClassifier::squaredDistances(query.data(), referenceSoA.data(), nPoints, distances.data());
+    for (size_t p = 0; p < nPoints; p++) {
+        float expected = 0.0f;
+        for (size_t f = 0; f < GuptaParameters::N_FEATURES; f++) {
+            const float d = referenceSoA[f * nPoints + p] - query[f];
+            expected += d * d;
+        }
+        REQUIRE(distances[p] == Approx(expected));
+    }
+}
+
+TEST_CASE("gupta-classify-switch-on", "[GuptaClassifier]") {
+    GuptaClassifier    classifier(testParameters());
+    std::vector<float> values;
+
+    // the oldest block of the window (classification spectrum) holds the peak
+    const std::vector<float> flat(FFT_SIZE, 1.0f);
+    for (int i = 0; i < 2; i++) {
+        classifier.predict(dataPoint(peakedSpectrum(), 150.0f), values);
+        REQUIRE(values == std::vector<float>{ 0.0f, 0.0f, 150.0f });
+    }
+    for (int i = 0; i < 3; i++) {
+        classifier.predict(dataPoint(flat, 150.0f), values);
+        REQUIRE(values == std::vector<float>{ 0.0f, 0.0f, 150.0f });
+    }
+
+    // window full: zero distance to the "appliance 0 on" signature
+    classifier.predict(dataPoint(flat, 150.0f), values);
+    REQUIRE(values == std::vector<float>{ 100.0f, 0.0f, 50.0f });
+
+    // window has been cleared, only the unknown power follows
+    classifier.predict(dataPoint(flat, 80.0f), values);
+    REQUIRE(values == std::vector<float>{ 100.0f, 0.0f, 0.0f });
+
+    // a data point of all -1 resets the state
+    classifier.predict(std::vector<float>(3 * FFT_SIZE + 4, -1.0f), values);
+    REQUIRE(values == std::vector<float>{ 0.0f, 0.0f, 0.0f });
+}
+
+TEST_CASE("gupta-parameter-file", "[GuptaClassifier]") {
+    const GuptaParameters params = testParameters();
+    const std::string     path   = "gupta_classifier_test_params.bin";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write("GUPTAv1", 8);
+        const uint32_t header[] = { params.windowSize, params.stepSize, params.fftSizeReal, params.sampleRate, params.nKnownAppliances, params.spectrumType, params.nNeighbors, 2, GuptaParameters::N_FEATURES, params.nLabels };
+        file.write(reinterpret_cast<const char *>(header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(&params.switchThreshold), sizeof(float));
+        file.write(reinterpret_cast<const char *>(&params.distanceThreshold), sizeof(float));
+        file.write(reinterpret_cast<const char *>(params.apparentPowerList.data()), static_cast<std::streamsize>(params.apparentPowerList.size() * sizeof(float)));
+        file.write(reinterpret_cast<const char *>(params.trainingFeatures.data()), static_cast<std::streamsize>(params.trainingFeatures.size() * sizeof(float)));
+        file.write(reinterpret_cast<const char *>(params.trainingLabels.data()), static_cast<std::streamsize>(params.trainingLabels.size() * sizeof(float)));
+    }
+
+    const GuptaParameters loaded = GuptaParameters::load(path);
+    REQUIRE(loaded.windowSize == params.windowSize);
+    REQUIRE(loaded.nLabels == params.nLabels);
+    REQUIRE(loaded.apparentPowerList == params.apparentPowerList);
+    REQUIRE(loaded.trainingFeatures == params.trainingFeatures);
+    REQUIRE(loaded.trainingLabels == params.trainingLabels);
+
+    // truncated file
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write("GUPTAv1", 8);
+    }
+    REQUIRE_THROWS_AS(GuptaParameters::load(path), std::invalid_argument);
+    std::remove(path.c_str());
+}
+
+// recorded data points and the predictions of the TF graph, see models/gupta_model/export_gupta_fixture.py
+TEST_CASE("gupta-tensorflow-fixture", "[GuptaClassifier]") {
+    const std::filesystem::path fixture = GUPTA_FIXTURE_DIR;
+    if (!std::filesystem::exists(fixture / "tf_state_vectors.bin")) {
+        WARN("no TensorFlow fixture in " << fixture << ", export one with export_gupta_fixture.py and export_gupta_params.py");
+        return;
+    }
+    const GuptaParameters    params       = GuptaParameters::load((fixture / "gupta_params.bin").string());
+    const std::vector<float> dataPoints   = readFloats(fixture / "data_points.bin");
+    const std::vector<float> stateVectors = readFloats(fixture / "tf_state_vectors.bin");
+    const size_t             pointSize    = 3 * size_t{ params.fftSizeReal } + 4;
+    const size_t             stateSize    = params.nKnownAppliances + 1;
+    const size_t             records      = dataPoints.size() / pointSize;
+    REQUIRE(records > 0);
+    REQUIRE(stateVectors.size() == records * stateSize);
+
+    GuptaClassifier    classifier(params);
+    std::vector<float> dataPoint(pointSize);
+    std::vector<float> values;
+    for (size_t r = 0; r < records; r++) {
+        std::copy_n(dataPoints.begin() + static_cast<std::ptrdiff_t>(r * pointSize), pointSize, dataPoint.begin());
+        classifier.predict(dataPoint, values);
+        REQUIRE(values.size() == stateSize);
+        for (size_t k = 0; k < stateSize; k++) {
+            INFO("data point " << r << ", state " << k);
+            // appliance powers are copied from the power list, "unknown" is a float difference of the apparent power
+            REQUIRE(values[k] == Approx(stateVectors[r * stateSize + k]).margin(0.01));
+        }
+    }
+}
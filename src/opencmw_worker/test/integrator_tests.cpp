@@ -44,6 +44,8 @@ TEST_CASE("integrator-constructor-not-exists-1", "[constuctor][file does not exi
     size_t      size     = 7;
     std::string datapath = "../../test/data/test_no_init_file/";
     if (!PowerIntegrator::create_directory(datapath)) REQUIRE(false);
+    std::remove((datapath + "integrator_checkpoint.bin").c_str()); // every update is journaled
+    std::remove((datapath + "integrator_journal.bin").c_str());
 
     PowerIntegrator                 powerIntegrator(size, datapath.c_str());
 
@@ -52,23 +54,19 @@ TEST_CASE("integrator-constructor-not-exists-1", "[constuctor][file does not exi
     std::vector<float>              usage_month     = powerIntegrator.get_power_usages_month();
 
     std::vector<int64_t>            timestamps      = powerIntegrator.get_timestamps();
-    std::vector<int64_t>            timestamps_week = powerIntegrator.get_timestamps_week();
 
     std::vector<std::vector<float>> values_day      = powerIntegrator.get_devices_values();
-    std::vector<std::vector<float>> values_week     = powerIntegrator.get_devices_values_last_week();
 
     REQUIRE(usage_day.size() == size);
     REQUIRE(usage_week.size() == size);
     REQUIRE(usage_month.size() == size);
     REQUIRE(timestamps.size() == 1);
-    REQUIRE(timestamps_week.size() == 0);
 
     for (size_t i = 0; i < size; i++) {
         REQUIRE(usage_month.at(i) == 0);
         REQUIRE(usage_day.at(i) == 0);
         REQUIRE(usage_week.at(i) == 0);
         REQUIRE(values_day.at(i).size() == 1);
-        REQUIRE(values_week.at(i).size() == 0);
     }
 }
 
@@ -115,6 +113,8 @@ TEST_CASE("integrator-update-test-add-values-5", "[update][inital values does no
     std::string datapath = "../../test/data/test_update_values/";
 
     if (!PowerIntegrator::create_directory(datapath)) REQUIRE(false);
+    std::remove((datapath + "integrator_checkpoint.bin").c_str()); // every update is journaled
+    std::remove((datapath + "integrator_journal.bin").c_str());
 
     PowerIntegrator    powerIntegrator(size, datapath.c_str());
     std::vector<float> values      = { 1.2, 0.4, 8.3, 30.0, 1.2, 0.4, 27.0 };
@@ -132,23 +132,19 @@ TEST_CASE("integrator-update-test-add-values-5", "[update][inital values does no
     std::vector<float>              usage_month     = powerIntegrator.get_power_usages_month();
 
     std::vector<int64_t>            timestamps      = powerIntegrator.get_timestamps();
-    std::vector<int64_t>            timestamps_week = powerIntegrator.get_timestamps_week();
 
     std::vector<std::vector<float>> values_day      = powerIntegrator.get_devices_values();
-    std::vector<std::vector<float>> values_week     = powerIntegrator.get_devices_values_last_week();
 
     REQUIRE(usage_day.size() == size);
     REQUIRE(usage_week.size() == size);
     REQUIRE(usage_month.size() == size);
     REQUIRE(timestamps.size() == 3);
-    REQUIRE(timestamps_week.size() == 0);
 
     for (size_t i = 0; i < size; i++) {
         REQUIRE(usage_month.at(i) > 0);
         REQUIRE(usage_day.at(i) > 0);
         REQUIRE(usage_week.at(i) > 0);
         REQUIRE(values_day.at(i).size() == timestamps.size());
-        REQUIRE(values_week.at(i).size() == timestamps_week.size());
     }
 }
 
@@ -174,12 +170,12 @@ TEST_CASE("integrator-save-data-6") {
     }
 
     // check files existence
-    std::string month_file  = datapath + "month_usage.txt";
-    std::string values_file = datapath + "time_values.txt";
-    REQUIRE(std::filesystem::exists(month_file));
-    std::remove(month_file.c_str()); // clean for next test
-    REQUIRE(std::filesystem::exists(values_file));
-    std::remove(values_file.c_str()); // clean for next test
+    std::string checkpoint_file = datapath + "integrator_checkpoint.bin";
+    std::string journal_file    = datapath + "integrator_journal.bin";
+    REQUIRE(std::filesystem::exists(checkpoint_file));
+    std::remove(checkpoint_file.c_str()); // clean for next test
+    REQUIRE(std::filesystem::exists(journal_file));
+    std::remove(journal_file.c_str()); // clean for next test
 }
 
 TEST_CASE("integrator-save_read-data-7") {
@@ -217,12 +213,101 @@ TEST_CASE("integrator-save_read-data-7") {
     fmt::print("timestamps size saved: {}\n", timestamps.size());
     fmt::print("timestamps size readed : {}\n", timestamps_reader.size());
 
-    std::string month_file  = datapath + "month_usage.txt";
-    std::string values_file = datapath + "time_values.txt";
-    REQUIRE(std::filesystem::exists(month_file));
-    std::remove(month_file.c_str()); // clean for next test
-    REQUIRE(std::filesystem::exists(values_file));
-    std::remove(values_file.c_str()); // clean for next test
+    std::string checkpoint_file = datapath + "integrator_checkpoint.bin";
+    std::string journal_file    = datapath + "integrator_journal.bin";
+    REQUIRE(std::filesystem::exists(checkpoint_file));
+    std::remove(checkpoint_file.c_str()); // clean for next test
+    REQUIRE(std::filesystem::exists(journal_file));
+    std::remove(journal_file.c_str()); // clean for next test
+}
+
+TEST_CASE("integrator-journal-restart-10", "[journal][checkpoint]") {
+    std::string datapath = "../../test/data/test_journal_restart/";
+    if (!PowerIntegrator::create_directory(datapath)) REQUIRE(false);
+    std::string checkpoint_file = datapath + "integrator_checkpoint.bin";
+    std::string journal_file    = datapath + "integrator_journal.bin";
+    std::remove(checkpoint_file.c_str());
+    std::remove(journal_file.c_str());
+
+    std::vector<float>   usage_week;
+    std::vector<int64_t> timestamps;
+    {
+        PowerIntegrator    powerIntegrator(3, datapath, 50);
+        int64_t            time_point = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count() + 1000000000;
+        std::vector<float> values     = { 100.0f, 20.0f, 0.0f };
+        for (size_t i = 0; i < 120; i++) {
+            values[2] = static_cast<float>(i);
+            powerIntegrator.update(time_point, values);
+            time_point += 10000000000; // 10 s
+        }
+        usage_week = powerIntegrator.get_power_usages_week();
+        timestamps = powerIntegrator.get_timestamps();
+    }
+    // 100 samples in the checkpoint, the last 20 only in the journal
+    REQUIRE(std::filesystem::file_size(journal_file) == 16 + 20 * (8 + 3 * 4));
+
+    PowerIntegrator restarted(3, datapath, 50);
+    REQUIRE(restarted.get_init());
+    REQUIRE(restarted.get_timestamps() == timestamps);
+    for (size_t i = 0; i < 3; i++) {
+        REQUIRE(restarted.get_power_usages_week().at(i) == Approx(usage_week.at(i)));
+    }
+
+    std::remove(checkpoint_file.c_str());
+    std::remove(journal_file.c_str());
+}
+
+TEST_CASE("energy-history-11", "[EnergyHistory]") {
+    const int64_t      second = EnergyHistory::SECOND_NS;
+    EnergyHistory      history(2, { { second, 10 }, { 10 * second, 100 } });
+    std::vector<float> energy = { 3.0f, 1.0f };
+
+    // a segment of 3 s starting in the middle of a second is split over four second buckets
+    history.add(1000 * second + second / 2, 1003 * second + second / 2, energy);
+    REQUIRE(history.tiers()[0].starts.size() == 4);
+    REQUIRE(history.tiers()[0].energy[0] == Approx(0.5));
+    REQUIRE(history.tiers()[0].energy[2] == Approx(1.0));
+    REQUIRE(history.tiers()[1].starts.size() == 1);
+
+    // partially covered buckets count in proportion
+    REQUIRE(history.energy(1001 * second, 1003 * second)[0] == Approx(2.0));
+    REQUIRE(history.energy(1000 * second, 1002 * second + second / 2)[1] == Approx(2.0 / 3.0));
+
+    // the second tier is full after 10 buckets, older intervals come from the 10 s tier
+    for (int64_t t = 1004; t < 1100; t++) {
+        history.add(t * second, (t + 1) * second, energy);
+    }
+    REQUIRE(history.tiers()[0].starts.size() == 10);
+    REQUIRE(history.tiers()[0].starts.front() == 1090 * second);
+    REQUIRE(history.energy(1000 * second, 1100 * second)[0] == Approx(3.0 + 96 * 3.0));
+    REQUIRE(history.energy(1095 * second, 1100 * second)[1] == Approx(5.0));
+}
+
+TEST_CASE("energy-history-series-12", "[EnergyHistory][series]") {
+    const int64_t      second = EnergyHistory::SECOND_NS;
+    EnergyHistory      history(2, { { second, 10 }, { 10 * second, 100 } });
+    std::vector<float> energy = { 2.0f, 1.0f };
+
+    // the second tier wraps several times, the prefix sums keep the energy of dropped buckets
+    for (int64_t t = 2000; t < 2050; t++) {
+        history.add(t * second, (t + 1) * second, energy);
+    }
+    REQUIRE(history.energy(2045 * second, 2050 * second)[0] == Approx(10.0));
+    REQUIRE(history.energy(2040 * second + second / 2, 2041 * second)[1] == Approx(0.5));
+    REQUIRE(history.energy(2000 * second, 2050 * second)[0] == Approx(100.0));
+
+    // a late sample updates its bucket and all later prefix sums
+    history.add(2045 * second, 2045 * second, energy);
+    REQUIRE(history.energy(2045 * second, 2046 * second)[0] == Approx(4.0));
+    REQUIRE(history.energy(2046 * second, 2050 * second)[0] == Approx(8.0));
+
+    // consecutive intervals, the last one is cut at to
+    const auto series = history.series(2000 * second, 2045 * second, 10 * second);
+    REQUIRE(series.size() == 5);
+    REQUIRE(series[0][0] == Approx(20.0));
+    REQUIRE(series[4][1] == Approx(5.0));
+    REQUIRE(history.series(2000 * second, 2045 * second, 0).size() == 1);
+    REQUIRE(history.energy(2060 * second, 2070 * second)[0] == 0.0);
 }
 
 // test with real data - copy real data to test/data/test_read_real/ directory
@@ -263,3 +348,37 @@ TEST_CASE("update-values-n-times") {
         powerIntegrator.update(time_point, values);
     }
 }*/
+
+TEST_CASE("integrator-sliding-windows-9", "[update][windows]") {
+    std::string datapath = "../../test/data/test_sliding_windows/";
+    if (!PowerIntegrator::create_directory(datapath)) REQUIRE(false);
+    std::remove((datapath + "integrator_checkpoint.bin").c_str());
+    std::remove((datapath + "integrator_journal.bin").c_str());
+
+    PowerIntegrator    powerIntegrator(2, datapath, 100000);
+    int64_t            time_point    = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count() + 1000000000;
+    const int64_t      time_interval = 60000000000; // one minute
+
+    std::vector<float> values        = { 1000.0f, 0.0f };
+    for (size_t i = 0; i < 2 * 24 * 60; i++) {
+        powerIntegrator.update(time_point, values);
+        time_point += time_interval;
+    }
+
+    // raw samples are kept for minutes only, the usage is summed from the history buckets
+    REQUIRE(powerIntegrator.get_timestamps().size() == 11);
+    REQUIRE(powerIntegrator.get_devices_values().at(0).size() == 11);
+
+    // 1 kW for 24 and 48 hours
+    REQUIRE(powerIntegrator.get_power_usages_day().at(0) == Approx(24.0f).epsilon(0.001));
+    REQUIRE(powerIntegrator.get_power_usages_week().at(0) == Approx(48.0f).epsilon(0.001));
+    REQUIRE(powerIntegrator.get_power_usages_day().at(1) == 0.0f);
+
+    // the fine tiers only keep their capacity
+    const auto  history = powerIntegrator.get_history();
+    const auto &tiers   = history.tiers();
+    REQUIRE(tiers.size() == 3);
+    REQUIRE(tiers[0].starts.size() == tiers[0].starts.capacity());
+    REQUIRE(tiers[1].starts.size() <= 2 * 24 * 60 + 2);
+    REQUIRE(tiers[2].starts.size() <= 50);
+}
@@ -0,0 +1,149 @@
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "inference/NilmCapture.hpp"
+
+namespace {
+
+constexpr uint32_t VECTOR_SIZE = 64;
+constexpr size_t   RECORD_SIZE = 3 * VECTOR_SIZE / 2 + 4;
+
+// voltage and current spectra are zero as written by NilmPredictWorker
+std::vector<float> dataPoint(size_t record) {
+    std::vector<float> point(RECORD_SIZE, 0.0f);
+    for (size_t i = VECTOR_SIZE; i < RECORD_SIZE; i++) {
+        point[i] = std::sin(static_cast<float>(i + record)) * 100.0f + static_cast<float>(record);
+    }
+    return point;
+}
+
+void writeCapture(const std::string &path, bool compressed, size_t records) {
+    nilm_capture::Writer writer(path, VECTOR_SIZE, 2'000'000.0f, "gupta-native", compressed);
+    for (size_t r = 0; r < records; r++) {
+        writer.write(static_cast<int64_t>(r) * 60'000'000, dataPoint(r));
+    }
+}
+
+template<typename T>
+T readAt(const std::string &path, uint64_t offset) {
+    T             value{};
+    std::ifstream file(path, std::ios::binary);
+    file.seekg(static_cast<std::streamoff>(offset));
+    file.read(reinterpret_cast<char *>(&value), sizeof(value));
+    return value;
+}
+
+template<typename T>
+void writeAt(const std::string &path, uint64_t offset, const T &value) {
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+// file offset of index entry r of a capture with the given number of records
+uint64_t indexEntryOffset(const std::string &path, size_t records, size_t r) {
+    return std::filesystem::file_size(path) - sizeof(nilm_capture::Footer) - (records - r) * sizeof(nilm_capture::IndexEntry);
+}
+
+} // namespace
+
+TEST_CASE("nilm-capture-round-trip", "[NilmCapture]") {
+    for (const bool compressed : { false, true }) {
+        const std::string path = "nilm_capture_test.bin";
+        writeCapture(path, compressed, 10);
+        REQUIRE(nilm_capture::Reader::isCapture(path));
+
+        const nilm_capture::Reader reader(path);
+        REQUIRE(reader.records() == 10);
+        REQUIRE(reader.header().vectorSize == VECTOR_SIZE);
+        REQUIRE(reader.header().recordSize() == RECORD_SIZE);
+        REQUIRE(reader.header().sampleRate == 2'000'000.0f);
+        REQUIRE(std::string(reader.header().modelVersion.data()) == "gupta-native");
+
+        // random access
+        std::vector<float> values;
+        for (size_t r : { 7UL, 0UL, 9UL, 3UL }) {
+            reader.read(r, values);
+            REQUIRE(reader.timestamp(r) == static_cast<int64_t>(r) * 60'000'000);
+            REQUIRE(values == dataPoint(r));
+        }
+        if (compressed) {
+            REQUIRE(std::filesystem::file_size(path) < 10 * RECORD_SIZE * sizeof(float) * 2 / 3);
+        }
+        std::remove(path.c_str());
+    }
+}
+
+TEST_CASE("nilm-capture-without-index", "[NilmCapture]") {
+    const std::string path = "nilm_capture_test_unindexed.bin";
+    writeCapture(path, true, 5);
+
+    // drop the index and half of the last record, as if the writer had been killed
+    const auto bytes = std::filesystem::file_size(path);
+    std::filesystem::resize_file(path, bytes - 5 * sizeof(nilm_capture::IndexEntry) - sizeof(nilm_capture::Footer) - 10);
+
+    const nilm_capture::Reader reader(path);
+    REQUIRE(reader.records() == 4);
+    std::vector<float> values;
+    reader.read(3, values);
+    REQUIRE(values == dataPoint(3));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("nilm-capture-rejects-raw-files", "[NilmCapture]") {
+    const std::string path = "nilm_capture_test_raw.bin";
+    {
+        std::ofstream file(path, std::ios::binary);
+        const auto    point = dataPoint(0);
+        file.write(reinterpret_cast<const char *>(point.data()), static_cast<std::streamsize>(point.size() * sizeof(float)));
+    }
+    REQUIRE_FALSE(nilm_capture::Reader::isCapture(path));
+    REQUIRE_THROWS_AS(nilm_capture::Reader(path), std::invalid_argument);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("nilm-capture-damaged-index", "[NilmCapture]") {
+    for (const bool compressed : { false, true }) {
+        const std::string path = "nilm_capture_test_damaged_index.bin";
+        writeCapture(path, compressed, 5);
+
+        // an index entry pointing past the end of the file, the records are recovered by scanning
+        writeAt(path, indexEntryOffset(path, 5, 2) + offsetof(nilm_capture::IndexEntry, offset), uint64_t{ 1 } << 40);
+
+        const nilm_capture::Reader reader(path);
+        REQUIRE(reader.records() == 5);
+        std::vector<float> values;
+        for (size_t r = 0; r < 5; r++) {
+            reader.read(r, values);
+            REQUIRE(reader.timestamp(r) == static_cast<int64_t>(r) * 60'000'000);
+            REQUIRE(values == dataPoint(r));
+        }
+        std::remove(path.c_str());
+    }
+}
+
+TEST_CASE("nilm-capture-damaged-record", "[NilmCapture]") {
+    for (const bool compressed : { false, true }) {
+        const std::string path = "nilm_capture_test_damaged_record.bin";
+        writeCapture(path, compressed, 5);
+
+        // a payload size reaching beyond the records, only the records before it are readable
+        const auto recordOffset = readAt<nilm_capture::IndexEntry>(path, indexEntryOffset(path, 5, 2)).offset;
+        const auto payloadBytes = readAt<uint32_t>(path, recordOffset + offsetof(nilm_capture::RecordHeader, payloadBytes));
+        writeAt(path, recordOffset + offsetof(nilm_capture::RecordHeader, payloadBytes), compressed ? uint32_t{ 0xffffffff } : payloadBytes + 4);
+
+        const nilm_capture::Reader reader(path);
+        REQUIRE(reader.records() == 2);
+        std::vector<float> values;
+        reader.read(1, values);
+        REQUIRE(values == dataPoint(1));
+        std::remove(path.c_str());
+    }
+}
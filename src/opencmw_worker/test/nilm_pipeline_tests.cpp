@@ -0,0 +1,110 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "inference/GuptaClassifier.hpp"
+#include "inference/NilmCapture.hpp"
+#include "inference/NilmPipeline.hpp"
+
+namespace {
+
+constexpr uint32_t FFT_SIZE = 16;
+constexpr size_t   PEAK_BIN = 5;
+
+// raw apparent power spectrum with a single, symmetric peak (load on) or dip (load off) in dBm
+std::vector<float> spectrum(bool on) {
+    std::vector<float> spectrum(FFT_SIZE);
+    for (size_t i = 0; i < FFT_SIZE; i++) {
+        const float distance = static_cast<float>(1 + (i > PEAK_BIN ? i - PEAK_BIN : PEAK_BIN - i));
+        spectrum[i]          = on ? 10.0f / distance : 1e-6f * distance;
+    }
+    spectrum[PEAK_BIN] = on ? 100.0f : 1e-9f;
+    return spectrum;
+}
+
+std::vector<float> dataPoint(bool on) {
+    std::vector<float> point(3 * FFT_SIZE + 4, 1.0f);
+    const auto         apparentPowerSpectrum = spectrum(on);
+    std::copy(apparentPowerSpectrum.begin(), apparentPowerSpectrum.end(), point.begin() + 2 * FFT_SIZE);
+    point[3 * FFT_SIZE + 2] = on ? 250.0f : 150.0f;
+    return point;
+}
+
+std::array<float, GuptaParameters::N_FEATURES> features(bool on) {
+    std::vector<float> dbm = spectrum(on);
+    std::transform(dbm.begin(), dbm.end(), dbm.begin(), [](float value) { return 10.0f * std::log10(value) + 30.0f; });
+    return GuptaClassifier::featureVector(dbm, FFT_SIZE, FFT_SIZE);
+}
+
+// appliance 0 (100 W) is switched on by the peak and switched off by the dip signature
+GuptaParameters testParameters() {
+    GuptaParameters params;
+    params.windowSize        = 2;
+    params.stepSize          = 1;
+    params.fftSizeReal       = FFT_SIZE;
+    params.sampleRate        = FFT_SIZE; // 1 Hz per bin
+    params.nKnownAppliances  = 2;
+    params.spectrumType      = 2;
+    params.nNeighbors        = 2;
+    params.nLabels           = 5;
+    params.apparentPowerList = { 100.0f, 40.0f };
+    for (const bool on : { true, false }) {
+        const auto signature = features(on);
+        params.trainingFeatures.insert(params.trainingFeatures.end(), signature.begin(), signature.end());
+    }
+    params.trainingLabels = { 1, 0, 0, 0, 0, /**/ 0, 0, 1, 0, 0 };
+    return params;
+}
+
+// steady phases with load changes in between, long enough for the gate to close in each of them
+void writeCapture(const std::string &path) {
+    nilm_capture::Writer writer(path, 2 * FFT_SIZE, static_cast<float>(FFT_SIZE), "gupta-native");
+    int64_t              timestamp = 0;
+    for (const bool on : { false, true, false, true, false }) {
+        for (int i = 0; i < 23; i++) {
+            writer.write(timestamp, dataPoint(on));
+            timestamp += 60'000'000;
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("nilm-pipeline-gated-matches-ungated", "[NilmPipeline]") {
+    const std::string path = "nilm_pipeline_test.bin";
+    writeCapture(path);
+    const nilm_capture::Reader reader(path);
+
+    SwitchDetector::Settings   settings;
+    settings.holdFrames = 8; // 3x the window + margin
+    NilmPipeline       gated(std::make_unique<GuptaClassifier>(testParameters()), settings);
+    GuptaClassifier    ungated(testParameters());
+
+    std::vector<float> dataPoint;
+    std::vector<float> gatedValues;
+    std::vector<float> ungatedValues;
+    size_t             classified = 0;
+    size_t             switchedOn = 0;
+    for (size_t i = 0; i < reader.records(); i++) {
+        reader.read(i, dataPoint);
+        ungated.predict(dataPoint, ungatedValues);
+        if (gated.process(dataPoint, gatedValues)) {
+            // the backend has seen the frames before the gate opened as well
+            REQUIRE(gatedValues == ungatedValues);
+            classified++;
+            switchedOn += gatedValues[0] == 100.0f ? 1 : 0;
+        }
+    }
+    REQUIRE(gated.switchDetector().events() == 4);
+    REQUIRE(classified < reader.records());
+    // both states have been predicted
+    REQUIRE(switchedOn > 0);
+    REQUIRE(switchedOn < classified);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,87 @@
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ReplyCache.hpp"
+#include "Ringbuffer.hpp"
+
+struct TestItem {
+    int64_t timestamp = 0;
+};
+
+TEST_CASE("ringbuffer-sequence-range", "[ReplyCache]") {
+    Ringbuffer<TestItem> ringBuffer(4);
+    for (int64_t i = 1; i <= 6; i++) {
+        ringBuffer.push(TestItem{ i * 10 });
+    }
+    REQUIRE(ringBuffer.sequence() == 6);
+
+    // items 30..60 are left, 10 and 20 have been overwritten
+    auto [first, end] = ringBuffer.sequence_range_if([](const TestItem &item) { return item.timestamp > 35; });
+    REQUIRE(first == 3);
+    REQUIRE(end == 6);
+
+    std::vector<TestItem> items;
+    ringBuffer.get_range(first, end, items);
+    REQUIRE(items.size() == 3);
+    REQUIRE(items.front().timestamp == 40);
+    REQUIRE(items.back().timestamp == 60);
+
+    // similar lastRefTrigger values resolve to the same range
+    REQUIRE(ringBuffer.sequence_range_if([](const TestItem &item) { return item.timestamp > 31; }) == std::pair<int64_t, int64_t>{ first, end });
+
+    // ranges partially overwritten in the meantime only return the remaining items
+    items.clear();
+    ringBuffer.get_range(0, 6, items);
+    REQUIRE(items.size() == 4);
+    REQUIRE(items.front().timestamp == 30);
+}
+
+TEST_CASE("reply-cache-hit-miss", "[ReplyCache]") {
+    ReplyCache cache(2);
+    auto       payload = std::make_shared<const std::string>("[1.0,2.0]");
+
+    REQUIRE_FALSE(cache.get({ "P@100Hz", 0, 10, "application/json" }));
+    cache.put({ "P@100Hz", 0, 10, "application/json" }, payload);
+    REQUIRE(cache.get({ "P@100Hz", 0, 10, "application/json" }) == payload);
+    REQUIRE_FALSE(cache.get({ "Q@100Hz", 0, 10, "application/json" }));
+    // JSON and YaS clients do not share entries
+    REQUIRE_FALSE(cache.get({ "P@100Hz", 0, 10, "application/octet-stream" }));
+    REQUIRE(cache.hits() == 1);
+    REQUIRE(cache.misses() == 3);
+
+    // advancing the ring buffer invalidates replies built from older data
+    REQUIRE_FALSE(cache.get({ "P@100Hz", 0, 11, "application/json" }));
+    REQUIRE_FALSE(cache.get({ "P@100Hz", 0, 10, "application/json" }));
+    REQUIRE(cache.hits() == 1);
+    REQUIRE(cache.misses() == 5);
+}
+
+TEST_CASE("reply-cache-hit-shares-payload", "[ReplyCache]") {
+    ReplyCache cache;
+    int        encoded = 0;
+    auto       encode  = [&encoded] {
+        encoded++;
+        return std::string(1 << 20, 'x');
+    };
+
+    const ReplyCache::Key json{ "S@2000000Hz", 0, 512, std::string(opencmw::MIME::JSON.typeName()) };
+    const ReplyCache::Key yas{ "S@2000000Hz", 0, 512, std::string(opencmw::MIME::BINARY.typeName()) };
+    const auto            first  = cache.getOrEncode(json, encode);
+    const auto            second = cache.getOrEncode(json, encode);
+
+    // a hit hands out the payload encoded by the miss, neither serialised nor copied again
+    REQUIRE(encoded == 1);
+    REQUIRE(second.get() == first.get());
+    REQUIRE(cache.hits() == 1);
+
+    // every wire format is encoded once
+    const auto binary = cache.getOrEncode(yas, encode);
+    REQUIRE(encoded == 2);
+    REQUIRE(binary.get() != first.get());
+    REQUIRE(cache.getOrEncode(yas, encode).get() == binary.get());
+    REQUIRE(encoded == 2);
+}
@@ -0,0 +1,130 @@
+#include <IoSerialiserJson.hpp>
+#include <IoSerialiserYaS.hpp>
+#include <MIME.hpp>
+#include <opencmw.hpp>
+
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <refl.hpp>
+
+#include <cmath>
+#include <cstdint>
+
+#include "FrequencyDomainWorker.hpp"
+#include "NilmDataWorker.hpp"
+
+// The benchmarks are hidden, ctest and a plain run skip them. Run them explicitly with an optimised build:
+//   ./serialiser_benchmark "[benchmark]"
+
+namespace {
+
+constexpr std::size_t FFT_SIZE_NILM = 131072;
+
+AcquisitionNilm makeAcquisitionNilm(std::size_t frames) {
+    AcquisitionNilm acq;
+    acq.apparentPowerSpectrumStridedValues.reserve(frames * FFT_SIZE_NILM);
+    for (std::size_t frame = 0; frame < frames; frame++) {
+        acq.refTriggerStamp.push_back(1673858501452341457 + static_cast<int64_t>(frame) * 65'536'000);
+        for (std::size_t i = 0; i < FFT_SIZE_NILM; i++) {
+            // non-trivial mantissa, as a real power spectrum would have
+            acq.apparentPowerSpectrumStridedValues.push_back(1e-3f * std::abs(std::sin(0.001f * static_cast<float>(i + frame))) + 1e-7f * static_cast<float>(i));
+        }
+        acq.realPower.push_back(230.5f);
+        acq.reactivePower.push_back(12.25f);
+        acq.apparentPower.push_back(231.2f);
+        acq.phi.push_back(0.053f);
+    }
+    return acq;
+}
+
+AcquisitionSpectra makeAcquisitionSpectra() {
+    AcquisitionSpectra acq;
+    acq.refTriggerStamp = 1673858501452341457;
+    acq.channelName     = "ApparentPowerSpectrumNilm@2000000Hz";
+    std::vector<float> values(FFT_SIZE_NILM);
+    for (std::size_t i = 0; i < FFT_SIZE_NILM; i++) {
+        values[i] = 1e-3f * std::abs(std::sin(0.001f * static_cast<float>(i)));
+        acq.channelMagnitude_dim2_discrete_freq_values.push_back(static_cast<float>(i) * 7.62939453125f);
+    }
+    acq.channelMagnitude_values = opencmw::MultiArray<float, 2>(std::move(values), { 1U, static_cast<uint32_t>(FFT_SIZE_NILM) });
+    acq.channelMagnitude_dim1_discrete_time_values.push_back(acq.refTriggerStamp);
+    acq.channelTimeSinceRefTrigger.push_back(0.0f);
+    return acq;
+}
+
+template<opencmw::SerialiserProtocol protocol, typename T>
+opencmw::IoBuffer encode(const T &data) {
+    opencmw::IoBuffer buffer;
+    opencmw::serialise<protocol>(buffer, data);
+    return buffer;
+}
+
+template<opencmw::SerialiserProtocol protocol, typename T>
+T decode(const opencmw::IoBuffer &encoded) {
+    // decode from a wire copy, as the receiving side of the REST interface would do
+    opencmw::IoBuffer buffer;
+    buffer.put<opencmw::IoBuffer::MetaInfo::WITHOUT>(std::string(encoded.asString()));
+    T data;
+    opencmw::deserialise<protocol, opencmw::ProtocolCheck::LENIENT>(buffer, data);
+    return data;
+}
+
+} // namespace
+
+TEST_CASE("serialiser-nilm-spectra-json-vs-yas", "[.benchmark][serialiser][nilm]") {
+    const AcquisitionNilm acq     = makeAcquisitionNilm(1);
+
+    const auto            json    = encode<opencmw::Json>(acq);
+    const auto            yas     = encode<opencmw::YaS>(acq);
+
+    const auto            decoded = decode<opencmw::YaS, AcquisitionNilm>(yas);
+    REQUIRE(decoded.apparentPowerSpectrumStridedValues == acq.apparentPowerSpectrumStridedValues);
+    REQUIRE(decoded.refTriggerStamp == acq.refTriggerStamp);
+    REQUIRE(decoded.realPower == acq.realPower);
+    REQUIRE(decoded.phi == acq.phi);
+
+    fmt::print("AcquisitionNilm ({} bins): JSON payload {} bytes, YaS payload {} bytes ({:.2f}x)\n", FFT_SIZE_NILM, json.size(), yas.size(), static_cast<double>(json.size()) / static_cast<double>(yas.size()));
+    REQUIRE(yas.size() < json.size());
+
+    BENCHMARK("AcquisitionNilm - JSON encode") {
+        return encode<opencmw::Json>(acq).size();
+    };
+    BENCHMARK("AcquisitionNilm - YaS encode") {
+        return encode<opencmw::YaS>(acq).size();
+    };
+    BENCHMARK("AcquisitionNilm - JSON decode") {
+        return decode<opencmw::Json, AcquisitionNilm>(json).apparentPowerSpectrumStridedValues.size();
+    };
+    BENCHMARK("AcquisitionNilm - YaS decode") {
+        return decode<opencmw::YaS, AcquisitionNilm>(yas).apparentPowerSpectrumStridedValues.size();
+    };
+}
+
+TEST_CASE("serialiser-spectra-json-vs-yas", "[.benchmark][serialiser][frequency-domain]") {
+    const AcquisitionSpectra acq     = makeAcquisitionSpectra();
+
+    const auto               json    = encode<opencmw::Json>(acq);
+    const auto               yas     = encode<opencmw::YaS>(acq);
+
+    const auto               decoded = decode<opencmw::YaS, AcquisitionSpectra>(yas);
+    REQUIRE(decoded.channelName == acq.channelName);
+    REQUIRE(decoded.channelMagnitude_values.n(0) == 1);
+    REQUIRE(decoded.channelMagnitude_values.n(1) == FFT_SIZE_NILM);
+    REQUIRE(decoded.channelMagnitude_values.elements() == acq.channelMagnitude_values.elements());
+
+    fmt::print("AcquisitionSpectra ({} bins): JSON payload {} bytes, YaS payload {} bytes ({:.2f}x)\n", FFT_SIZE_NILM, json.size(), yas.size(), static_cast<double>(json.size()) / static_cast<double>(yas.size()));
+    REQUIRE(yas.size() < json.size());
+
+    BENCHMARK("AcquisitionSpectra - JSON encode") {
+        return encode<opencmw::Json>(acq).size();
+    };
+    BENCHMARK("AcquisitionSpectra - YaS encode") {
+        return encode<opencmw::YaS>(acq).size();
+    };
+    BENCHMARK("AcquisitionSpectra - JSON decode") {
+        return decode<opencmw::Json, AcquisitionSpectra>(json).channelMagnitude_values.n(1);
+    };
+    BENCHMARK("AcquisitionSpectra - YaS decode") {
+        return decode<opencmw::YaS, AcquisitionSpectra>(yas).channelMagnitude_values.n(1);
+    };
+}
@@ -0,0 +1,61 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "Snapshot.hpp"
+
+struct TestData {
+    int64_t             version = 0;
+    std::vector<double> values;
+};
+
+TEST_CASE("snapshot-lifetime", "[Snapshot]") {
+    Snapshot<TestData> snapshot;
+    REQUIRE(snapshot.load() != nullptr);
+    REQUIRE(snapshot.load()->values.empty());
+
+    auto published = snapshot.publish(TestData{ 1, { 1.0, 2.0 } });
+    auto held      = snapshot.load();
+    REQUIRE(held == published);
+
+    // a reader keeps its snapshot while newer ones are published
+    snapshot.publish(TestData{ 2, { 3.0 } });
+    REQUIRE(held->version == 1);
+    REQUIRE(held->values == std::vector<double>{ 1.0, 2.0 });
+    REQUIRE(snapshot.load()->version == 2);
+}
+
+TEST_CASE("snapshot-concurrent-readers", "[Snapshot]") {
+    Snapshot<TestData> snapshot;
+    std::atomic<bool>  done{ false };
+    std::atomic<int>   torn{ 0 };
+
+    std::vector<std::jthread> readers;
+    for (int i = 0; i < 3; i++) {
+        readers.emplace_back([&] {
+            int64_t lastVersion = 0;
+            while (!done) {
+                auto current = snapshot.load();
+                // every element carries the version it was published with, the size grows with the version
+                if (current->version < lastVersion || current->values.size() != static_cast<size_t>(current->version % 64)
+                        || std::any_of(current->values.begin(), current->values.end(), [&current](double v) { return v != static_cast<double>(current->version); })) {
+                    torn++;
+                }
+                lastVersion = current->version;
+            }
+        });
+    }
+
+    for (int64_t version = 1; version <= 20000; version++) {
+        snapshot.publish(TestData{ version, std::vector<double>(static_cast<size_t>(version % 64), static_cast<double>(version)) });
+    }
+    done = true;
+    readers.clear();
+
+    REQUIRE(torn == 0);
+    REQUIRE(snapshot.load()->version == 20000);
+}
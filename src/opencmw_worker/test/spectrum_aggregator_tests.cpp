@@ -0,0 +1,101 @@
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "SpectrumAggregator.hpp"
+
+TEST_CASE("spectrum-aggregator-average-peak-waterfall", "[SpectrumAggregator]") {
+    // 8 native bins decimated to 4 stored bins, 3 frames of history
+    SpectrumAggregator aggregator(8, 4, 3);
+    REQUIRE(aggregator.decimation() == 2);
+    REQUIRE(aggregator.bins() == 4);
+
+    for (int64_t frame = 1; frame <= 5; frame++) {
+        std::vector<float> spectrum(8, static_cast<float>(frame));
+        spectrum[0] = static_cast<float>(10 * frame); // bin 0 averages frame and 10 * frame
+        aggregator.push(spectrum.data(), frame * 100);
+    }
+
+    std::vector<float> values;
+    // average over the last two frames (4 and 5)
+    REQUIRE(aggregator.average(2, values) == 2);
+    REQUIRE(values.size() == 4);
+    REQUIRE(values[0] == Approx((22.0f + 27.5f) / 2.0f));
+    REQUIRE(values[3] == Approx(4.5f));
+    // averages are limited to the stored history
+    REQUIRE(aggregator.average(100, values) == 3);
+    REQUIRE(values[3] == Approx(4.0f));
+
+    aggregator.peakHold(values);
+    REQUIRE(values[0] == Approx(50.0f));
+    REQUIRE(values[1] == Approx(5.0f));
+    aggregator.resetPeakHold();
+    const std::vector<float> spectrum(8, 1.0f);
+    aggregator.push(spectrum.data(), 600);
+    aggregator.peakHold(values);
+    REQUIRE(values[0] == Approx(1.0f));
+
+    std::vector<int64_t> timestamps;
+    aggregator.lastFrames(2, [&timestamps](std::span<const float>, int64_t timestamp) { timestamps.push_back(timestamp); });
+    REQUIRE(timestamps == std::vector<int64_t>{ 500, 600 });
+}
+
+TEST_CASE("spectrum-aggregator-non-finite", "[SpectrumAggregator]") {
+    // 4 native bins decimated to 2 stored bins, 3 frames of history
+    SpectrumAggregator aggregator(4, 2, 3);
+    const float        inf = std::numeric_limits<float>::infinity();
+    std::vector<float> values;
+
+    const std::vector<float> finite(4, -40.0f);
+    aggregator.push(finite.data(), 100);
+    // nlog10 of empty bins: bin 0 has one finite input left, bin 1 none
+    const std::vector<float> empty{ -inf, -60.0f, -inf, -inf };
+    aggregator.push(empty.data(), 200);
+    REQUIRE(aggregator.average(2, values) == 2);
+    REQUIRE(values[0] == Approx(-50.0f));
+    REQUIRE(values[1] == Approx((-40.0f + SpectrumAggregator::FLOOR) / 2.0f));
+    aggregator.peakHold(values);
+    REQUIRE(std::isfinite(values[1]));
+
+    // averages over windows without that frame are exact again
+    for (int64_t frame = 3; frame <= 5; frame++) {
+        aggregator.push(finite.data(), frame * 100);
+    }
+    REQUIRE(aggregator.average(3, values) == 3);
+    REQUIRE(values == std::vector<float>{ -40.0f, -40.0f });
+}
+
+TEST_CASE("spectrum-aggregator-rebase", "[SpectrumAggregator]") {
+    // huge frames would swamp running sums that are never reset
+    SpectrumAggregator       aggregator(2, 2, 3);
+    const std::vector<float> huge(2, 1e30f);
+    const std::vector<float> one(2, 1.0f);
+    for (int64_t frame = 0; frame < 5; frame++) {
+        aggregator.push(huge.data(), frame);
+    }
+    for (int64_t frame = 5; frame < 12; frame++) {
+        aggregator.push(one.data(), frame);
+    }
+
+    std::vector<float> values;
+    REQUIRE(aggregator.average(3, values) == 3);
+    REQUIRE(values == std::vector<float>{ 1.0f, 1.0f });
+    REQUIRE(aggregator.average(1, values) == 1);
+    REQUIRE(values == std::vector<float>{ 1.0f, 1.0f });
+}
+
+TEST_CASE("spectrum-aggregator-decimate", "[SpectrumAggregator]") {
+    const std::vector<float> spectrum{ 1.0f, 3.0f, 2.0f, 8.0f, 5.0f };
+    REQUIRE(SpectrumAggregator::decimationFactor(spectrum.size(), 2) == 3);
+    REQUIRE(SpectrumAggregator::decimationFactor(spectrum.size(), 0) == 1);
+
+    std::vector<float> out;
+    SpectrumAggregator::decimate(spectrum, 2, false, out);
+    REQUIRE(out == std::vector<float>{ 2.0f, 5.0f });
+    SpectrumAggregator::decimate(spectrum, 2, true, out);
+    REQUIRE(out == std::vector<float>{ 3.0f, 8.0f });
+}
@@ -0,0 +1,37 @@
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "SpectrumArena.hpp"
+
+TEST_CASE("spectrum-arena-push-visit", "[SpectrumArena]") {
+    SpectrumArena arena(3, 2);
+    for (int64_t i = 1; i <= 5; i++) {
+        const std::array<float, 2> spectrum{ static_cast<float>(i), static_cast<float>(-i) };
+        arena.push(spectrum.data(), i * 100);
+    }
+    REQUIRE(arena.sequence() == 5);
+
+    // frames 1 and 2 have been overwritten, frames newer than 300 are 4 and 5
+    auto [first, end] = arena.sequence_range_since(300);
+    REQUIRE(first == 3);
+    REQUIRE(end == 5);
+
+    std::vector<float>   values;
+    std::vector<int64_t> timestamps;
+    arena.visit(first, end, [&](std::span<const float> spectrum, int64_t timestamp) {
+        values.insert(values.end(), spectrum.begin(), spectrum.end());
+        timestamps.push_back(timestamp);
+    });
+    REQUIRE(values == std::vector<float>{ 4.0f, -4.0f, 5.0f, -5.0f });
+    REQUIRE(timestamps == std::vector<int64_t>{ 400, 500 });
+
+    // requesting everything only returns the frames still stored
+    size_t visited = 0;
+    arena.visit(0, end, [&visited](std::span<const float>, int64_t) { visited++; });
+    REQUIRE(visited == 3);
+    REQUIRE(arena.sequence_range_since(0).first == 2);
+}
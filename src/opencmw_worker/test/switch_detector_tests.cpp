@@ -0,0 +1,63 @@
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "inference/SwitchDetector.hpp"
+
+namespace {
+
+// feeds frames of constant power and spectrum, returns the number of frames passed to the model
+int feed(SwitchDetector &detector, const std::vector<float> &spectrum, float apparentPower, int frames) {
+    int active = 0;
+    for (int i = 0; i < frames; i++) {
+        // small ripple which must not trigger
+        const float ripple = (i % 2 == 0 ? 0.5f : -0.5f);
+        active += detector.update(spectrum, 0.9f * apparentPower + ripple, 0.1f * apparentPower, apparentPower + ripple) ? 1 : 0;
+    }
+    return active;
+}
+
+} // namespace
+
+TEST_CASE("switch-detector-steady-state", "[SwitchDetector]") {
+    SwitchDetector::Settings settings;
+    settings.holdFrames = 4;
+    SwitchDetector     detector(settings);
+    std::vector<float> spectrum(64, 1e-3f);
+
+    // the first frame and the hold frames after it are classified, then the gate stays closed
+    REQUIRE(feed(detector, spectrum, 200.0f, 100) == 5);
+    REQUIRE(detector.events() == 0);
+    REQUIRE(detector.frames() == 100);
+    REQUIRE(detector.activeFrames() == 5);
+}
+
+TEST_CASE("switch-detector-power-step", "[SwitchDetector]") {
+    SwitchDetector::Settings settings;
+    settings.holdFrames = 4;
+    SwitchDetector     detector(settings);
+    std::vector<float> spectrum(64, 1e-3f);
+    feed(detector, spectrum, 200.0f, 50);
+
+    // 100 W switched on, the same spectrum
+    REQUIRE(feed(detector, spectrum, 300.0f, 50) == 5);
+    REQUIRE(detector.events() == 1);
+
+    // and off again
+    REQUIRE(feed(detector, spectrum, 200.0f, 50) == 5);
+    REQUIRE(detector.events() == 2);
+}
+
+TEST_CASE("switch-detector-spectral-change", "[SwitchDetector]") {
+    SwitchDetector::Settings settings;
+    settings.holdFrames = 4;
+    SwitchDetector     detector(settings);
+    std::vector<float> spectrum(64, 1e-3f);
+    feed(detector, spectrum, 200.0f, 50);
+
+    // same power, but a different load signature (+10 dB everywhere)
+    std::vector<float> changed(64, 1e-2f);
+    REQUIRE(feed(detector, changed, 200.0f, 50) == 5);
+    REQUIRE(detector.events() == 1);
+}
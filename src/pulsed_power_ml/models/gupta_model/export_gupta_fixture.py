@@ -0,0 +1,92 @@
+"""
+This module exports a reference fixture for the native C++ Gupta classifier
+(opencmw_worker/src/inference/GuptaClassifier.hpp): a short sequence of recorded data points and the
+state vectors the TensorFlow model predicts for them.
+
+The fixture folder holds
+    data_points.bin       float32 data points, same layout as the recorded raw data
+    tf_state_vectors.bin  float32 state vectors of the TensorFlow model, one per data point
+    gupta_params.bin      parameters of the same model, written by export_gupta_params.py
+
+and is read by the gupta_classifier test (opencmw_worker/test/data/gupta_fixture).
+"""
+
+import argparse
+import os
+import sys
+
+import tensorflow as tf
+import numpy as np
+from tqdm import tqdm
+
+sys.path.append("../../../../")
+
+from src.pulsed_power_ml.model_framework.data_io import load_binary_data_array
+from src.pulsed_power_ml.model_framework.data_io import read_parameters
+
+
+def main():
+
+    # Parse CLI arguments (same as test_model.py)
+    parser = argparse.ArgumentParser(
+        description='This script exports recorded data points and the predictions of the TensorFlow model for them.'
+    )
+    parser.add_argument('-i',
+                        '--input',
+                        help='Path to raw data.',
+                        required=True)
+    parser.add_argument('-m',
+                        '--model',
+                        help='Path to TensorFlow model.',
+                        required=True)
+    parser.add_argument('-o',
+                        '--output-folder',
+                        help='Path to folder where the fixture should be stored.',
+                        required=True)
+    parser.add_argument('-p',
+                        '--parameters',
+                        help='Path to parameter file.',
+                        required=True)
+    parser.add_argument('-s',
+                        '--start',
+                        help='Index of the first data point. Default 0.',
+                        type=int,
+                        default=0)
+    parser.add_argument('-n',
+                        '--number',
+                        help='Number of data points, should contain switching events. Default 200.',
+                        type=int,
+                        default=200)
+    args = parser.parse_args()
+
+    parameter_dict = read_parameters(args.parameters)
+    data_point_array = load_binary_data_array(args.input,
+                                              parameter_dict["fft_size_real"])
+    data_point_array = data_point_array[args.start:args.start + args.number]
+    if len(data_point_array) == 0:
+        raise ValueError(f'No data points in {args.input} starting at {args.start}')
+
+    print(f'\nLoad model {args.model}')
+    model = tf.saved_model.load(args.model)
+
+    # Start from a clean state, as the native classifier does
+    model(tf.constant(-np.ones(data_point_array.shape[1]), dtype=tf.float32))
+
+    state_vector_list = list()
+    for data_point in tqdm(data_point_array, 'Apply model...'):
+        state_vector = model(tf.constant(data_point, dtype=tf.float32))
+        state_vector_list.append(state_vector.numpy())
+
+    print(f'\nStore fixture in {args.output_folder}')
+    os.makedirs(args.output_folder, exist_ok=True)
+    data_point_array.astype('<f4').tofile(os.path.join(args.output_folder, 'data_points.bin'))
+    np.asarray(state_vector_list, dtype='<f4').tofile(os.path.join(args.output_folder, 'tf_state_vectors.bin'))
+    print(f'Export the parameters of the same model with export_gupta_params.py -o '
+          f'{os.path.join(args.output_folder, "gupta_params.bin")}')
+
+    print('\nAll done :-)')
+    return
+
+
+if __name__ == '__main__':
+    main()
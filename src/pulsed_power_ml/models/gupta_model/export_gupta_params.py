@@ -0,0 +1,89 @@
+"""
+This module exports the parameters of a Gupta model into a flat binary file, which can be
+loaded by the native C++ implementation (opencmw_worker/src/inference/GuptaClassifier.hpp)
+instead of the TensorFlow graph.
+"""
+
+import argparse
+import struct
+import sys
+
+import numpy as np
+
+sys.path.append("../../../../")
+
+from src.pulsed_power_ml.model_framework.data_io import read_parameters
+from src.pulsed_power_ml.models.gupta_model.gupta_utils import read_power_data_base
+
+MAGIC = b'GUPTAv1\0'
+N_PEAKS_MAX = 9
+
+
+def main():
+
+    # Parse CLI arguments (same as train_model.py)
+    parser = argparse.ArgumentParser(
+        description='This script exports the parameters of the Gupta model for the native C++ classifier.'
+    )
+    parser.add_argument("-f",
+                        "--features",
+                        help="Path to features (csv file)",
+                        required=True)
+    parser.add_argument("-l",
+                        "--labels",
+                        help="Path to labels (csv file)",
+                        required=True)
+    parser.add_argument("-o",
+                        "--output",
+                        help="Output file",
+                        required=True)
+    parser.add_argument("-p",
+                        "--parameters",
+                        help="Path to parameter file.",
+                        required=True)
+    parser.add_argument('-d',
+                        '--power-data-base',
+                        help='Path to data base containing apparent power for each known appliance.',
+                        required=True)
+    args = parser.parse_args()
+
+    parameter_dict = read_parameters(args.parameters)
+    _, apparent_power_list = list(zip(*read_power_data_base(args.power_data_base)))
+    features = np.loadtxt(args.features, delimiter=',', ndmin=2).astype('<f4')
+    labels = np.loadtxt(args.labels, delimiter=',', ndmin=2).astype('<f4')
+    apparent_power = np.asarray(apparent_power_list, dtype='<f4')
+
+    if features.shape[1] != 3 * N_PEAKS_MAX:
+        raise ValueError(f'Expected {3 * N_PEAKS_MAX} features per point, got {features.shape[1]}')
+    if features.shape[0] != labels.shape[0]:
+        raise ValueError('Number of feature and label rows differ')
+    if len(apparent_power) != parameter_dict['n_known_appliances']:
+        raise ValueError('Power data base does not match n_known_appliances')
+
+    print(f'\nStore parameters in {args.output}')
+    with open(args.output, 'wb') as output_file:
+        output_file.write(MAGIC)
+        output_file.write(struct.pack('<10I',
+                                      parameter_dict['window_size'],
+                                      parameter_dict['step_size'],
+                                      parameter_dict['fft_size_real'],
+                                      parameter_dict['sample_rate'],
+                                      parameter_dict['n_known_appliances'],
+                                      parameter_dict['spectrum_type'],
+                                      parameter_dict['n_neighbors'],
+                                      features.shape[0],
+                                      features.shape[1],
+                                      labels.shape[1]))
+        output_file.write(struct.pack('<2f',
+                                      parameter_dict['switch_threshold'],
+                                      parameter_dict['distance_threshold']))
+        output_file.write(apparent_power.tobytes())
+        output_file.write(features.tobytes())
+        output_file.write(labels.tobytes())
+
+    print('\nAll done :-)')
+    return
+
+
+if __name__ == '__main__':
+    main()